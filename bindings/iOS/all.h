@@ -135,6 +135,7 @@
 #import <VerovioFramework/layer.h>
 #import <VerovioFramework/layerdef.h>
 #import <VerovioFramework/layerelement.h>
+#import <VerovioFramework/layerelementindex.h>
 #import <VerovioFramework/lb.h>
 #import <VerovioFramework/lem.h>
 #import <VerovioFramework/libmei.h>
@@ -162,6 +163,7 @@
 #import <VerovioFramework/note.h>
 #import <VerovioFramework/num.h>
 #import <VerovioFramework/object.h>
+#import <VerovioFramework/objectarena.h>
 #import <VerovioFramework/octave.h>
 #import <VerovioFramework/options.h>
 #import <VerovioFramework/orig.h>
@@ -13,11 +13,15 @@
 // Method to ignore
 %ignore vrv::Toolkit::GetShowBoundingBoxes( );
 %ignore vrv::Toolkit::GetCString( );
+%ignore vrv::Toolkit::GetDoc( );
 %ignore vrv::Toolkit::GetLogString( );
+%ignore vrv::Toolkit::LoadData( std::string && );
 %ignore vrv::Toolkit::GetOptionsObj( );
+%ignore vrv::Toolkit::RenderAllToSVG( int, bool );
 %ignore vrv::Toolkit::ResetLogBuffer( );
 %ignore vrv::Toolkit::SetShowBoundingBoxes( bool );
 %ignore vrv::Toolkit::SetCString( const std::string & );
+%ignore vrv::Toolkit::SetCBuffer( std::vector<unsigned char> && );
 
 %feature("autodoc", "1");
 
@@ -78,6 +82,13 @@ def getElementsAtTime(toolkit, millisec: int) -> dict:
     return json.loads($action(toolkit, millisec))
 %}
 
+// Toolkit::GetElementsInTimeRange
+%feature("shadow") vrv::Toolkit::GetElementsInTimeRange(int, int) %{
+def getElementsInTimeRange(toolkit, start_millisec: int, end_millisec: int) -> dict:
+    """Return arrays of IDs of elements being played within a time range."""
+    return json.loads($action(toolkit, start_millisec, end_millisec))
+%}
+
 // Toolkit::GetExpansionIdsForElement
 %feature("shadow") vrv::Toolkit::GetExpansionIdsForElement(const std::string &) %{
 def getExpansionIdsForElement(toolkit, xml_id: str) -> dict:
@@ -145,6 +156,15 @@ def renderToExpansionMapFile(toolkit, filename: str) -> bool:
     return $action(toolkit, filename)
 %}
 
+// Toolkit::RenderToBinaryTimemap
+%feature("shadow") vrv::Toolkit::RenderToBinaryTimemap(const std::string & = "") %{
+def renderToBinaryTimemap(toolkit, options: Optional[dict] = None) -> bytes:
+    """Render a document to a binary timemap."""
+    if options is None:
+        options = {}
+    return $action(toolkit, json.dumps(options))
+%}
+
 // Toolkit::RenderToTimemap
 %feature("shadow") vrv::Toolkit::RenderToTimemap(const std::string & = "") %{
 def renderToTimemap(toolkit, options: Optional[dict] = None) -> list:
@@ -197,6 +217,12 @@ def validatePAE(toolkit, data: Union[str, dict]) -> dict:
 
 %module(package="verovio") verovio
 %include "std_string.i"
+
+// The binary output (e.g., the binary timemap) is returned as bytes
+%typemap(out) std::vector<unsigned char> %{
+    $result = PyBytes_FromStringAndSize(reinterpret_cast<const char *>($1.data()), $1.size());
+%}
+
 %include "../../include/vrv/toolkit.h"
 %include "../../include/vrv/toolkitdef.h"
 
@@ -0,0 +1,32 @@
+#!/bin/sh
+
+# This script needs to be run from ./doc
+# It checks that an input converted in batch mode gives the same output as when converted on its own,
+# with the command-line options and with the options given in the batch list
+
+verovio=${VEROVIO:-../tools/verovio}
+outdir=`mktemp -d`
+status=0
+
+# Non-default options that have to be passed to the toolkits of the batch
+options="-r ../data/ --scale 50 --page-width 1500 --xml-id-seed 1"
+
+mkdir -p $outdir/batch
+echo "importer.mei" > $outdir/batch.txt
+echo "{\"input\": \"importer.mei\", \"output\": \"$outdir/batch/importer-json\", \"options\": {\"scale\": 70}}" >> $outdir/batch.txt
+
+$verovio $options -o $outdir/importer.svg importer.mei
+$verovio $options --scale 70 -o $outdir/importer-json.svg importer.mei
+$verovio $options -j 2 -b $outdir/batch.txt -o $outdir/batch
+
+for i in importer importer-json; do
+    if cmp -s $outdir/$i.svg $outdir/batch/$i.svg; then
+        echo "$i: passed"
+    else
+        echo "$i: FAILED - the batch output differs"
+        status=1
+    fi
+done
+
+rm -rf $outdir
+exit $status
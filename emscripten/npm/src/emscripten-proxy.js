@@ -18,6 +18,9 @@ function getToolkitFunction(VerovioModule, method) {
     // void destructor(Toolkit *ic)
     mapping.destructor = VerovioModule.cwrap("vrvToolkit_destructor", null, ["number"]);
 
+    // bool castOffPages(Toolkit *ic, int pageCount)
+    mapping.castOffPages = VerovioModule.cwrap("vrvToolkit_castOffPages", "number", ["number", "number"]);
+
     // bool edit(Toolkit *ic, const char *editorAction) 
     mapping.edit = VerovioModule.cwrap("vrvToolkit_edit", "number", ["number", "string"]);
 
@@ -27,6 +30,9 @@ function getToolkitFunction(VerovioModule, method) {
     // char *getAvailableOptions(Toolkit *ic)
     mapping.getAvailableOptions = VerovioModule.cwrap("vrvToolkit_getAvailableOptions", "string", ["number"]);
 
+    // int getCastOffPageCount(Toolkit *ic)
+    mapping.getCastOffPageCount = VerovioModule.cwrap("vrvToolkit_getCastOffPageCount", "number", ["number"]);
+
     // char *getDefaultOptions(Toolkit *ic)
     mapping.getDefaultOptions = VerovioModule.cwrap("vrvToolkit_getDefaultOptions", "string", ["number"]);
 
@@ -39,6 +45,9 @@ function getToolkitFunction(VerovioModule, method) {
     // char *getElementsAtTime(Toolkit *ic, int time)
     mapping.getElementsAtTime = VerovioModule.cwrap("vrvToolkit_getElementsAtTime", "string", ["number", "number"]);
 
+    // char *getElementsInTimeRange(Toolkit *ic, int startTime, int endTime)
+    mapping.getElementsInTimeRange = VerovioModule.cwrap("vrvToolkit_getElementsInTimeRange", "string", ["number", "number", "number"]);
+
     // char *vrvToolkit_getExpansionIdsForElement(Toolkit *tk, const char *xmlId);
     mapping.getExpansionIdsForElement = VerovioModule.cwrap("vrvToolkit_getExpansionIdsForElement", "string", ["number", "string"]);
 
@@ -84,6 +93,9 @@ function getToolkitFunction(VerovioModule, method) {
     // char *getVersion(Toolkit *ic)
     mapping.getVersion = VerovioModule.cwrap("vrvToolkit_getVersion", "string", ["number"]);
 
+    // bool isCastOffComplete(Toolkit *ic)
+    mapping.isCastOffComplete = VerovioModule.cwrap("vrvToolkit_isCastOffComplete", "number", ["number"]);
+
     // bool loadData(Toolkit *ic, const char *data)
     mapping.loadData = VerovioModule.cwrap("vrvToolkit_loadData", "number", ["number", "string"]);
 
@@ -102,6 +114,9 @@ function getToolkitFunction(VerovioModule, method) {
     // char *renderData(Toolkit *ic, const char *data, const char *options)
     mapping.renderData = VerovioModule.cwrap("vrvToolkit_renderData", "string", ["number", "string", "string"]);
 
+    // unsigned char *renderToBinaryTimemap(Toolkit *ic, const char *options, int *length)
+    mapping.renderToBinaryTimemap = VerovioModule.cwrap("vrvToolkit_renderToBinaryTimemap", "number", ["number", "string", "number"]);
+
     // char *renderToExpansionMap(Toolkit *ic)
     mapping.renderToExpansionMap = VerovioModule.cwrap("vrvToolkit_renderToExpansionMap", "string", ["number"]);
 
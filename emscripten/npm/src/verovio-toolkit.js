@@ -18,6 +18,10 @@ export class VerovioToolkit {
         this.proxy.destructor(this.ptr);
     }
 
+    castOffPages(pageCount) {
+        return this.proxy.castOffPages(this.ptr, pageCount);
+    }
+
     edit(editorAction) {
         return this.proxy.edit(this.ptr, JSON.stringify(editorAction));
     }
@@ -30,6 +34,10 @@ export class VerovioToolkit {
         return JSON.parse(this.proxy.getAvailableOptions(this.ptr));
     }
 
+    getCastOffPageCount() {
+        return this.proxy.getCastOffPageCount(this.ptr);
+    }
+
     getDefaultOptions() {
         return JSON.parse(this.proxy.getDefaultOptions(this.ptr));
     }
@@ -46,6 +54,10 @@ export class VerovioToolkit {
         return JSON.parse(this.proxy.getElementsAtTime(this.ptr, millisec));
     }
 
+    getElementsInTimeRange(startMillisec, endMillisec) {
+        return JSON.parse(this.proxy.getElementsInTimeRange(this.ptr, startMillisec, endMillisec));
+    }
+
     getExpansionIdsForElement(xmlId) {
         return JSON.parse(this.proxy.getExpansionIdsForElement(this.ptr, xmlId));
     }
@@ -116,6 +128,10 @@ export class VerovioToolkit {
         return this.proxy.getVersion(this.ptr);
     }
 
+    isCastOffComplete() {
+        return this.proxy.isCastOffComplete(this.ptr);
+    }
+
     loadData(data) {
         return this.proxy.loadData(this.ptr, data);
     }
@@ -150,6 +166,15 @@ export class VerovioToolkit {
         return this.proxy.renderData(this.ptr, data, JSON.stringify(options));
     }
 
+    renderToBinaryTimemap(options = {}) {
+        var lengthPtr = this.VerovioModule._malloc(4);
+        var dataPtr = this.proxy.renderToBinaryTimemap(this.ptr, JSON.stringify(options), lengthPtr);
+        var dataSize = new DataView(this.VerovioModule.HEAPU8.buffer).getInt32(lengthPtr, true);
+        this.VerovioModule._free(lengthPtr);
+        // The buffer is owned by the toolkit and is copied
+        return this.VerovioModule.HEAPU8.slice(dataPtr, dataPtr + dataSize);
+    }
+
     renderToExpansionMap() {
         return JSON.parse(this.proxy.renderToExpansionMap(this.ptr));
     }
@@ -45,7 +45,9 @@ public:
 protected:
     //
 private:
-    //
+    // Add an overflowing box to the intervals with its extender if it is a floating positioner
+    void AddToIntervals(BoundingBoxIntervals &intervals, BoundingBox *bbox) const;
+
 public:
     //
 private:
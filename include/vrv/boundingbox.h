@@ -10,6 +10,11 @@
 
 //----------------------------------------------------------------------------
 
+#include <array>
+
+//----------------------------------------------------------------------------
+
+#include "objectarena.h"
 #include "vrvdef.h"
 
 namespace vrv {
@@ -43,6 +48,14 @@ public:
     bool Is(const std::vector<ClassId> &classIds) const;
     ///@}
 
+    /**
+     * @name Class specific allocation, in the ObjectArena of the current scope if any.
+     */
+    ///@{
+    static void *operator new(size_t size) { return ObjectArena::AllocateObject(size); }
+    static void operator delete(void *ptr, size_t size) { ObjectArena::FreeObject(ptr, size); }
+    ///@}
+
     /**
      * @name Methods for updating the bounding boxes and for providing information about their status.
      */
@@ -76,6 +89,15 @@ public:
      */
     virtual void ResetBoundingBox();
 
+    /**
+     * @name Get and set all the bounding box values at once (content x1, y1, x2, y2 and then self x1, y1, x2, y2).
+     * This is used for restoring the values of an earlier layout.
+     */
+    ///@{
+    std::array<int, 8> GetBoundingBoxValues() const;
+    void SetBoundingBoxValues(const std::array<int, 8> &values);
+    ///@}
+
     /**
      * @name Get the X and Y drawing position.
      * Pure virtual methods
@@ -328,6 +350,82 @@ private:
     int m_smuflGlyphFontSize;
 };
 
+//----------------------------------------------------------------------------
+// BoundingBoxIntervals
+//----------------------------------------------------------------------------
+
+/**
+ * This class stores the horizontal intervals of a set of bounding boxes sorted by their left position.
+ * It is used by the collision passes for finding the boxes overlapping a horizontal span without testing all of them.
+ * The intervals are sorted on the first query and the boxes added after it are inserted in place.
+ */
+class BoundingBoxIntervals {
+public:
+    /**
+     * @name Constructors, destructors, reset methods
+     */
+    ///@{
+    BoundingBoxIntervals();
+    virtual ~BoundingBoxIntervals() = default;
+    void Reset();
+    ///@}
+
+    /**
+     * Add a box with its content left and right position.
+     * Boxes without a content bounding box are not added since they cannot overlap.
+     */
+    void Add(BoundingBox *box);
+
+    /**
+     * Add a box with an explicit interval, for example for including the extender of a floating positioner
+     */
+    void Add(BoundingBox *box, int left, int right);
+
+    /**
+     * Add all the boxes of an array with their content left and right position
+     */
+    void Add(const ArrayOfBoundingBoxes &boxes);
+
+    /**
+     * Check if no box was added
+     */
+    bool IsEmpty() const { return m_intervals.empty(); }
+
+    /**
+     * Find the boxes with an interval overlapping the open interval between left and right.
+     * The boxes are returned in the order they were added.
+     */
+    ArrayOfBoundingBoxes FindOverlaps(int left, int right);
+
+private:
+    /**
+     * Sort the intervals by left position, keeping the order they were added for equal positions
+     */
+    void Sort();
+
+public:
+    //
+private:
+    /**
+     * The interval of a box with the order in which it was added
+     */
+    struct Interval {
+        int m_left;
+        int m_right;
+        int m_order;
+        BoundingBox *m_box;
+    };
+
+    /** The intervals, sorted by left position once m_isSorted is set */
+    std::vector<Interval> m_intervals;
+    /** The widest interval for bounding the binary search */
+    int m_maxWidth;
+    /** The number of intervals added */
+    int m_count;
+    /** Flag indicating that the intervals are sorted */
+    bool m_isSorted;
+};
+
 //----------------------------------------------------------------------------
 // SegmentedLine
 //----------------------------------------------------------------------------
@@ -122,6 +122,11 @@ public:
      */
     void SetPageHeight(int height) { m_pageHeight = height; }
 
+    /*
+     * Set the page we are taking the content from
+     */
+    void SetContentPage(Page *page) { m_contentPage = page; }
+
     /*
      * Functor interface
      */
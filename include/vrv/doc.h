@@ -8,12 +8,20 @@
 #ifndef __VRV_DOC_H__
 #define __VRV_DOC_H__
 
+#include <functional>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+//----------------------------------------------------------------------------
+
 #include "devicecontextbase.h"
 #include "expansionmap.h"
 #include "facsimile.h"
 #include "options.h"
 #include "resources.h"
 #include "scoredef.h"
+#include "timemap.h"
 
 namespace smf {
 class MidiFile;
@@ -21,15 +29,93 @@ class MidiFile;
 
 namespace vrv {
 
+class CastOffPagesFunctor;
 class DocSelection;
 class FontInfo;
 class Glyph;
+class Measure;
 class Pages;
 class Page;
 class Score;
 
 enum DocType { Raw = 0, Rendering, Transcription, Facs };
 
+//----------------------------------------------------------------------------
+// DrawingContext
+//----------------------------------------------------------------------------
+
+/**
+ * This class holds the values set by Doc::SetDrawingPage for the page currently drawn.
+ * They are all current values to be used when drawing a page in a View and
+ * reset for every page. However, most of them are based on the m_staffDefin values
+ * and will remain the same. This can be optimized.
+ * The pages dimensions and margins are based on the page ones, the document ones or
+ * the default in the following order and if available.
+ * The document has its own context, which a Doc::DrawingContextScope replaces on the calling thread.
+ */
+class DrawingContext {
+public:
+    /**
+     * @name Constructors, destructors, reset methods
+     */
+    ///@{
+    DrawingContext();
+    virtual ~DrawingContext() = default;
+    void Reset();
+    ///@}
+
+private:
+    //
+public:
+    /** The page currently being drawn */
+    Page *m_drawingPage;
+    /** The current page height */
+    int m_drawingPageHeight;
+    /** The current page width */
+    int m_drawingPageWidth;
+    /** The current page content height (without margings) */
+    int m_drawingPageContentHeight;
+    /** The current page content width (without margins) */
+    int m_drawingPageContentWidth;
+    /** The current page bottom margin */
+    int m_drawingPageMarginBottom;
+    /** The current page left margin */
+    int m_drawingPageMarginLeft;
+    /** The current page right margin */
+    int m_drawingPageMarginRight;
+    /** The current page top margin */
+    int m_drawingPageMarginTop;
+    /** the current beam maximal slope */
+    float m_drawingBeamMaxSlope;
+    /** Height of a beam (10 and 6 by default) */
+    int m_drawingBeamWidth;
+    /** Height of a beam spacing (white) (10 and 6 by default) */
+    int m_drawingBeamWhiteWidth;
+    /** Brevis width */
+    int m_drawingBrevisWidth;
+
+    /** Smufl font size (100 par defaut) */
+    int m_drawingSmuflFontSize;
+    /** Lyric font size  */
+    int m_drawingLyricFontSize;
+    /** Fingering font size*/
+    int m_fingeringFontSize;
+    /** Current music font */
+    FontInfo m_drawingSmuflFont;
+    /** Current lyric font */
+    FontInfo m_drawingLyricFont;
+    /** Current fingering font */
+    FontInfo m_fingeringFont;
+    /** The scaled glyph metrics for the current music font, filled on demand */
+    mutable GlyphMetricsCache m_glyphMetricsCache;
+
+    /**
+     * The mutex of the objects drawn on several pages (e.g., the running elements) when the pages are drawn by
+     * several threads, NULL otherwise (see Doc::LockSharedDrawing)
+     */
+    std::recursive_mutex *m_sharedDrawingMutex;
+};
+
 //----------------------------------------------------------------------------
 // Doc
 //----------------------------------------------------------------------------
@@ -78,7 +164,11 @@ public:
      */
     ///@{
     const Resources &GetResources() const { return m_resources; }
-    Resources &GetResourcesForModification() { return m_resources; }
+    Resources &GetResourcesForModification()
+    {
+        this->GetDrawingContext().m_glyphMetricsCache.Reset();
+        return m_resources;
+    }
     ///@}
 
     /**
@@ -137,7 +227,7 @@ public:
     ///@}
 
     /**
-     * Get the total page count
+     * Get the total page count (without the pending page of a progressive layout)
      */
     int GetPageCount() const;
 
@@ -146,6 +236,11 @@ public:
      */
     bool GetMidiExportDone() const;
 
+    /**
+     * Return the metrics of a glyph scaled for the staff and grace sizes, through the glyph metrics cache
+     */
+    const GlyphMetricsCache::Metrics &GetGlyphMetrics(char32_t code, int staffSize, bool graceSize) const;
+
     /**
      * @name Get the height or width for a glyph taking into account the staff and grace sizes
      */
@@ -240,6 +335,16 @@ public:
      */
     bool HasTimemap() const;
 
+    /**
+     * @name Methods for the timemap index of the document.
+     * The index is built from the timemap on the first call, calculating the timemap if necessary.
+     * It is reset when the timemap is calculated and when children are added to or removed from the tree.
+     */
+    ///@{
+    const TimemapIndex &GetTimemapIndex();
+    void ResetTimemapIndex();
+    ///@}
+
     /**
      * Export the document to a MIDI file.
      * Run trough all the layers and fill the midi file content.
@@ -252,6 +357,12 @@ public:
      */
     bool ExportTimemap(std::string &output, bool includeRests, bool includeMeasures);
 
+    /**
+     * Extract a timemap from the document to a binary buffer with one column per field.
+     * See Timemap::ToBinary for the format.
+     */
+    bool ExportBinaryTimemap(std::vector<unsigned char> &output, bool includeRests, bool includeMeasures);
+
     /**
      *  Extract expansionMap from the document to JSON string.
      */
@@ -287,6 +398,28 @@ public:
      */
     void PrepareData();
 
+    /**
+     * The stages of the last data preparation with their wall time in milliseconds.
+     * The timings are recorded only in builds with the runtime clock (without NO_RUNTIME).
+     */
+    const std::vector<std::pair<std::string, double>> &GetPrepareDataTimings() const { return m_prepareDataTimings; }
+
+    /**
+     * @name A function called by the toolkit at the end of each stage of the loading of the data.
+     * The stages are "load" (including the generation of the header, footer and measure numbers), "prepareData"
+     * (including the transposition) and "castOff". It can be set for measuring them (e.g., by the benchmark tool).
+     */
+    ///@{
+    void SetLoadingStageCallback(const std::function<void(const std::string &)> &callback)
+    {
+        m_loadingStageCallback = callback;
+    }
+    void LoadingStageDone(const std::string &stage) const
+    {
+        if (m_loadingStageCallback) m_loadingStageCallback(stage);
+    }
+    ///@}
+
     /**
      * Casts off the entire document.
      * Starting from a single system, create and fill pages and systems.
@@ -319,6 +452,43 @@ public:
      */
     void UnCastOffDoc(bool resetCache = true);
 
+    /**
+     * @name Methods for the progressive layout (--progressive-layout).
+     * Doc::CastOffDocBase then lays out vertically and casts off only the systems of the first page.
+     * The other systems stay in a pending page kept as last page and are cast off when more pages are requested.
+     */
+    ///@{
+    /** Continue the cast-off until pageCount pages are complete (all of them by default) */
+    void CastOffPendingPages(int pageCount = VRV_UNSET);
+    bool HasPendingPages() const { return (m_castOffPendingPage != NULL); }
+    /** The number of pages completely cast off so far (i.e., without the page being filled) */
+    int GetCastOffPageCount() const;
+    ///@}
+
+    /**
+     * @name Methods for the damage tracking of the layout after editor actions.
+     * The measures of the objects edited are marked as damaged, or the whole document for objects not in a measure.
+     * Doc::LayOutDamagedPages then redoes the layout of the pages of the damaged measures only.
+     * It returns false when the system or page breaks change and the document needs to be cast off again.
+     * Everything that does not need the new layout is checked before it is changed.
+     */
+    ///@{
+    void AddLayoutDamage(Object *object);
+    bool HasLayoutDamage() const { return (m_layoutDamagedDoc || !m_layoutDamagedMeasureIds.empty()); }
+    bool LayOutDamagedPages();
+    void ResetLayoutDamage();
+    ///@}
+
+    /**
+     * @name Methods for the object arena of the document (--object-arena).
+     * The objects are allocated in the arena while an ObjectArena::Scope with it is active.
+     * Disabling the arena releases it, and it is deleted once its objects are deleted.
+     */
+    ///@{
+    void EnableObjectArena(bool enable);
+    ObjectArena *GetObjectArena() const { return m_objectArena; }
+    ///@}
+
     /**
      * Cast off of the entire document according to the encoded data (pb and sb).
      * Does not perform any check on the presence and / or validity of such data.
@@ -369,7 +539,7 @@ public:
      * We need to call this because otherwise looking at the page idx will fail.
      * See Doc::LayOut for an example.
      */
-    void ResetDataPage() { m_drawingPage = NULL; }
+    void ResetDataPage() { this->GetDrawingContext().m_drawingPage = NULL; }
 
     /**
      * Getter to the drawPage. Normally, getting the page should
@@ -377,10 +547,41 @@ public:
      * asserting that we currently have the right page.
      */
     ///@{
-    Page *GetDrawingPage() { return m_drawingPage; }
-    const Page *GetDrawingPage() const { return m_drawingPage; }
+    Page *GetDrawingPage() { return this->GetDrawingContext().m_drawingPage; }
+    const Page *GetDrawingPage() const { return this->GetDrawingContext().m_drawingPage; }
+    ///@}
+
+    /**
+     * Getter for the drawing context, which is the one of the document unless a Doc::DrawingContextScope
+     * replaces it on the calling thread
+     */
+    ///@{
+    DrawingContext &GetDrawingContext();
+    const DrawingContext &GetDrawingContext() const;
     ///@}
 
+    /**
+     * This class replaces the drawing context of a document on the calling thread while it is in scope.
+     * Several threads can then draw the pages of one document laid out beforehand, each with its own context.
+     */
+    class DrawingContextScope {
+    public:
+        DrawingContextScope(const Doc *doc, DrawingContext *context);
+        ~DrawingContextScope();
+        DrawingContextScope(const DrawingContextScope &) = delete;
+        DrawingContextScope &operator=(const DrawingContextScope &) = delete;
+
+    private:
+        const Doc *m_previousDoc;
+        DrawingContext *m_previousContext;
+    };
+
+    /**
+     * Lock the objects drawn on several pages when the pages are drawn by several threads.
+     * The lock does not own any mutex otherwise.
+     */
+    std::unique_lock<std::recursive_mutex> LockSharedDrawing() const;
+
     /**
      * Return the width adjusted to the content of the current drawing page.
      * This includes the appropriate left and right margins.
@@ -452,6 +653,21 @@ public:
     void ReactivateSelection(bool resetAligners);
     ///@}
 
+    /**
+     * @name Methods for the xml:id index of the document.
+     * The index maps the ids to the objects attached to the tree, including hidden ones.
+     * It is built on the first lookup and then kept up-to-date when children are added or removed.
+     * Changing the id of an attached object or casting off the document invalidates it.
+     * With duplicated ids, the first object in the tree order is kept.
+     */
+    ///@{
+    const Object *FindInIDIndex(const std::string &id) const;
+    void AddToIDIndex(Object *object);
+    void RemoveFromIDIndex(Object *object);
+    bool IsIDIndexValid() const { return m_idIndexIsValid; }
+    void InvalidateIDIndex();
+    ///@}
+
     //----------//
     // Functors //
     //----------//
@@ -477,6 +693,23 @@ private:
      */
     void PrepareMeasureIndices();
 
+    /**
+     * Lay out vertically the next system of the pending page and cast it off.
+     * Delete the pending page once it is empty.
+     */
+    void CastOffPendingSystem();
+
+    /**
+     * Set Page::m_score, Page::m_scoreEnd and Page::m_drawingScoreDef for the pages cast off progressively.
+     * The systems keep the drawing scoreDef set when they were all on the pending page.
+     */
+    void ScoreDefSetCastOffPages();
+
+    /**
+     * Delete the progressive layout state (the pending page itself is owned by the Pages)
+     */
+    void ResetPendingPages();
+
 public:
     Page *m_selectionPreceding;
     Page *m_selectionFollowing;
@@ -498,25 +731,6 @@ public:
      */
     pugi::xml_document m_back;
 
-    /** The current page height */
-    int m_drawingPageHeight;
-    /** The current page width */
-    int m_drawingPageWidth;
-    /** The current page content height (without margings) */
-    int m_drawingPageContentHeight;
-    /** The current page content width (without margins) */
-    int m_drawingPageContentWidth;
-    /** The current page bottom margin */
-    int m_drawingPageMarginBottom;
-    /** The current page left margin */
-    int m_drawingPageMarginLeft;
-    /** The current page right margin */
-    int m_drawingPageMarginRight;
-    /** The current page top margin */
-    int m_drawingPageMarginTop;
-    /** the current beam maximal slope */
-    float m_drawingBeamMaxSlope;
-
     /**
      * Record notation type for document.
      * (This should be improved by storing a vector of all notation types of the document for cases mixing notations)
@@ -558,36 +772,49 @@ private:
      */
     bool m_isCastOff;
 
-    /*
-     * The following values are set in the Doc::SetDrawingPage.
-     * They are all current values to be used when drawing a page in a View and
-     * reset for every page. However, most of them are based on the m_staffDefin values
-     * and will remain the same. This can be optimized.
-     * The pages dimensions and margins are based on the page ones, the document ones or
-     * the default in the following order and if available.
+    /**
+     * @name The state of the progressive layout.
+     * The pending page with the systems not cast off yet, the functor filling the pages, the shift of the
+     * next system as calculated by the AlignSystemsFunctor, the current score and the number of pages with
+     * their scoreDef set.
      */
+    ///@{
+    Page *m_castOffPendingPage;
+    CastOffPagesFunctor *m_castOffPages;
+    int m_castOffShift;
+    Score *m_castOffScore;
+    int m_castOffScoreDefPageCount;
+    ///@}
 
-    /** The page currently being drawn */
-    Page *m_drawingPage;
-    /** Height of a beam (10 and 6 by default) */
-    int m_drawingBeamWidth;
-    /** Height of a beam spacing (white) (10 and 6 by default) */
-    int m_drawingBeamWhiteWidth;
-    /** Brevis width */
-    int m_drawingBrevisWidth;
+    /**
+     * @name The damage tracking of the layout.
+     * The ids of the measures damaged since the last layout, a flag for the whole document and a flag indicating
+     * that the cached horizontal layout is not valid anymore and needs to be reset by Doc::UnCastOffDoc.
+     * The ids are looked up in the layout, so a measure deleted or moved since does not leave a dangling pointer.
+     */
+    ///@{
+    std::set<std::string> m_layoutDamagedMeasureIds;
+    bool m_layoutDamagedDoc;
+    bool m_layoutDamagedCache;
+    ///@}
 
-    /** Smufl font size (100 par defaut) */
-    int m_drawingSmuflFontSize;
-    /** Lyric font size  */
-    int m_drawingLyricFontSize;
-    /** Fingering font size*/
-    int m_fingeringFontSize;
-    /** Current music font */
-    FontInfo m_drawingSmuflFont;
-    /** Current lyric font */
-    FontInfo m_drawingLyricFont;
-    /** Current fingering font */
-    FontInfo m_fingeringFont;
+    /**
+     * The arena in which the objects are allocated (NULL if disabled)
+     */
+    ObjectArena *m_objectArena;
+
+    /**
+     * The drawing context of the document
+     */
+    DrawingContext m_drawingContext;
+
+    /**
+     * @name The drawing context replacing the one of the document on the thread (see Doc::DrawingContextScope)
+     */
+    ///@{
+    static thread_local const Doc *s_drawingContextDoc;
+    static thread_local DrawingContext *s_drawingContext;
+    ///@}
 
     /**
      * A flag to indicate whether the currentScoreDef has been set or not.
@@ -602,6 +829,12 @@ private:
      */
     bool m_dataPreparationDone;
 
+    /** The wall time of the stages of the last data preparation */
+    std::vector<std::pair<std::string, double>> m_prepareDataTimings;
+
+    /** The function called at the end of each stage of the loading */
+    std::function<void(const std::string &)> m_loadingStageCallback;
+
     /**
      * A flag to indicate that the timemap has been calculated.  The
      * timemap needs to be prepared before MIDI files or timemap JSON files
@@ -609,6 +842,9 @@ private:
      */
     double m_timemapTempo;
 
+    /** The timemap index, built lazily in GetTimemapIndex */
+    TimemapIndex m_timemapIndex;
+
     /**
      * A flag to indicate whereas the document contains analytical markup to be converted.
      * This is currently limited to @fermata and @tie. Other attribute markup (@accid and @artic)
@@ -637,6 +873,17 @@ private:
 
     /** Facsimile information */
     Facsimile *m_facsimile;
+
+    /**
+     * The xml:id index and its flags.
+     * Mutable because it is built lazily in FindInIDIndex.
+     */
+    ///@{
+    mutable std::unordered_map<std::string, Object *> m_idIndex;
+    mutable bool m_idIndexIsValid;
+    mutable bool m_idIndexIsBuilding;
+    mutable bool m_idIndexHasDuplicates;
+    ///@}
 };
 
 } // namespace vrv
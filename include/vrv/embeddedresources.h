@@ -0,0 +1,69 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        embeddedresources.h
+// Author:      Marco Martinelli
+// Created:     17/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __VRV_EMBEDDED_RESOURCES_H__
+#define __VRV_EMBEDDED_RESOURCES_H__
+
+#include <string>
+
+namespace vrv {
+
+//----------------------------------------------------------------------------
+// Embedded resources
+//----------------------------------------------------------------------------
+
+/**
+ * The font resources compiled into the library with the VRV_EMBED_RESOURCES build option.
+ * The tables are generated at build time from the data directory by tools/embed_resources.py
+ * and hold the values of the XML files as they are (i.e., not multiplied by 10 as in Glyph).
+ */
+
+struct EmbeddedAnchor {
+    const char *m_name;
+    double m_x;
+    double m_y;
+};
+
+struct EmbeddedGlyph {
+    char32_t m_code;
+    const char *m_codeStr;
+    /** The SMuFL name (NULL for text fonts) */
+    const char *m_name;
+    double m_x;
+    double m_y;
+    double m_width;
+    double m_height;
+    double m_horizAdvX;
+    int m_anchorCount;
+    const EmbeddedAnchor *m_anchors;
+    /** The content of the glyph XML file with the <symbol> (NULL for text fonts) */
+    const char *m_xml;
+};
+
+struct EmbeddedFont {
+    const char *m_name;
+    int m_unitsPerEm;
+    int m_glyphCount;
+    const EmbeddedGlyph *m_glyphs;
+};
+
+/**
+ * Return the embedded music font or the embedded text font with the name (NULL if not embedded)
+ */
+///@{
+const EmbeddedFont *GetEmbeddedFont(const std::string &fontName);
+const EmbeddedFont *GetEmbeddedTextFont(const std::string &fontName);
+///@}
+
+/**
+ * Return the content of the embedded footer.svg file
+ */
+const char *GetEmbeddedFooter();
+
+} // namespace vrv
+
+#endif
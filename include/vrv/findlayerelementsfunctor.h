@@ -12,6 +12,8 @@
 
 namespace vrv {
 
+class LayerElementIndex;
+
 //----------------------------------------------------------------------------
 // LayersInTimeSpanFunctor
 //----------------------------------------------------------------------------
@@ -192,6 +194,11 @@ public:
      */
     std::vector<const LayerElement *> GetElements() const { return m_elements; }
 
+    /*
+     * Run the search on the layer element index of a system instead of processing the system
+     */
+    void ProcessIndex(const LayerElementIndex &index);
+
     /*
      * Functor interface
      */
@@ -203,7 +210,9 @@ public:
 protected:
     //
 private:
-    //
+    // Add the element to the search result if it is spanned
+    void AddIfSpanned(const LayerElement *layerElement);
+
 public:
     //
 private:
@@ -225,6 +234,49 @@ private:
     std::vector<const LayerElement *> m_elements;
 };
 
+//----------------------------------------------------------------------------
+// BuildLayerElementIndexFunctor
+//----------------------------------------------------------------------------
+
+/**
+ * This class fills the layer element index of a system with the elements having a content bounding box.
+ */
+class BuildLayerElementIndexFunctor : public ConstFunctor {
+public:
+    /**
+     * @name Constructors, destructors
+     */
+    ///@{
+    BuildLayerElementIndexFunctor(LayerElementIndex *index);
+    virtual ~BuildLayerElementIndexFunctor() = default;
+    ///@}
+
+    /*
+     * Abstract base implementation
+     */
+    bool ImplementsEndInterface() const override { return false; }
+
+    /*
+     * Functor interface
+     */
+    ///@{
+    FunctorCode VisitLayerElement(const LayerElement *layerElement) override;
+    FunctorCode VisitMeasure(const Measure *measure) override;
+    ///@}
+
+protected:
+    //
+private:
+    //
+public:
+    //
+private:
+    // The index to fill
+    LayerElementIndex *m_index;
+    // The index of the current measure in the system
+    int m_measureIdx;
+};
+
 //----------------------------------------------------------------------------
 // GetRelativeLayerElementFunctor
 //----------------------------------------------------------------------------
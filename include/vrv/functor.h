@@ -248,6 +248,77 @@ private:
     bool m_processingData = false;
 };
 
+//----------------------------------------------------------------------------
+// CompositeFunctorBase
+//----------------------------------------------------------------------------
+
+/**
+ * This class groups functors to be processed in a single traversal of the tree (see Object::Process).
+ * Each functor keeps its own code, filters and visibility, and the objects are visited by the functors in the order
+ * they were added. This is only correct for functors that do not depend on the results of each other.
+ * All the functors have to be processed in the same direction.
+ * It is instanciated for the functors (CompositeFunctor) and for the const functors (ConstCompositeFunctor).
+ */
+template <class FUNCTOR> class CompositeFunctorBase {
+public:
+    /**
+     * @name Constructors, destructors
+     */
+    ///@{
+    CompositeFunctorBase() {}
+    virtual ~CompositeFunctorBase() = default;
+    ///@}
+
+    /**
+     * Add a functor to the group
+     */
+    void Add(FUNCTOR *functor) { m_functors.push_back(functor); }
+
+    /**
+     * Getter for the functors
+     */
+    const std::vector<FUNCTOR *> &GetFunctors() const { return m_functors; }
+
+    /**
+     * Return the direction of the functors (FORWARD if empty)
+     */
+    bool GetDirection() const { return m_functors.empty() ? FORWARD : m_functors.front()->GetDirection(); }
+
+private:
+    //
+public:
+    //
+private:
+    // The functors in the order they visit each object
+    std::vector<FUNCTOR *> m_functors;
+};
+
+//----------------------------------------------------------------------------
+// CompositeFunctor
+//----------------------------------------------------------------------------
+
+/**
+ * This class groups functors modifying the tree.
+ */
+class CompositeFunctor : public CompositeFunctorBase<Functor> {
+public:
+    CompositeFunctor() {}
+    virtual ~CompositeFunctor() = default;
+};
+
+//----------------------------------------------------------------------------
+// ConstCompositeFunctor
+//----------------------------------------------------------------------------
+
+/**
+ * This class groups functors not modifying the tree.
+ */
+class ConstCompositeFunctor : public CompositeFunctorBase<ConstFunctor> {
+public:
+    ConstCompositeFunctor() {}
+    virtual ~ConstCompositeFunctor() = default;
+};
+
 } // namespace vrv
 
 #endif // __VRV_FUNCTOR_H__
@@ -9,6 +9,7 @@
 #define __VRV_GLYPH_H__
 
 #include <algorithm>
+#include <memory>
 #include <string>
 
 //----------------------------------------------------------------------------
@@ -16,6 +17,10 @@
 #include "devicecontextbase.h"
 #include "vrvdef.h"
 
+namespace pugi {
+class xml_document;
+}
+
 namespace vrv {
 
 /**
@@ -74,6 +79,18 @@ public:
     void SetPath(const std::string &path) { m_path = path; }
     ///@}
 
+    /**
+     * Return the XML document with the <symbol> of the glyph for the SVG output.
+     * The file is loaded only the first time and the document is then kept in memory.
+     */
+    const pugi::xml_document &GetXML() const;
+
+    /**
+     * Set the content of the glyph XML file when it is embedded in the library.
+     * The content is then used instead of the file given by the path.
+     */
+    void SetEmbeddedXML(const char *embeddedXML) { m_embeddedXML = embeddedXML; }
+
     /**
      * @name Setter and getter for the horizAdvX
      */
@@ -124,6 +141,10 @@ private:
     std::string m_codeStr;
     /** Path to the glyph XML file */
     std::string m_path;
+    /** The embedded content of the file (if any) - not owned */
+    const char *m_embeddedXML;
+    /** The XML content of the file, loaded when first requested and shared by copies */
+    mutable std::shared_ptr<pugi::xml_document> m_xml;
     /** A map of the available anchors */
     std::map<SMuFLGlyphAnchor, Point> m_anchors;
     /** A flag indicating it is a fallback */
@@ -72,6 +72,13 @@ public:
     // read
     virtual bool Import(std::string const &data) { return true; }
 
+    /**
+     * Import the data from a buffer that can be modified by the parser (i.e., parsed in place).
+     * The buffer needs to remain valid only during the import.
+     * The default implementation copies the data and calls Import.
+     */
+    virtual bool ImportInPlace(char *data, size_t size) { return this->Import(std::string(data, size)); }
+
     /**
      * Getter for layoutInformation flag that is set to true during import
      * if layout information is found (and not to be ignored).
@@ -10,6 +10,9 @@
 
 #include <sstream>
 #include <stack>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 //----------------------------------------------------------------------------
 
@@ -608,8 +611,29 @@ public:
     virtual ~MEIInput();
 
     bool Import(const std::string &mei) override;
+    bool ImportInPlace(char *mei, size_t size) override;
 
 private:
+    /**
+     * The Read*Children methods in which an element of the reader table is read
+     */
+    enum ReadingContext {
+        READING_SECTION = 1 << 0,
+        READING_SCOREDEF = 1 << 1,
+        READING_MEASURE = 1 << 2,
+        READING_STAFF = 1 << 3,
+        READING_LAYER = 1 << 4
+    };
+
+    /**
+     * An entry of the reader table with the method reading the element and the contexts in which it is read.
+     * The method is NULL for editorial elements, which are read with ReadEditorialElement.
+     */
+    struct ElementReader {
+        bool (MEIInput::*m_method)(Object *parent, pugi::xml_node element);
+        int m_contexts;
+    };
+
     bool ReadDoc(pugi::xml_node root);
     bool ReadIncipits(pugi::xml_node root);
 
@@ -859,7 +883,12 @@ private:
     /**
      * Returns true if the element is name is an editorial element (e.g., "app", "supplied", etc.)
      */
-    bool IsEditorialElementName(std::string elementName);
+    bool IsEditorialElementName(std::string_view elementName);
+
+    /**
+     * Return the entry of the element in the reader table, or NULL if the element is not in it
+     */
+    const ElementReader *FindElementReader(std::string_view elementName) const;
 
     /**
      * Normalize attributes of xmlElement, removing white spaces if necessary
@@ -946,7 +975,7 @@ private:
     /**
      * Check if an element is allowed within a given parent
      */
-    bool IsAllowed(std::string element, Object *filterParent);
+    bool IsAllowed(std::string_view element, Object *filterParent);
 
     /**
      * The selected <mdiv>.
@@ -964,9 +993,15 @@ private:
     //----------------//
 
     /**
-     * A static array for storing the implemented editorial elements
+     * A static table of the element readers used by the Read*Children methods, by element name
+     */
+    static const std::unordered_map<std::string_view, ElementReader> s_elementReaders;
+
+    /**
+     * A static table of the elements allowed within a filter parent (see IsAllowed), by class id of the parent.
+     * Text is always allowed. Control elements, running elements and div not listed have a default filter.
      */
-    static const std::vector<std::string> s_editorialElementNames;
+    static const std::unordered_map<ClassId, std::vector<std::string_view>> s_allowedChildren;
 };
 
 } // namespace vrv
@@ -11,6 +11,7 @@
 #include <map>
 #include <optional>
 #include <queue>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -52,6 +53,7 @@ class Octave;
 class Pedal;
 class Section;
 class Slur;
+class StaffDef;
 class StaffGrp;
 class Tempo;
 class Tie;
@@ -352,6 +354,42 @@ private:
     std::string GetContentOfChild(const pugi::xml_node node, const std::string &child) const;
     ///@}
 
+    /*
+     * @name Helper methods for navigating the children without evaluating XPath queries.
+     * Each of them is the equivalent of the XPath query given in its comment.
+     */
+    ///@{
+    /** name[not(@print-object='no')] */
+    pugi::xml_node GetPrintedChild(const pugi::xml_node node, const std::string &name) const;
+    /** name[not(@attribute)] */
+    pugi::xml_node GetChildWithoutAttribute(
+        const pugi::xml_node node, const std::string &name, const std::string &attribute) const;
+    /** child/grandChild */
+    pugi::xml_node GetGrandChild(
+        const pugi::xml_node node, const std::string &child, const std::string &grandChild) const;
+    /** child/grandChild[@attribute='value'] */
+    pugi::xml_node GetGrandChildWithAttribute(const pugi::xml_node node, const std::string &child,
+        const std::string &grandChild, const std::string &attribute, const std::string &value) const;
+    /** *[contains(name(), 'part1') or contains(name(), 'part2')...] within child */
+    pugi::xml_node GetGrandChildContaining(
+        const pugi::xml_node node, const std::string &child, const std::vector<std::string> &parts) const;
+    /** *[self::name1 or self::name2...] within child, in document order */
+    std::vector<pugi::xml_node> GetGrandChildren(
+        const pugi::xml_node node, const std::string &child, const std::vector<std::string> &names) const;
+    /** beam[@number='number'][text()='value'], or beam[text()='value'] with a number of 0 */
+    pugi::xml_node GetBeamWithValue(const pugi::xml_node node, const std::string &value, int number = 0) const;
+    ///@}
+
+    /*
+     * @name Methods for collecting and retrieving the per-part state.
+     * They replace the lookups in the MEI tree and the XPath queries evaluated for each measure or note.
+     */
+    ///@{
+    void CollectClosedEndings(const pugi::xml_node root);
+    void AddSectionMeasure(Section *section, Measure *measure);
+    Measure *GetSectionMeasure(const std::string &measureNum) const;
+    ///@}
+
     /*
      * @name Methods for opening and closing ties and slurs.
      * Opened ties and slurs are stacked together with musicxml::OpenTie
@@ -373,7 +411,7 @@ private:
     ///@{
     ///@}
     std::string GetWordsOrDynamicsText(const pugi::xml_node node) const;
-    void TextRendition(const pugi::xpath_node_set words, ControlElement *element) const;
+    void TextRendition(const std::vector<pugi::xml_node> &words, ControlElement *element) const;
     std::string StyleLabel(pugi::xml_node display);
     void PrintMetronome(pugi::xml_node metronome, Tempo *tempo);
 
@@ -564,6 +602,15 @@ private:
     std::map<Measure *, int> m_measureCounts;
     /* measure rests */
     std::map<int, int> m_multiRests;
+    /* the number of measures in the section and the measures for each measure number, in section order */
+    int m_sectionMeasureCount;
+    std::map<std::string, std::vector<Measure *>> m_sectionMeasures;
+    /* the staffDefs by staff number */
+    std::map<int, StaffDef *> m_staffDefs;
+    /* the ending starts with a corresponding stop or discontinue */
+    std::set<pugi::xml_node> m_closedEndings;
+    /* flag indicating that the part being read is the first one */
+    bool m_isFirstPart;
 
 #endif // NO_MUSICXML_SUPPORT
 };
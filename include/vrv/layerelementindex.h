@@ -0,0 +1,129 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        layerelementindex.h
+// Author:      Marco Martinelli
+// Created:     17/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __VRV_LAYERELEMENTINDEX_H__
+#define __VRV_LAYERELEMENTINDEX_H__
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+//----------------------------------------------------------------------------
+
+#include "vrvdef.h"
+
+namespace vrv {
+
+class LayerElement;
+class Measure;
+class System;
+
+//----------------------------------------------------------------------------
+// LayerElementIndex
+//----------------------------------------------------------------------------
+
+/**
+ * This class is a spatial index of the layer elements of a system.
+ * The elements with a content bounding box are stored by staff and by class, sorted by their left position.
+ * Looking for the elements between two horizontal positions is then a binary search instead of a traversal.
+ * The index is built from the current bounding boxes and has to be reset when the system is drawn again.
+ */
+class LayerElementIndex {
+public:
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    LayerElementIndex();
+    virtual ~LayerElementIndex() = default;
+    ///@}
+
+    /**
+     * Build the index from the layer elements of the system
+     */
+    void Build(const System *system);
+
+    /**
+     * Clear the index
+     */
+    void Reset();
+
+    /**
+     * Return true if the index was built and not reset
+     */
+    bool IsBuilt() const { return m_isBuilt; }
+
+    /**
+     * Add a layer element with the index of its measure in the system.
+     * Elements have to be added in the order of a traversal of the system.
+     */
+    void AddElement(const LayerElement *layerElement, int measureIdx);
+
+    /**
+     * Add a measure of the system, in the order of a traversal
+     */
+    void AddMeasure(const Measure *measure);
+
+    /**
+     * Find the elements of the given classes with a content bounding box overlapping the horizontal boundary.
+     * Only the elements on the given staves (as parent or cross staff) are returned, or on any staff if empty.
+     * Only the elements in the measures between the start and end measures are returned.
+     * The elements are returned in the order of a traversal of the system.
+     */
+    std::vector<const LayerElement *> FindElements(const std::vector<ClassId> &classIds, const std::set<int> &staffNs,
+        int minPos, int maxPos, const Measure *startMeasure, const Measure *endMeasure) const;
+
+private:
+    /**
+     * Return the index of the first measure of the system not preceding the start measure,
+     * or of the last measure not following the end measure
+     */
+    ///@{
+    int GetStartMeasureIdx(const Measure *startMeasure) const;
+    int GetEndMeasureIdx(const Measure *endMeasure) const;
+    ///@}
+
+    /**
+     * Sort the elements of each list by left position
+     */
+    void Sort();
+
+private:
+    /**
+     * An element in the index with its content left and right positions, its traversal order and measure index
+     */
+    struct Entry {
+        int m_left;
+        int m_right;
+        int m_order;
+        int m_measureIdx;
+        const LayerElement *m_element;
+    };
+
+    /**
+     * A list of entries sorted by left position, with the widest entry for bounding the binary search
+     */
+    struct EntryList {
+        std::vector<Entry> m_entries;
+        int m_maxWidth = 0;
+    };
+
+    /** The lists of elements by class and by staff number */
+    std::map<std::pair<ClassId, int>, EntryList> m_lists;
+    /** The measures of the system and their index */
+    std::vector<const Measure *> m_measures;
+    std::map<const Measure *, int> m_measureIdx;
+    /** The number of elements added */
+    int m_elementCount;
+    /** Flag indicating that the index was built */
+    bool m_isBuilt;
+};
+
+} // namespace vrv
+
+#endif // __VRV_LAYERELEMENTINDEX_H__
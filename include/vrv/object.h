@@ -8,6 +8,7 @@
 #ifndef __VRV_OBJECT_H__
 #define __VRV_OBJECT_H__
 
+#include <atomic>
 #include <cstdlib>
 #include <functional>
 #include <iterator>
@@ -34,6 +35,8 @@ class Functor;
 class FunctorParams;
 class Functor;
 class ConstFunctor;
+class CompositeFunctor;
+class ConstCompositeFunctor;
 class LinkingInterface;
 class FacsimileInterface;
 class PitchInterface;
@@ -112,20 +115,23 @@ public:
 
     /**
      * @name Methods for registering a MEI att class and for registering interfaces regrouping MEI att classes.
+     * The registration is stored once per ClassId in a static table and not in each object.
+     * Registering is idempotent and the look-up is constant-time.
      */
     ///@{
-    void RegisterAttClass(AttClassId attClassId) { m_attClasses.push_back(attClassId); }
-    bool HasAttClass(AttClassId attClassId) const
-    {
-        return std::find(m_attClasses.begin(), m_attClasses.end(), attClassId) != m_attClasses.end();
-    }
+    void RegisterAttClass(AttClassId attClassId) { s_classRegistry[m_classId].AddAttClass(attClassId); }
+    bool HasAttClass(AttClassId attClassId) const { return s_classRegistry[m_classId].HasAttClass(attClassId); }
     void RegisterInterface(std::vector<AttClassId> *attClasses, InterfaceId interfaceId);
-    bool HasInterface(InterfaceId interfaceId) const
-    {
-        return std::find(m_interfaces.begin(), m_interfaces.end(), interfaceId) != m_interfaces.end();
-    }
+    bool HasInterface(InterfaceId interfaceId) const { return s_classRegistry[m_classId].HasInterface(interfaceId); }
     ///@}
 
+    /**
+     * Log the number of objects per class in the tree with the att classes and interfaces registered
+     * for each of them (debug level), and the total number of objects and classes with the size of the registry.
+     * The whole tree is traversed, so this is meant to be called only on request.
+     */
+    void LogClassReport() const;
+
     /**
      * @name Getter to interfaces
      */
@@ -243,7 +249,7 @@ public:
     virtual void CloneReset();
 
     const std::string &GetID() const { return m_id; }
-    void SetID(const std::string &id) { m_id = id; }
+    void SetID(const std::string &id);
     void SwapID(Object *other);
     void ResetID();
 
@@ -357,6 +363,12 @@ public:
      */
     void ResetParent() { m_parent = NULL; }
 
+    /**
+     * Return true if the object is part of the tree of a Doc.
+     * The flag is set and reset when children are added or removed and is used for the Doc xml:id index.
+     */
+    bool IsAttachedToDoc() const { return m_isAttachedToDoc; }
+
     /**
      * Base method for checking if a child can be added.
      * The method has to be overridden.
@@ -650,6 +662,15 @@ public:
     void Process(ConstFunctor &functor, int deepness = UNLIMITED_DEPTH, bool skipFirst = false) const;
     ///@}
 
+    /**
+     * Process all the functors of the composite in a single traversal.
+     * Each functor follows its own codes and filters as if processed alone, with no deepness limit.
+     */
+    ///@{
+    void Process(CompositeFunctor &composite);
+    void Process(ConstCompositeFunctor &composite) const;
+    ///@}
+
     /**
      * Interface for class functor visitation
      */
@@ -668,6 +689,33 @@ public:
 
     static std::string GenerateHashID();
 
+    /**
+     * Reserve the next xml:id of the generator of the thread and return the state for generating it.
+     * See Object::IDScope.
+     */
+    static uint32_t ReserveIDState() { return s_xmlIDCounter++; }
+
+    /**
+     * This class sets the state of the xml:id generator of the thread while it is in scope.
+     * With a state returned by Object::ReserveIDState, the xml:ids generated in the scope do not depend on what the
+     * thread generated in-between, and the first one is the one reserved.
+     */
+    class IDScope {
+    public:
+        explicit IDScope(uint32_t state) : m_previous(s_xmlIDCounter)
+        {
+            // The generator is set and must not be seeded by the first object created by the thread
+            if (s_objectCounter == 0) s_objectCounter = 1;
+            s_xmlIDCounter = state;
+        }
+        ~IDScope() { s_xmlIDCounter = m_previous; }
+        IDScope(const IDScope &) = delete;
+        IDScope &operator=(const IDScope &) = delete;
+
+    private:
+        uint32_t m_previous;
+    };
+
     static uint32_t Hash(uint32_t number, bool reverse = false);
 
     static bool sortByUlx(Object *a, Object *b);
@@ -677,7 +725,38 @@ public:
      */
     static bool IsPreOrdered(const Object *left, const Object *right);
 
+protected:
+    /**
+     * @name Methods for keeping the Doc xml:id index up-to-date.
+     * They have to be called by AddChild overrides that modify the children directly.
+     * OnChildRemoved has to be called before the parent of the child is reset.
+     */
+    ///@{
+    void OnChildAdded(Object *child);
+    void OnChildRemoved(Object *child);
+    ///@}
+
+    /**
+     * Recursively add the object and its (owned) descendants to the Doc xml:id index or remove them.
+     * The attached flag of the objects is updated accordingly.
+     */
+    void UpdateIDIndex(Doc *doc, bool attached);
+
 private:
+    /**
+     * Return the Doc at the root of the tree (NULL if the root is not a Doc).
+     */
+    ///@{
+    Doc *GetRootDoc();
+    const Doc *GetRootDoc() const;
+    ///@}
+
+    /**
+     * Look for the id in the Doc xml:id index.
+     * Return false when the index cannot answer for this object and the tree has to be processed.
+     */
+    bool FindInDocIDIndex(const std::string &id, const Object *&element) const;
+
     /**
      * Method for generating the id.
      */
@@ -694,9 +773,17 @@ private:
     ///@{
     void UpdateDocumentScore(bool direction);
     bool SkipChildren(bool visibleOnly) const;
-    bool FiltersApply(const Filters *filters, Object *object) const;
+    bool FiltersApply(const Filters *filters, const Object *object) const;
     ///@}
 
+    /**
+     * Process the object for the functors from first to the end of the array.
+     * The array is used as a stack for the functors processing the children.
+     * OBJECT is a const Object for the const functors.
+     */
+    template <class FUNCTOR, class OBJECT>
+    static void ProcessComposite(OBJECT *object, std::vector<FUNCTOR *> &functors, size_t first, bool direction);
+
 public:
     /**
      * Keep an array of unsupported attributes as pairs.
@@ -737,6 +824,12 @@ private:
      */
     bool m_isReferenceObject;
 
+    /**
+     * Indicates whether the object is part of the tree of a Doc.
+     * Members of objects that have a parent but are not children (e.g., aligners) are not attached.
+     */
+    bool m_isAttachedToDoc;
+
     /**
      * Indicates whether the object content is up-to-date or not.
      * This is useful for object using sub-lists of objects when drawing.
@@ -755,16 +848,6 @@ private:
     mutable ClassId m_iteratorElementType;
     ///@}
 
-    /**
-     * A vector for storing the list of AttClassId (MEI att classes) implemented.
-     */
-    std::vector<AttClassId> m_attClasses;
-
-    /**
-     * A vector for storing the list of InterfaceId (group of MEI att classes) implemented.
-     */
-    std::vector<InterfaceId> m_interfaces;
-
     /**
      * String for storing a comments attached to the object when printing an MEI element.
      * m_comment is to be printed immediately before the element
@@ -798,6 +881,40 @@ private:
      * XML id counter
      */
     static thread_local uint32_t s_xmlIDCounter;
+
+    /**
+     * The att classes and interfaces registered for a ClassId, stored as bitsets.
+     * The words are atomic because objects can be constructed concurrently by several toolkits.
+     */
+    struct ClassRegistration {
+        static constexpr int s_wordBits = 64;
+
+        void AddAttClass(AttClassId attClassId)
+        {
+            std::atomic<uint64_t> &word = m_attClasses[attClassId / s_wordBits];
+            const uint64_t mask = uint64_t(1) << (attClassId % s_wordBits);
+            if (!(word.load(std::memory_order_relaxed) & mask)) word.fetch_or(mask, std::memory_order_relaxed);
+        }
+        bool HasAttClass(AttClassId attClassId) const
+        {
+            const uint64_t mask = uint64_t(1) << (attClassId % s_wordBits);
+            return (m_attClasses[attClassId / s_wordBits].load(std::memory_order_relaxed) & mask);
+        }
+        bool HasInterface(InterfaceId interfaceId) const
+        {
+            return (m_interfaces.load(std::memory_order_acquire) & (uint64_t(1) << interfaceId));
+        }
+        int GetAttClassCount() const;
+        int GetInterfaceCount() const;
+
+        std::atomic<uint64_t> m_attClasses[(ATT_CLASS_max + s_wordBits - 1) / s_wordBits];
+        std::atomic<uint64_t> m_interfaces;
+    };
+
+    /**
+     * The registry of att classes and interfaces indexed by ClassId
+     */
+    static ClassRegistration s_classRegistry[UNSPECIFIED + 1];
 };
 
 //----------------------------------------------------------------------------
@@ -0,0 +1,180 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        objectarena.h
+// Author:      Marco Martinelli
+// Created:     17/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __VRV_OBJECTARENA_H__
+#define __VRV_OBJECTARENA_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+//----------------------------------------------------------------------------
+
+namespace vrv {
+
+//----------------------------------------------------------------------------
+// ObjectArena
+//----------------------------------------------------------------------------
+
+/**
+ * This class is a pool allocator for the objects of a Doc (BoundingBox and derived classes).
+ * Memory is reserved in large chunks and freed blocks are recycled through free lists per size.
+ * Objects allocated while an ObjectArena::Scope is active are allocated in its arena, other ones on the heap.
+ * The objects on the heap have no overhead. The chunks of the arenas are aligned on their size and their owner is
+ * registered in a table by chunk number, so the arena of an object freed is found without locking.
+ * The arena is not thread-safe and has to be used by one thread at a time, as its Doc.
+ * It is owned by the Doc and by the objects still alive, and deleted once it is released and empty.
+ */
+class ObjectArena {
+public:
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    ObjectArena();
+    ObjectArena(const ObjectArena &) = delete;
+    ObjectArena &operator=(const ObjectArena &) = delete;
+    ///@}
+
+    /**
+     * Release the arena by its owner.
+     * The arena is deleted immediately if empty, or otherwise when its last object is freed.
+     */
+    void Release();
+
+    /**
+     * @name Getters for the allocation counts
+     */
+    ///@{
+    /** The number of allocations made in the arena */
+    unsigned long GetAllocationCount() const { return m_allocationCount; }
+    /** The number of allocations that recycled a freed block */
+    unsigned long GetReuseCount() const { return m_reuseCount; }
+    /** The number of objects currently alive in the arena */
+    unsigned long GetLiveCount() const { return m_liveCount; }
+    /** The number of times the arena was emptied and rewound */
+    unsigned long GetRewindCount() const { return m_rewindCount; }
+    /** The number of bytes reserved in chunks */
+    size_t GetReservedBytes() const { return m_chunks.size() * s_chunkSize; }
+    ///@}
+
+    /**
+     * Log the allocation counts of the arena
+     */
+    void LogStatistics() const;
+
+    //----------------//
+    // Static methods //
+    //----------------//
+
+    /**
+     * @name Allocate and free an object through the arena of the current scope or on the heap.
+     * These are to be used only by BoundingBox::operator new and BoundingBox::operator delete.
+     * The size given when freeing is the one of the object, as given when it was allocated.
+     */
+    ///@{
+    static void *AllocateObject(size_t size);
+    static void FreeObject(void *ptr, size_t size);
+    ///@}
+
+    /**
+     * The number of objects allocated on the heap (outside any arena) by the current thread
+     */
+    static unsigned long GetHeapAllocationCount() { return s_heapAllocationCount; }
+
+    /**
+     * This class sets the arena in which the objects are allocated while it is in scope.
+     * Scopes can be nested and a NULL arena allocates the objects on the heap.
+     */
+    class Scope {
+    public:
+        explicit Scope(ObjectArena *arena) : m_previous(s_current) { s_current = arena; }
+        ~Scope() { s_current = m_previous; }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        ObjectArena *m_previous;
+    };
+
+private:
+    ~ObjectArena();
+
+    /**
+     * Allocate a block, or return NULL if a new chunk is needed and cannot be registered
+     */
+    void *Allocate(size_t blockSize);
+    void Free(void *block, size_t blockSize);
+
+    /**
+     * Recycle all the chunks once the arena is empty
+     */
+    void Rewind();
+
+    /**
+     * The size of the block of an object, as a multiple of the alignment
+     */
+    static size_t GetBlockSize(size_t size) { return (size + s_alignment - 1) / s_alignment * s_alignment; }
+
+    /**
+     * Find the arena in which an object was allocated through the chunk owners (NULL if on the heap)
+     */
+    static ObjectArena *FindArena(void *ptr);
+
+    /**
+     * Set the owner of a chunk (NULL for unregistering it).
+     * Return false if the chunk is beyond the addresses covered by the table.
+     */
+    static bool SetChunkOwner(const char *chunk, ObjectArena *arena);
+
+    /** The chunks reserved and the position in the current one */
+    std::vector<char *> m_chunks;
+    size_t m_currentChunk;
+    size_t m_chunkOffset;
+    /** The heads of the free lists, one for each block size */
+    std::vector<void *> m_freeLists;
+    /** Flag indicating that the owner released the arena */
+    bool m_released;
+
+    /** Allocation counts */
+    unsigned long m_allocationCount;
+    unsigned long m_reuseCount;
+    unsigned long m_liveCount;
+    unsigned long m_rewindCount;
+
+    /** The chunk size (and alignment), the largest block allocated in the arena and the block alignment */
+    static constexpr int s_chunkBits = 20;
+    static constexpr size_t s_chunkSize = (size_t)1 << s_chunkBits;
+    static constexpr size_t s_maxBlockSize = 16 * 1024;
+    static constexpr size_t s_alignment = alignof(std::max_align_t);
+
+    /** The arena of the current scope */
+    static thread_local ObjectArena *s_current;
+    /** The number of arenas existing in all threads */
+    static std::atomic<int> s_arenaCount;
+    /**
+     * The owners of the chunks of all the arenas by chunk number (address / chunk size), in a two-level table.
+     * The leaves are created on demand for the address ranges used and never freed. They are created with the
+     * mutex held, but are read without it.
+     */
+    static constexpr int s_leafBits = 14;
+    static constexpr int s_addressBits = (sizeof(void *) > 4) ? 48 : 32;
+    static constexpr uintptr_t s_leafCount = (s_addressBits - s_chunkBits > s_leafBits)
+        ? (uintptr_t)1 << (s_addressBits - s_chunkBits - s_leafBits)
+        : 1;
+    static std::atomic<std::atomic<ObjectArena *> *> s_chunkOwners[s_leafCount];
+    static std::mutex s_chunkOwnersMutex;
+    /** The number of objects allocated on the heap */
+    static thread_local unsigned long s_heapAllocationCount;
+
+}; // class ObjectArena
+
+} // namespace vrv
+
+#endif // __VRV_OBJECTARENA_H__
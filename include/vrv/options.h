@@ -595,7 +595,9 @@ public:
     OptionBool m_standardOutput;
     OptionBool m_help;
     OptionBool m_allPages;
+    OptionString m_batch;
     OptionString m_inputFrom;
+    OptionInt m_threads;
     OptionString m_logLevel;
     OptionString m_outfile;
     OptionInt m_page;
@@ -633,6 +635,7 @@ public:
     OptionBool m_moveScoreDefinitionToStaff;
     OptionBool m_neumeAsNote;
     OptionBool m_noJustification;
+    OptionBool m_objectArena;
     OptionBool m_openControlEvents;
     OptionBool m_outputFormatRaw;
     OptionInt m_outputIndent;
@@ -646,8 +649,10 @@ public:
     OptionInt m_pageWidth;
     OptionIntMap m_pedalStyle;
     OptionBool m_preserveAnalyticalMarkup;
+    OptionBool m_progressiveLayout;
     OptionBool m_removeIds;
     OptionBool m_scaleToPageSize;
+    OptionBool m_showClassReport;
     OptionBool m_showRuntime;
     OptionBool m_shrinkToFit;
     OptionIntMap m_smuflTextFont;
@@ -9,6 +9,7 @@
 #define __VRV_PAGE_H__
 
 #include "object.h"
+#include "runningelement.h"
 #include "scoredef.h"
 
 namespace vrv {
@@ -92,6 +93,20 @@ public:
      */
     void LayOut(bool force = false);
 
+    /**
+     * @name Check if the layout has been done and reset it for having it done again when the page is drawn
+     */
+    ///@{
+    bool IsLayoutDone() const { return m_layoutDone; }
+    void ResetLayoutDone() { m_layoutDone = false; }
+    ///@}
+
+    /**
+     * Set the page as the drawing page of its header and footer and restore their layout for it.
+     * This is necessary because they are shared by the pages.
+     */
+    void ResetRunningElements();
+
     /**
      * Do the layout for a transcription page (with layout information).
      * This only calculates positioning or layer element parts using provided layout of parents.
@@ -236,6 +251,14 @@ private:
      * the force parameter is set.
      */
     bool m_layoutDone;
+
+    /**
+     * The layout of the header and of the footer for the page, stored at the end of Page::LayOut
+     */
+    ///@{
+    RunningElementLayout m_headerLayout;
+    RunningElementLayout m_footerLayout;
+    ///@}
 };
 
 } // namespace vrv
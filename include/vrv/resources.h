@@ -8,7 +8,11 @@
 #ifndef __VRV_RESOURCES_H__
 #define __VRV_RESOURCES_H__
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 //----------------------------------------------------------------------------
 
@@ -16,6 +20,8 @@
 
 namespace vrv {
 
+struct EmbeddedFont;
+
 //----------------------------------------------------------------------------
 // Resources
 //----------------------------------------------------------------------------
@@ -23,6 +29,8 @@ namespace vrv {
 /**
  * This class provides resource values.
  * It manages fonts and glyph tables.
+ * The glyph tables are immutable once loaded and shared between all the instances that use the same resource path
+ * and font. Loading a text font or a font for which no tables are registered creates new tables (copy-on-write).
  */
 
 class Resources {
@@ -32,6 +40,14 @@ public:
     using GlyphNameTable = std::unordered_map<std::string, char32_t>;
     using GlyphTextMap = std::map<StyleAttributes, GlyphTable>;
 
+    /**
+     * The range of the private use area where the SMuFL glyphs are defined
+     */
+    ///@{
+    static constexpr char32_t k_privateUseFirst = 0xE000;
+    static constexpr char32_t k_privateUseLast = 0xF8FF;
+    ///@}
+
     /**
      * @name Constructors, destructors, and other standard methods
      */
@@ -51,6 +67,14 @@ public:
     void SetPath(const std::string &path) { m_path = path; }
     ///@}
 
+#ifdef VRV_EMBED_RESOURCES
+    /**
+     * The resources compiled into the library are used unless a resource path other than the default one was set.
+     * This applies to the music fonts, the text fonts and the footer.
+     */
+    bool UseEmbeddedResources() const { return (m_path == s_defaultPath); }
+#endif
+
     /**
      * Font initialization
      */
@@ -61,7 +85,7 @@ public:
     bool InitTextFont(const std::string &fontName, const StyleAttributes &style);
     /** Select a particular font */
     bool SetFont(const std::string &fontName);
-    std::string GetCurrentFontName() const { return m_fontName; }
+    std::string GetCurrentFontName() const { return m_fontTables->m_fontName; }
     ///@}
 
     /**
@@ -98,22 +122,61 @@ public:
     static char32_t GetSmuflGlyphForUnicodeChar(const char32_t unicodeChar);
 
 private:
-    bool LoadFont(const std::string &fontName, bool withFallback = true);
+    /**
+     * The glyph tables of the loaded fonts
+     */
+    struct FontTables {
+        FontTables() = default;
+        /** The copy indexes the glyphs of its own table */
+        FontTables(const FontTables &fontTables);
+        FontTables &operator=(const FontTables &) = delete;
+
+        /** Index the glyphs of the private use area for a direct access by code point */
+        void IndexGlyphs();
+
+        /** The font name of the font that is currently loaded */
+        std::string m_fontName;
+        /** The loaded SMuFL font */
+        GlyphTable m_fontGlyphTable;
+        /** A text font used for bounding box calculations */
+        GlyphTextMap m_textFont;
+        /** A map of glyph name / code */
+        GlyphNameTable m_glyphNameTable;
+        /** The glyphs of the font glyph table in the private use area, indexed by code point */
+        std::vector<const Glyph *> m_privateUseGlyphs;
+    };
+
+    /** The glyph tables by resource path and font name (empty for the default fonts) */
+    using FontTablesRegistry = std::map<std::pair<std::string, std::string>, std::shared_ptr<const FontTables>>;
+
+    /**
+     * Loading the fonts into the glyph tables
+     */
+    ///@{
+    bool LoadDefaultFonts(FontTables &fontTables) const;
+    bool LoadFont(FontTables &fontTables, const std::string &fontName, bool withFallback = true) const;
+    bool LoadTextFont(FontTables &fontTables, const std::string &fontName, const StyleAttributes &style) const;
+
+#ifdef VRV_EMBED_RESOURCES
+    /**
+     * Load the fonts from the tables compiled into the library (see embeddedresources.h)
+     */
+    ///@{
+    bool LoadEmbeddedFont(FontTables &fontTables, const EmbeddedFont &embeddedFont, bool withFallback) const;
+    bool LoadEmbeddedTextFont(
+        FontTables &fontTables, const EmbeddedFont &embeddedFont, const StyleAttributes &style) const;
+    ///@}
+#endif
+    ///@}
 
 private:
-    /** The font name of the font that is currently loaded */
-    std::string m_fontName;
     /** The path to the resources directory (e.g., for the svg/ subdirectory with fonts as XML */
     std::string m_path;
-    /** The loaded SMuFL font */
-    GlyphTable m_fontGlyphTable;
-    /** A text font used for bounding box calculations */
-    GlyphTextMap m_textFont;
+    /** The glyph tables currently used, possibly shared with other instances */
+    std::shared_ptr<const FontTables> m_fontTables;
+    /** The glyph tables of the default fonts (NULL if they were not loaded successfully) */
+    std::shared_ptr<const FontTables> m_defaultFontTables;
     mutable StyleAttributes m_currentStyle;
-    /**
-     * A map of glyph name / code
-     */
-    GlyphNameTable m_glyphNameTable;
 
     //----------------//
     // Static members //
@@ -124,6 +187,85 @@ private:
 
     /** The default font style */
     static const StyleAttributes k_defaultStyle;
+
+    /** The glyph tables loaded so far, shared by all the instances */
+    static FontTablesRegistry s_fontTablesRegistry;
+    static std::mutex s_fontTablesRegistryMutex;
+};
+
+//----------------------------------------------------------------------------
+// GlyphMetricsCache
+//----------------------------------------------------------------------------
+
+/**
+ * This class caches the metrics of the SMuFL glyphs scaled to the music font size of a document.
+ * The metrics are stored in a dense table per staff size and grace size and computed on demand.
+ * The tables are cleared when the font size or the grace factor change, and have to be reset when the font changes.
+ */
+class GlyphMetricsCache {
+public:
+    /**
+     * The scaled bounding box and horizontal advance of a glyph
+     */
+    struct Metrics {
+        bool m_isSet = false;
+        int m_x = 0;
+        int m_y = 0;
+        int m_width = 0;
+        int m_height = 0;
+        int m_advX = 0;
+    };
+
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    GlyphMetricsCache();
+    virtual ~GlyphMetricsCache() = default;
+    ///@}
+
+    /**
+     * Clear the tables
+     */
+    void Reset();
+
+    /**
+     * Set the music font size and the grace factor, clearing the tables if they changed
+     */
+    void SetScaling(int fontSize, double graceFactor);
+
+    /**
+     * Return the metrics of a glyph of the current font for a staff size and grace size.
+     * Glyphs outside the private use area are not cached.
+     */
+    const Metrics &GetMetrics(const Resources &resources, char32_t code, int staffSize, bool graceSize);
+
+private:
+    /**
+     * Scale the metrics of the glyph as done by the Doc::GetGlyph* methods
+     */
+    void CalcMetrics(const Glyph *glyph, int staffSize, bool graceSize, Metrics &metrics) const;
+
+public:
+    //
+private:
+    /**
+     * A table of metrics for a staff size and grace size, indexed by code point in the private use area
+     */
+    struct Table {
+        int m_staffSize;
+        bool m_graceSize;
+        std::vector<Metrics> m_metrics;
+    };
+
+    /** The tables and the index of the last one used */
+    std::vector<Table> m_tables;
+    int m_lastTable;
+    /** The music font size and grace factor of the tables */
+    int m_fontSize;
+    double m_graceFactor;
+    /** The metrics of the last glyph outside the private use area */
+    Metrics m_uncachedMetrics;
 };
 
 } // namespace vrv
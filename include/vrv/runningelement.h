@@ -131,6 +131,66 @@ private:
     bool m_isGenerated;
 };
 
+//----------------------------------------------------------------------------
+// RunningElementLayout
+//----------------------------------------------------------------------------
+
+/**
+ * This class stores the layout of a running element for a page, i.e., the drawing positions and the bounding boxes
+ * of the running element and of its content. Since the running elements are shared by the pages, the layout of a page
+ * has to be restored when the page is drawn after another one has been laid out (see Page::ResetRunningElements).
+ */
+class RunningElementLayout {
+public:
+    /**
+     * @name Constructors, destructors, reset methods
+     */
+    ///@{
+    RunningElementLayout();
+    virtual ~RunningElementLayout() = default;
+    void Reset();
+    ///@}
+
+    /**
+     * Store the layout of the running element
+     */
+    void Store(const RunningElement *runningElement);
+
+    /**
+     * Restore the layout stored for the running element.
+     * Nothing is done if none was stored for it or if its content has changed since.
+     */
+    void Restore(RunningElement *runningElement) const;
+
+private:
+    /**
+     * List the objects of the running element in the order of the tree
+     */
+    static void ListObjects(const Object *object, ListOfConstObjects &objects);
+
+public:
+    //
+private:
+    /**
+     * The position and the bounding box values of an object of the running element
+     */
+    struct ObjectLayout {
+        const Object *m_object;
+        int m_drawingXRel;
+        int m_drawingYRel;
+        std::array<int, 8> m_boundingBox;
+    };
+
+    /**
+     * The running element, its y position and the layout of the objects in the order of the tree
+     */
+    ///@{
+    const RunningElement *m_runningElement;
+    int m_drawingYRel;
+    std::vector<ObjectLayout> m_objects;
+    ///@}
+};
+
 } // namespace vrv
 
 #endif
@@ -11,6 +11,7 @@
 #ifndef NO_RUNTIME
 
 #include <chrono>
+#include <cstddef>
 
 //----------------------------------------------------------------------------
 
@@ -38,6 +39,9 @@ public:
     /** Get current runtime in seconds */
     double GetSeconds() const;
 
+    /** Get the peak memory usage (resident set size) of the process in bytes, or 0 if not available */
+    static size_t GetPeakMemory();
+
 private:
     //
 public:
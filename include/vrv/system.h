@@ -10,6 +10,7 @@
 
 #include "drawinginterface.h"
 #include "editorial.h"
+#include "layerelementindex.h"
 #include "object.h"
 #include "verticalaligner.h"
 #include "vrvdef.h"
@@ -122,6 +123,13 @@ public:
     curvature_CURVEDIR GetPreferredCurveDirection(
         const LayerElement *start, const LayerElement *end, const Slur *slur) const;
 
+    /**
+     * Return the layer element index of the system, built from the current bounding boxes if necessary.
+     * The index is reset each time the system is drawn and when the aligners are reset.
+     */
+    const LayerElementIndex &GetLayerElementIndex() const;
+    void ResetLayerElementIndex() { m_layerElementIndex.Reset(); }
+
     /**
      * @name Setter and getter of the drawing visible flag
      */
@@ -243,6 +251,11 @@ private:
      * This does not mean that a staff is hidden, but only that it can be optimized.
      */
     bool m_drawingIsOptimized;
+
+    /**
+     * The spatial index of the layer elements, built on demand for the spanned element searches
+     */
+    mutable LayerElementIndex m_layerElementIndex;
 };
 
 } // namespace vrv
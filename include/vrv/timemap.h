@@ -11,12 +11,17 @@
 #include <cassert>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 //----------------------------------------------------------------------------
 
+#include "vrvdef.h"
+
 namespace vrv {
 
+class Doc;
+class Measure;
 class Object;
 
 //----------------------------------------------------------------------------
@@ -66,6 +71,20 @@ public:
      */
     void ToJson(std::string &output, bool includetRests, bool includetMeasures);
 
+    /**
+     * Write the current timemap to a compact binary buffer with one column per field.
+     * All values are little-endian and each column starts at a multiple of its value size:
+     * - a header of eight uint32: the "VRVT" magic, the version (1), the number of entries and of ids, and the
+     *   total number of ids in the on, off, restsOn and restsOff columns;
+     * - the float64 columns tstamp, qstamp and tempo (the current tempo at each entry, 0.0 if none yet);
+     * - the int32 column measureOn with the index of the measure id (-1 if none);
+     * - for each of on, off, restsOn and restsOff, the uint32 start of each entry (number of entries + 1)
+     *   followed by the uint32 indices of the ids;
+     * - the id table, with the uint32 start of each id (number of ids + 1) in the UTF-8 data that follows.
+     * The ids are listed once in the table in the order of their first occurrence.
+     */
+    void ToBinary(std::vector<unsigned char> &output, bool includeRests, bool includeMeasures);
+
 private:
     //
 public:
@@ -76,6 +95,107 @@ private:
 
 }; // class Timemap
 
+//----------------------------------------------------------------------------
+// TimemapIndex
+//----------------------------------------------------------------------------
+
+/**
+ * This class holds an index of the measures and of the notes and rests of a document by real time.
+ * It is built from the real times calculated by Doc::CalculateTimemap and answers time queries with binary searches.
+ * It keeps pointers to the objects and has to be reset when the tree of the document changes.
+ */
+class TimemapIndex {
+public:
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    TimemapIndex();
+    virtual ~TimemapIndex();
+    ///@}
+
+    /** Resets the index */
+    void Reset();
+
+    /**
+     * Build the index from the measures of the document
+     */
+    void Build(const Doc *doc);
+
+    /**
+     * Check if the index has been built since the last reset
+     */
+    bool IsBuilt() const { return m_isBuilt; }
+
+    /**
+     * Return the first measure (in the document order) being played at the given time in milliseconds.
+     * The repeat (1-based) is set to the first one enclosing the time, as with Measure::EnclosesTime.
+     * Return NULL if no measure is played at that time.
+     */
+    const Measure *GetMeasureAtTime(int time, int &repeat) const;
+
+    /**
+     * Fill the vector with the measures and the repeats played between the start and the end times (inclusive).
+     * The measures are in the document order and then in the order of the repeats.
+     */
+    void GetMeasuresInTimeRange(int startTime, int endTime, std::vector<std::pair<const Measure *, int>> &measures) const;
+
+    /**
+     * Fill the list with the notes and rests of the measure played between the start and the end times (inclusive).
+     * The times are relative to the measure offset and the notes and rests are in the document order.
+     */
+    void GetNotesOrRestsInTimeRange(
+        const Measure *measure, int startTime, int endTime, ListOfConstObjects &notesOrRests) const;
+
+private:
+    /**
+     * This class holds intervals sorted by onset with the maximum offset of all the preceding ones.
+     * The value of each interval is its position in the order in which they were added.
+     */
+    class IntervalList {
+    public:
+        void Clear();
+        void Add(double onset, double offset);
+        void Sort();
+        /**
+         * Fill the values of the intervals overlapping [start, end] in the order in which they were added
+         */
+        void FindValues(double start, double end, std::vector<int> &values) const;
+
+    private:
+        struct Interval {
+            double m_onset;
+            double m_offset;
+            int m_value;
+        };
+        std::vector<Interval> m_intervals;
+        std::vector<double> m_maxOffsets;
+    };
+
+    /**
+     * The notes and rests of a measure in the document order and their intervals
+     */
+    struct MeasureEntry {
+        const Measure *m_measure;
+        std::vector<const Object *> m_notesOrRests;
+        IntervalList m_intervals;
+    };
+
+public:
+    //
+private:
+    /** A flag indicating that the index is built */
+    bool m_isBuilt;
+    /** The measures in the document order */
+    std::vector<MeasureEntry> m_measures;
+    /** The position of each measure in m_measures */
+    std::unordered_map<const Measure *, int> m_measurePositions;
+    /** The (measure, repeat) pairs in the document order and their intervals */
+    std::vector<std::pair<int, int>> m_measureRepeats;
+    IntervalList m_measureRepeatIntervals;
+
+}; // class TimemapIndex
+
 } // namespace vrv
 
 #endif // __VRV_TIMEMAP_H__
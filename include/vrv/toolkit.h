@@ -9,6 +9,7 @@
 #define __VRV_TOOLKIT_H__
 
 #include <string>
+#include <vector>
 
 //----------------------------------------------------------------------------
 
@@ -16,12 +17,14 @@
 #include "docselection.h"
 #include "toolkitdef.h"
 #include "view.h"
+#include "vrv.h"
 
 //----------------------------------------------------------------------------
 
 namespace vrv {
 
 class EditorToolkit;
+class Input;
 class RuntimeClock;
 
 /**
@@ -92,6 +95,10 @@ public:
     /**
      * Get the log content for the latest operation.
      *
+     * Each toolkit has its own log, which is reset by most of the methods and keeps the latest 1000 messages.
+     * The messages are logged in the log of the toolkit whose method was last called in the thread, so a
+     * toolkit needs to be used in a single thread at a time.
+     *
      * @return The log content as a string
      */
     std::string GetLog();
@@ -144,6 +151,19 @@ public:
      */
     bool LoadData(const std::string &data);
 
+    /**
+     * Load a string data taking the ownership of it.
+     *
+     * MEI data is parsed in place without being copied, which reduces the memory needed for large files.
+     * The string is released once loaded.
+     *
+     * @remark nojs
+     *
+     * @param data A string with the data (e.g., MEI data) to be loaded
+     * @return True if the data was successfully loaded
+     */
+    bool LoadData(std::string &&data);
+
     /**
      * Load a MusicXML compressed file passed as base64 encoded string.
      *
@@ -190,11 +210,45 @@ public:
      * Return the number of pages in the loaded document.
      *
      * The number of pages depends one the page size and if encoded layout was taken into account or not.
+     * With the progressive layout, all the pages still pending are cast off for counting them. For rendering the
+     * first pages without waiting for the cast-off of the whole document, use GetCastOffPageCount and
+     * IsCastOffComplete instead.
      *
      * @return The number of pages
      */
     int GetPageCount();
 
+    /**
+     * Return the number of pages cast off so far.
+     *
+     * With the progressive layout, this is the number of pages that can be rendered without
+     * casting off more pages. Otherwise, it is the same as the page count.
+     *
+     * @return The number of pages cast off
+     */
+    int GetCastOffPageCount();
+
+    /**
+     * Return true if all the pages of the document are cast off.
+     *
+     * This is always the case without the progressive layout. With it, the page count is final only once the
+     * cast-off is complete.
+     *
+     * @return True if no page is pending
+     */
+    bool IsCastOffComplete();
+
+    /**
+     * Cast off the pages of the document up to a page with the progressive layout.
+     *
+     * This can be called in the background for casting off the pages following the one rendered.
+     * Other methods cast off the pages they need, and all of them for getting the page count.
+     *
+     * @param pageCount The number of pages to be cast off (all of them with 0)
+     * @return True if all the pages are cast off
+     */
+    bool CastOffPages(int pageCount);
+
     ///@}
 
     /**
@@ -368,6 +422,21 @@ public:
      */
     bool RenderToSVGFile(const std::string &filename, int pageNo = 1);
 
+    /**
+     * Render all the pages of the loaded document to SVG using several threads.
+     *
+     * The pages are laid out one after the other, because the layout changes the document, and are then drawn by the
+     * threads. The threads share the document, each with its own view and drawing context (the drawing page and the
+     * values depending on it). The output is the same as rendering the pages one by one with RenderToSVG.
+     *
+     * @remark nojs
+     *
+     * @param threads The number of threads (0 for the number of hardware threads)
+     * @param xmlDeclaration True for including the xml declaration in the SVG output
+     * @return A vector with the SVG of each page
+     */
+    std::vector<std::string> RenderAllToSVG(int threads = 0, bool xmlDeclaration = false);
+
     /**
      * Render the document to MIDI.
      *
@@ -414,6 +483,16 @@ public:
      */
     std::string RenderToTimemap(const std::string &jsonOptions = "");
 
+    /**
+     * Render a document to a binary timemap with one column per field and a table of the ids.
+     *
+     * The binary timemap is smaller and faster to read than the JSON timemap. See Timemap::ToBinary for the format.
+     *
+     * @param jsonOptions A stringified JSON objects with the timemap options
+     * @return The binary timemap
+     */
+    std::vector<unsigned char> RenderToBinaryTimemap(const std::string &jsonOptions = "");
+
     /**
      * Render a document's expansionMap, if existing
      *
@@ -545,6 +624,17 @@ public:
      */
     std::string GetElementsAtTime(int millisec);
 
+    /**
+     * Return arrays of IDs of elements being played within a time range.
+     *
+     * Elements played in several repeats within the range are listed only once.
+     *
+     * @param startMillisec The start time in milliseconds
+     * @param endMillisec The end time in milliseconds (inclusive)
+     * @return A stringified JSON object with the pages, measures and notes being played
+     */
+    std::string GetElementsInTimeRange(int startMillisec, int endMillisec);
+
     /**
      * Return the page on which the element is the ID (\@xml:id) is rendered
      *
@@ -625,8 +715,13 @@ public:
      * This can be called once the rendering option were changed, for example with a new page (sceen) height or a new
      * zoom level.
      *
+     * With the incremental option, only the pages with elements changed by editor actions are laid out again,
+     * unless their system or page breaks change. The whole document is laid out again when no change was recorded,
+     * which is the case with the neume editor actions. It must not be used when the options were changed.
+     *
      * @param jsonOptions A stringified JSON object with the action options
      * resetCache: true or false; true by default;
+     * incremental: true or false; false by default;
      */
     void RedoLayout(const std::string &jsonOptions = "");
 
@@ -667,6 +762,13 @@ public:
      */
     Options *GetOptionsObj() { return m_options; }
 
+    /**
+     * Return the Doc object of the Toolkit instance.
+     *
+     * @ingroup nodoc
+     */
+    Doc *GetDoc() { return &m_doc; }
+
     /**
      * Copy the data to the cstring internal buffer.
      *
@@ -683,6 +785,15 @@ public:
      */
     const char *GetCString();
 
+    /**
+     * Copy the binary data to the internal buffer and return it.
+     *
+     * The buffer remains valid until the next call.
+     *
+     * @ingroup nodoc
+     */
+    const std::vector<unsigned char> &SetCBuffer(std::vector<unsigned char> &&data);
+
     /**
      * Write the Humdrum buffer to the outputstream.
      *
@@ -757,7 +868,7 @@ protected:
     void PrintOptionUsageOutput(const vrv::Option *option, std::ostream &output) const;
 
     /**
-     * Resets the vrv::logBuffer.
+     * Resets the log of the toolkit and makes it the log buffer of the thread.
      */
     void ResetLogBuffer();
 
@@ -770,6 +881,49 @@ private:
     bool LoadZipData(const std::vector<unsigned char> &bytes);
     void GetClassIds(const std::vector<std::string> &classStrings, std::vector<ClassId> &classIds);
 
+    /**
+     * @name Methods shared by the loading of a string and of a buffer parsed in place
+     */
+    ///@{
+    /** Check if the data will be parsed in place, which is currently only the case for MEI */
+    bool IsInPlaceInput(const char *data, size_t size);
+    void InitLoading(const char *data, size_t size);
+    bool LoadDataInPlace(char *data, size_t size);
+    /** Prepare and lay out the document imported by the input, which is deleted */
+    bool FinishLoading(Input *input);
+    ///@}
+
+    /**
+     * Import Humdrum data converted from another input format (MusicXML, MEI, MuseData or EsAC).
+     * The Humdrum data is imported directly into the document. It is converted to MEI and loaded with MEIInput
+     * when options applied only by MEIInput are set (e.g., XPath queries, --mdiv-all, --incip or
+     * --preserve-analytical-markup). Return the input used, or NULL if the import failed.
+     */
+    Input *ImportHumdrumConversion(const std::string &humdrum);
+
+    /**
+     * Cast off and lay out the page for drawing it with the view of the toolkit.
+     * Page number is 1-based. Return false if the page does not exist.
+     */
+    bool LayOutPage(int pageNo);
+
+    /**
+     * Draw the page of the view to the deviceContext, with the size of the deviceContext set according to the options.
+     * The page has to be laid out.
+     */
+    void DrawPage(View &view, DeviceContext *deviceContext);
+
+    /**
+     * Draw the page of the view to SVG, or return an empty SVG if the view is NULL.
+     * The xml:ids of the drawing are generated from drawingIDState (see Object::IDScope).
+     */
+    std::string DrawPageToSVG(View *view, const Resources *resources, uint32_t drawingIDState, bool xmlDeclaration);
+
+    /**
+     * Read the includeRests and includeMeasures timemap options from a stringified JSON object
+     */
+    void ReadTimemapOptions(const std::string &jsonOptions, bool &includeRests, bool &includeMeasures) const;
+
     /**
      * Return a dictionary of all the options
      *
@@ -794,18 +948,27 @@ private:
      */
     char *m_cString;
 
+    /**
+     * The C buffer for binary data.
+     */
+    std::vector<unsigned char> m_cBuffer;
+
+    /**
+     * The Humdrum buffer string, owned by the toolkit.
+     */
+    char *m_humdrumBuffer;
+
     EditorToolkit *m_editorToolkit;
 
+    /**
+     * The log of the toolkit.
+     */
+    LogBuffer m_logBuffer;
+
 #ifndef NO_RUNTIME
     /** Measuring runtime */
     RuntimeClock *m_runtimeClock;
 #endif
-
-    //----------------//
-    // Static members //
-    //----------------//
-
-    static char *m_humdrumBuffer;
 };
 
 } // namespace vrv
@@ -11,6 +11,7 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -40,10 +41,30 @@ void LogInfo(const char *fmt, ...);
 void LogWarning(const char *fmt, ...);
 
 /**
- * Member and functions specific to logging that uses a vector of string to buffer the logs.
+ * A buffer of log messages without duplicates, bounded to the most recent ones.
+ * Once the capacity is reached, the oldest message is removed for each new one.
  */
-extern std::vector<std::string> logBuffer;
-bool LogBufferContains(const std::string &s);
+class LogBuffer {
+public:
+    LogBuffer(int capacity = 1000) { m_capacity = capacity; }
+
+    void Add(const std::string &message);
+    bool Contains(const std::string &message) const;
+    void Clear() { m_messages.clear(); }
+    const std::deque<std::string> &GetMessages() const { return m_messages; }
+
+private:
+    std::deque<std::string> m_messages;
+    int m_capacity;
+};
+
+/**
+ * Functions specific to logging in a buffer.
+ * Each thread logs in its current buffer, which is set by the toolkit being called (see Toolkit::GetLog).
+ * Setting NULL restores the buffer of the thread used when no toolkit has set one.
+ */
+LogBuffer *GetLogBuffer();
+void SetLogBuffer(LogBuffer *buffer);
 void LogString(std::string message, LogLevel level);
 
 /**
@@ -127,10 +148,11 @@ std::string FromCamelCase(const std::string &s);
 std::string ToCamelCase(const std::string &s);
 
 /**
- *
+ * The log level and the logging mode of the current thread.
+ * They are initialized with the values last given to EnableLog and EnableLogToBuffer.
  */
-extern LogLevel logLevel;
-extern bool loggingToBuffer;
+extern thread_local LogLevel logLevel;
+extern thread_local bool loggingToBuffer;
 
 /**
  * Functions for logging in milliseconds the elapsed time of an
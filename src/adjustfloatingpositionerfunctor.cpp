@@ -52,6 +52,12 @@ FunctorCode AdjustFloatingPositionersFunctor::VisitStaffAlignment(StaffAlignment
         return FUNCTOR_SIBLINGS;
     }
 
+    // The overflowing boxes above and below sorted by horizontal position, built when first needed
+    BoundingBoxIntervals intervalsAbove;
+    BoundingBoxIntervals intervalsBelow;
+    bool intervalsAboveBuilt = false;
+    bool intervalsBelowBuilt = false;
+
     for (FloatingPositioner *positioner : staffAlignment->GetFloatingPositioners()) {
         assert(positioner->GetObject());
         if (!m_inBetween && !positioner->GetObject()->Is(m_classId)) continue;
@@ -119,11 +125,22 @@ FunctorCode AdjustFloatingPositionersFunctor::VisitStaffAlignment(StaffAlignment
             if (m_classId == HAIRPIN) continue;
         }
 
+        BoundingBoxIntervals &intervals = (place == STAFFREL_above) ? intervalsAbove : intervalsBelow;
+        bool &intervalsBuilt = (place == STAFFREL_above) ? intervalsAboveBuilt : intervalsBelowBuilt;
+        if (!intervalsBuilt) {
+            for (BoundingBox *bbox : overflowBoxes) this->AddToIntervals(intervals, bbox);
+            intervalsBuilt = true;
+        }
+
         // Find all the overflowing elements from the staff that overlap horizontally
-        for (auto i = overflowBoxes.begin(); i != overflowBoxes.end(); ++i) {
-            if (positioner->HasHorizontalOverlapWith(*i, drawingUnit)) {
+        // The candidates are the boxes within the largest admissible margin, in the order of the overflowing boxes
+        const int maxMargin = 8 * drawingUnit;
+        const ArrayOfBoundingBoxes candidates = intervals.FindOverlaps(positioner->GetContentLeft() - maxMargin,
+            positioner->GetContentRight() + positioner->GetDrawingExtenderWidth() + maxMargin);
+        for (BoundingBox *bbox : candidates) {
+            if (positioner->HasHorizontalOverlapWith(bbox, drawingUnit)) {
                 // update the yRel accordingly
-                positioner->CalcDrawingYRel(m_doc, staffAlignment, *i);
+                positioner->CalcDrawingYRel(m_doc, staffAlignment, bbox);
             }
         }
 
@@ -143,11 +160,27 @@ FunctorCode AdjustFloatingPositionersFunctor::VisitStaffAlignment(StaffAlignment
             overflowBoxes.push_back(positioner);
             staffAlignment->SetOverflowBelow(overflowBelow);
         }
+        this->AddToIntervals(intervals, positioner);
     }
 
     return FUNCTOR_SIBLINGS;
 }
 
+void AdjustFloatingPositionersFunctor::AddToIntervals(BoundingBoxIntervals &intervals, BoundingBox *bbox) const
+{
+    assert(bbox);
+
+    if (!bbox->HasContentBB()) return;
+
+    // The interval of a floating positioner includes its extender
+    int extenderWidth = 0;
+    const FloatingPositioner *positioner = dynamic_cast<const FloatingPositioner *>(bbox);
+    if (positioner) {
+        extenderWidth = positioner->GetDrawingExtenderWidth();
+    }
+    intervals.Add(bbox, bbox->GetContentLeft(), bbox->GetContentRight() + extenderWidth);
+}
+
 FunctorCode AdjustFloatingPositionersFunctor::VisitSystem(System *system)
 {
     m_inBetween = false;
@@ -428,6 +461,10 @@ FunctorCode AdjustFloatingPositionersBetweenFunctor::VisitStaffAlignment(StaffAl
     dist -= m_previousStaffAlignment->GetStaffHeight();
     int centerYRel = dist / 2 + m_previousStaffAlignment->GetStaffHeight();
 
+    // The overflowing boxes above sorted by horizontal position, built when first needed
+    BoundingBoxIntervals intervalsAbove;
+    bool intervalsAboveBuilt = false;
+
     for (FloatingPositioner *positioner : m_previousStaffAlignment->GetFloatingPositioners()) {
         assert(positioner->GetObject());
         if (!positioner->GetObject()->Is({ DIR, DYNAM, HAIRPIN, TEMPO })) continue;
@@ -439,21 +476,19 @@ FunctorCode AdjustFloatingPositionersBetweenFunctor::VisitStaffAlignment(StaffAl
 
         int diffY = centerYRel - positioner->GetDrawingYRel();
 
-        const ArrayOfBoundingBoxes &overflowBoxes = staffAlignment->GetBBoxesAbove();
-        auto i = overflowBoxes.begin();
-        auto end = overflowBoxes.end();
-        while (i != end) {
+        if (!intervalsAboveBuilt) {
+            intervalsAbove.Add(staffAlignment->GetBBoxesAbove());
+            intervalsAboveBuilt = true;
+        }
 
-            // find all the overflowing elements from the staff that overlap horizontally
-            i = std::find_if(
-                i, end, [positioner](BoundingBox *elem) { return positioner->HorizontalContentOverlap(elem); });
-            if (i != end) {
-                // update the yRel accordingly
-                const int spaceY = positioner->GetSpaceBelow(m_doc, staffAlignment, *i);
-                if (spaceY != VRV_UNSET) {
-                    diffY = std::min(diffY, spaceY);
-                }
-                ++i;
+        // find all the overflowing elements from the staff that overlap horizontally
+        const ArrayOfBoundingBoxes overlappingBoxes
+            = intervalsAbove.FindOverlaps(positioner->GetContentLeft(), positioner->GetContentRight());
+        for (BoundingBox *bbox : overlappingBoxes) {
+            // update the yRel accordingly
+            const int spaceY = positioner->GetSpaceBelow(m_doc, staffAlignment, bbox);
+            if (spaceY != VRV_UNSET) {
+                diffY = std::min(diffY, spaceY);
             }
         }
         positioner->SetDrawingYRel(positioner->GetDrawingYRel() + diffY);
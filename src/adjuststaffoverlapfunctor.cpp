@@ -61,36 +61,49 @@ FunctorCode AdjustStaffOverlapFunctor::VisitStaffAlignment(StaffAlignment *staff
     const int staffSize = staffAlignment->GetStaffSize();
     const int drawingUnit = m_doc->GetDrawingUnit(staffSize);
 
+    // The elements from the bottom staff that have an overflow at the top, sorted by horizontal position
+    BoundingBoxIntervals intervalsAbove;
+    bool intervalsAboveBuilt = false;
+
     // go through all the elements of the top staff that have an overflow below
     for (BoundingBox *bboxBelow : m_previous->GetBBoxesBelow()) {
-        const ArrayOfBoundingBoxes &bboxesAbove = staffAlignment->GetBBoxesAbove();
-        auto iter = bboxesAbove.begin();
-        auto end = bboxesAbove.end();
-        while (iter != end) {
-            // find all the elements from the bottom staff that have an overflow at the top with an horizontal overlap
-            iter = std::find_if(iter, end, [bboxBelow, drawingUnit](BoundingBox *elem) {
-                if (bboxBelow->Is(FLOATING_POSITIONER)) {
-                    FloatingPositioner *fp = vrv_cast<FloatingPositioner *>(bboxBelow);
-                    if (fp->GetObject()->Is({ DIR, DYNAM, TEMPO }) && fp->GetObject()->IsExtenderElement()) {
-                        return bboxBelow->HorizontalContentOverlap(elem, drawingUnit * 4)
-                            || bboxBelow->VerticalContentOverlap(elem);
-                    }
-                }
-                return bboxBelow->HorizontalContentOverlap(elem);
-            });
-            if (iter != end) {
-                // calculate the vertical overlap and see if this is more than the expected space
-                int overflowBelow = m_previous->CalcOverflowBelow(bboxBelow);
-                int overflowAbove = staffAlignment->CalcOverflowAbove(*iter);
-                int minSpaceBetween = 0;
-                if ((bboxBelow->Is(ARTIC) && ((*iter)->Is({ ARTIC, NOTE })))
-                    || (bboxBelow->Is(NOTE) && ((*iter)->Is(ARTIC)))) {
-                    minSpaceBetween = drawingUnit;
-                }
-                if (spacing < (overflowBelow + overflowAbove + minSpaceBetween)) {
-                    staffAlignment->SetOverlap((overflowBelow + overflowAbove + minSpaceBetween) - spacing);
-                }
-                ++iter;
+        if (!bboxBelow->HasContentBB()) continue;
+
+        ArrayOfBoundingBoxes overlappingBoxes;
+        bool isExtender = false;
+        if (bboxBelow->Is(FLOATING_POSITIONER)) {
+            FloatingPositioner *fp = vrv_cast<FloatingPositioner *>(bboxBelow);
+            isExtender = (fp->GetObject()->Is({ DIR, DYNAM, TEMPO }) && fp->GetObject()->IsExtenderElement());
+        }
+        // Extenders also overlap with a vertical overlap and have to be checked against all elements
+        if (isExtender) {
+            const ArrayOfBoundingBoxes &bboxesAbove = staffAlignment->GetBBoxesAbove();
+            std::copy_if(bboxesAbove.begin(), bboxesAbove.end(), std::back_inserter(overlappingBoxes),
+                [bboxBelow, drawingUnit](BoundingBox *elem) {
+                    return bboxBelow->HorizontalContentOverlap(elem, drawingUnit * 4)
+                        || bboxBelow->VerticalContentOverlap(elem);
+                });
+        }
+        // Otherwise find all the elements from the bottom staff with an horizontal overlap
+        else {
+            if (!intervalsAboveBuilt) {
+                intervalsAbove.Add(staffAlignment->GetBBoxesAbove());
+                intervalsAboveBuilt = true;
+            }
+            overlappingBoxes = intervalsAbove.FindOverlaps(bboxBelow->GetContentLeft(), bboxBelow->GetContentRight());
+        }
+
+        for (BoundingBox *bboxAbove : overlappingBoxes) {
+            // calculate the vertical overlap and see if this is more than the expected space
+            int overflowBelow = m_previous->CalcOverflowBelow(bboxBelow);
+            int overflowAbove = staffAlignment->CalcOverflowAbove(bboxAbove);
+            int minSpaceBetween = 0;
+            if ((bboxBelow->Is(ARTIC) && (bboxAbove->Is({ ARTIC, NOTE })))
+                || (bboxBelow->Is(NOTE) && (bboxAbove->Is(ARTIC)))) {
+                minSpaceBetween = drawingUnit;
+            }
+            if (spacing < (overflowBelow + overflowAbove + minSpaceBetween)) {
+                staffAlignment->SetOverlap((overflowBelow + overflowAbove + minSpaceBetween) - spacing);
             }
         }
     }
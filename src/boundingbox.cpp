@@ -139,6 +139,24 @@ void BoundingBox::ResetBoundingBox()
     m_smuflGlyphFontSize = 100;
 }
 
+std::array<int, 8> BoundingBox::GetBoundingBoxValues() const
+{
+    return { m_contentBB_x1, m_contentBB_y1, m_contentBB_x2, m_contentBB_y2, m_selfBB_x1, m_selfBB_y1, m_selfBB_x2,
+        m_selfBB_y2 };
+}
+
+void BoundingBox::SetBoundingBoxValues(const std::array<int, 8> &values)
+{
+    m_contentBB_x1 = values[0];
+    m_contentBB_y1 = values[1];
+    m_contentBB_x2 = values[2];
+    m_contentBB_y2 = values[3];
+    m_selfBB_x1 = values[4];
+    m_selfBB_y1 = values[5];
+    m_selfBB_x2 = values[6];
+    m_selfBB_y2 = values[7];
+}
+
 void BoundingBox::SetEmptyBB()
 {
     m_contentBB_x1 = 0;
@@ -1191,6 +1209,91 @@ int BoundingBox::RectBottomOverlap(const Point rect1[2], const Point rect2[2], i
     return std::max(0, rect2[1].y - rect1[0].y + margin);
 }
 
+//----------------------------------------------------------------------------
+// BoundingBoxIntervals
+//----------------------------------------------------------------------------
+
+BoundingBoxIntervals::BoundingBoxIntervals()
+{
+    this->Reset();
+}
+
+void BoundingBoxIntervals::Reset()
+{
+    m_intervals.clear();
+    m_maxWidth = 0;
+    m_count = 0;
+    m_isSorted = false;
+}
+
+void BoundingBoxIntervals::Add(BoundingBox *box)
+{
+    assert(box);
+
+    if (!box->HasContentBB()) return;
+
+    this->Add(box, box->GetContentLeft(), box->GetContentRight());
+}
+
+void BoundingBoxIntervals::Add(BoundingBox *box, int left, int right)
+{
+    assert(box);
+
+    if (!box->HasContentBB()) return;
+
+    const Interval interval{ left, right, m_count++, box };
+    m_maxWidth = std::max(m_maxWidth, right - left);
+
+    if (!m_isSorted) {
+        m_intervals.push_back(interval);
+        return;
+    }
+
+    // Keep the intervals sorted once they have been queried
+    auto iter = std::upper_bound(m_intervals.begin(), m_intervals.end(), left,
+        [](int pos, const Interval &entry) { return (pos < entry.m_left); });
+    m_intervals.insert(iter, interval);
+}
+
+void BoundingBoxIntervals::Add(const ArrayOfBoundingBoxes &boxes)
+{
+    m_intervals.reserve(m_intervals.size() + boxes.size());
+    for (BoundingBox *box : boxes) {
+        this->Add(box);
+    }
+}
+
+ArrayOfBoundingBoxes BoundingBoxIntervals::FindOverlaps(int left, int right)
+{
+    if (!m_isSorted) this->Sort();
+
+    std::vector<std::pair<int, BoundingBox *>> found;
+    // An interval overlapping left cannot start before left - m_maxWidth
+    auto iter = std::upper_bound(m_intervals.begin(), m_intervals.end(), left - m_maxWidth,
+        [](int pos, const Interval &entry) { return (pos < entry.m_left); });
+    for (; (iter != m_intervals.end()) && (iter->m_left < right); ++iter) {
+        if (iter->m_right <= left) continue;
+        found.push_back({ iter->m_order, iter->m_box });
+    }
+
+    // Return the boxes in the order they were added
+    std::sort(found.begin(), found.end());
+
+    ArrayOfBoundingBoxes boxes;
+    boxes.reserve(found.size());
+    for (const auto &entry : found) {
+        boxes.push_back(entry.second);
+    }
+    return boxes;
+}
+
+void BoundingBoxIntervals::Sort()
+{
+    std::stable_sort(m_intervals.begin(), m_intervals.end(),
+        [](const Interval &entry1, const Interval &entry2) { return (entry1.m_left < entry2.m_left); });
+    m_isSorted = true;
+}
+
 //----------------------------------------------------------------------------
 // SegmentedLine
 //----------------------------------------------------------------------------
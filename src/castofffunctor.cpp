@@ -366,11 +366,13 @@ FunctorCode CastOffPagesFunctor::VisitSystem(System *system)
             return FUNCTOR_SIBLINGS;
         }
 
+        Page *previousPage = m_currentPage;
         m_currentPage = new Page();
         // Use VRV_UNSET value as a flag
         m_pgHeadHeight = VRV_UNSET;
         assert(m_doc->GetPages());
-        m_doc->GetPages()->AddChild(m_currentPage);
+        // Insert it after the previous one since the pending page of a progressive layout is kept last
+        m_doc->GetPages()->InsertChild(m_currentPage, previousPage->GetIdx() + 1);
         m_shift = system->GetDrawingYRel() - m_pageHeight;
     }
 
@@ -81,7 +81,7 @@ int Div::GetTotalHeight(const Doc *doc) const
 int Div::GetTotalWidth(const Doc *doc) const
 {
     if (!m_drawingInline) {
-        return (doc->m_drawingPageContentWidth);
+        return (doc->GetDrawingContext().m_drawingPageContentWidth);
     }
     else {
         int width = this->GetContentWidth();
@@ -10,6 +10,7 @@
 //----------------------------------------------------------------------------
 
 #include <cassert>
+#include <list>
 #include <math.h>
 
 //----------------------------------------------------------------------------
@@ -51,6 +52,7 @@
 #include "preparedatafunctor.h"
 #include "resetfunctor.h"
 #include "runningelement.h"
+#include "runtimeclock.h"
 #include "score.h"
 #include "setscoredeffunctor.h"
 #include "slur.h"
@@ -78,10 +80,40 @@
 
 namespace vrv {
 
+//----------------------------------------------------------------------------
+// DrawingContext
+//----------------------------------------------------------------------------
+
+DrawingContext::DrawingContext()
+{
+    this->Reset();
+}
+
+void DrawingContext::Reset()
+{
+    m_drawingPage = NULL;
+    m_drawingPageHeight = -1;
+    m_drawingPageWidth = -1;
+    m_drawingPageContentHeight = -1;
+    m_drawingPageContentWidth = -1;
+    m_drawingPageMarginBottom = 0;
+    m_drawingPageMarginRight = 0;
+    m_drawingPageMarginLeft = 0;
+    m_drawingPageMarginTop = 0;
+
+    m_drawingSmuflFontSize = 0;
+    m_drawingLyricFontSize = 0;
+
+    m_sharedDrawingMutex = NULL;
+}
+
 //----------------------------------------------------------------------------
 // Doc
 //----------------------------------------------------------------------------
 
+thread_local const Doc *Doc::s_drawingContextDoc = NULL;
+thread_local DrawingContext *Doc::s_drawingContext = NULL;
+
 Doc::Doc() : Object(DOC, "doc-")
 {
     m_options = new Options();
@@ -90,21 +122,41 @@ Doc::Doc() : Object(DOC, "doc-")
     m_selectionPreceding = NULL;
     m_selectionFollowing = NULL;
 
+    m_idIndexIsValid = false;
+    m_idIndexIsBuilding = false;
+    m_idIndexHasDuplicates = false;
+
+    m_castOffPendingPage = NULL;
+    m_castOffPages = NULL;
+
+    m_objectArena = NULL;
+
     this->Reset();
 }
 
 Doc::~Doc()
 {
+    // Delete the children here while the index members are still alive since they are used when detaching them
+    this->InvalidateIDIndex();
+    this->ClearChildren();
+
     this->ClearSelectionPages();
+    this->ResetPendingPages();
 
     delete m_options;
+
+    // Objects still alive (e.g., the children of the Doc members) keep the arena until they are deleted
+    this->EnableObjectArena(false);
 }
 
 void Doc::Reset()
 {
+    this->InvalidateIDIndex();
+
     Object::Reset();
 
     this->ClearSelectionPages();
+    this->ResetPendingPages();
 
     m_type = Raw;
     m_notationType = NOTATIONTYPE_NONE;
@@ -115,28 +167,20 @@ void Doc::Reset()
     m_pageMarginLeft = 0;
     m_pageMarginTop = 0;
 
-    m_drawingPageHeight = -1;
-    m_drawingPageWidth = -1;
-    m_drawingPageContentHeight = -1;
-    m_drawingPageContentWidth = -1;
-    m_drawingPageMarginBottom = 0;
-    m_drawingPageMarginRight = 0;
-    m_drawingPageMarginLeft = 0;
-    m_drawingPageMarginTop = 0;
-
-    m_drawingPage = NULL;
+    m_drawingContext.Reset();
     m_currentScore = NULL;
     m_currentScoreDefDone = false;
     m_dataPreparationDone = false;
     m_timemapTempo = 0.0;
+    m_timemapIndex.Reset();
     m_markup = MARKUP_DEFAULT;
     m_isMensuralMusicOnly = false;
     m_isCastOff = false;
 
-    m_facsimile = NULL;
+    this->ResetLayoutDamage();
+    m_layoutDamagedCache = false;
 
-    m_drawingSmuflFontSize = 0;
-    m_drawingLyricFontSize = 0;
+    m_facsimile = NULL;
 
     m_header.reset();
     m_front.reset();
@@ -333,9 +377,10 @@ void Doc::CalculateTimemap()
     }
 
     m_timemapTempo = 0.0;
+    m_timemapIndex.Reset();
 
     // This happens if the document was never cast off (breaks none option in the toolkit)
-    if (!m_drawingPage) {
+    if (!this->GetDrawingPage()) {
         Page *page = this->SetDrawingPage(0);
         assert(page);
         this->ScoreDefSetCurrentDoc();
@@ -370,6 +415,23 @@ void Doc::CalculateTimemap()
     m_timemapTempo = m_options->m_midiTempoAdjustment.GetValue();
 }
 
+const TimemapIndex &Doc::GetTimemapIndex()
+{
+    if (!this->HasTimemap()) {
+        // generate MIDI timemap before progressing
+        this->CalculateTimemap();
+    }
+    if (this->HasTimemap() && !m_timemapIndex.IsBuilt()) {
+        m_timemapIndex.Build(this);
+    }
+    return m_timemapIndex;
+}
+
+void Doc::ResetTimemapIndex()
+{
+    if (m_timemapIndex.IsBuilt()) m_timemapIndex.Reset();
+}
+
 void Doc::ExportMIDI(smf::MidiFile *midiFile)
 {
 
@@ -411,22 +473,38 @@ void Doc::ExportMIDI(smf::MidiFile *midiFile)
     IntTree_t::const_iterator staves;
     IntTree_t::const_iterator layers;
 
+    // Each staff and each layer writes its events to its own buffer, merged in the same order at the end
+    // Lists are used since the functors and the filters keep pointers to the buffers and to the comparisons
+    std::list<smf::MidiFile> midiBuffers;
+    std::list<AttNIntegerComparison> comparisons;
+    std::list<Filters> layerFilters;
+    std::list<GenerateMIDIFunctor> layerFunctors;
+    auto addMIDIBuffer = [&midiBuffers, midiFile](int track) -> smf::MidiFile * {
+        smf::MidiFile &midiBuffer = midiBuffers.emplace_back();
+        midiBuffer.absoluteTicks();
+        midiBuffer.setTPQ(midiFile->getTPQ());
+        if (track > 0) midiBuffer.addTracks(track);
+        return &midiBuffer;
+    };
+
+    // All layers are processed together in a single traversal
+    ConstCompositeFunctor generateMIDILayers;
+
     // Process notes and chords, rests, spaces layer by layer
     // track 0 (included by default) is reserved for meta messages common to all tracks
     int midiChannel = 0;
     int midiTrack = 1;
-    Filters filters;
     for (staves = layerTree.child.begin(); staves != layerTree.child.end(); ++staves) {
 
+        // The current scoreDef is the one of the last score, as set by the traversals above and the one read by all
+        // the staves also when the layers were processed one traversal at a time
         ScoreDef *currentScoreDef = this->GetCurrentScoreDef();
         int transSemi = 0;
+        smf::MidiFile *staffBuffer = NULL;
         if (StaffDef *staffDef = currentScoreDef->GetStaffDef(staves->first)) {
             // get the transposition (semi-tone) value for the staff
             if (staffDef->HasTransSemi()) transSemi = staffDef->GetTransSemi();
             midiTrack = staffDef->GetN();
-            if (midiFile->getTrackCount() < (midiTrack + 1)) {
-                midiFile->addTracks(midiTrack + 1 - midiFile->getTrackCount());
-            }
             // set MIDI channel and instrument
             InstrDef *instrdef = vrv_cast<InstrDef *>(staffDef->FindDescendantByType(INSTRDEF, 1));
             if (!instrdef) {
@@ -438,16 +516,14 @@ void Doc::ExportMIDI(smf::MidiFile *midiFile)
                 if (instrdef->HasMidiChannel()) midiChannel = instrdef->GetMidiChannel();
                 if (instrdef->HasMidiTrack()) {
                     midiTrack = instrdef->GetMidiTrack();
-                    if (midiFile->getTrackCount() < (midiTrack + 1)) {
-                        midiFile->addTracks(midiTrack + 1 - midiFile->getTrackCount());
-                    }
                     if (midiTrack > 255) {
                         LogWarning("A high MIDI track number was assigned to staff %d", staffDef->GetN());
                     }
                 }
-                if (instrdef->HasMidiInstrnum()) {
-                    midiFile->addPatchChange(midiTrack, 0, midiChannel, instrdef->GetMidiInstrnum());
-                }
+            }
+            staffBuffer = addMIDIBuffer(std::max(staffDef->GetN(), midiTrack));
+            if (instrdef && instrdef->HasMidiInstrnum()) {
+                staffBuffer->addPatchChange(midiTrack, 0, midiChannel, instrdef->GetMidiInstrnum());
             }
             // set MIDI track name
             Label *label = vrv_cast<Label *>(staffDef->FindDescendantByType(LABEL, 1));
@@ -458,7 +534,7 @@ void Doc::ExportMIDI(smf::MidiFile *midiFile)
             }
             if (label) {
                 std::string trackName = UTF32to8(label->GetText()).c_str();
-                if (!trackName.empty()) midiFile->addTrackName(midiTrack, 0, trackName);
+                if (!trackName.empty()) staffBuffer->addTrackName(midiTrack, 0, trackName);
             }
             // set MIDI key signature
             KeySig *keySig = vrv_cast<KeySig *>(staffDef->FindDescendantByType(KEYSIG));
@@ -466,7 +542,7 @@ void Doc::ExportMIDI(smf::MidiFile *midiFile)
                 keySig = vrv_cast<KeySig *>(currentScoreDef->GetKeySig());
             }
             if (keySig && keySig->HasSig()) {
-                midiFile->addKeySignature(midiTrack, 0, keySig->GetFifthsInt(), (keySig->GetMode() == MODE_minor));
+                staffBuffer->addKeySignature(midiTrack, 0, keySig->GetFifthsInt(), (keySig->GetMode() == MODE_minor));
             }
             // set MIDI time signature
             MeterSig *meterSig = vrv_cast<MeterSig *>(staffDef->FindDescendantByType(METERSIG));
@@ -474,25 +550,26 @@ void Doc::ExportMIDI(smf::MidiFile *midiFile)
                 meterSig = vrv_cast<MeterSig *>(currentScoreDef->GetMeterSig());
             }
             if (meterSig && meterSig->HasCount() && meterSig->HasUnit()) {
-                midiFile->addTimeSignature(midiTrack, 0, meterSig->GetTotalCount(), meterSig->GetUnit());
+                staffBuffer->addTimeSignature(midiTrack, 0, meterSig->GetTotalCount(), meterSig->GetUnit());
             }
         }
+        else {
+            staffBuffer = addMIDIBuffer(midiTrack);
+        }
 
         // Set initial scoreDef values for tuning
-        GenerateMIDIFunctor generateScoreDefMIDI(midiFile);
+        GenerateMIDIFunctor generateScoreDefMIDI(staffBuffer);
         generateScoreDefMIDI.SetChannel(midiChannel);
         generateScoreDefMIDI.SetTrack(midiTrack);
         currentScoreDef->Process(generateScoreDefMIDI);
 
         for (layers = staves->second.child.begin(); layers != staves->second.child.end(); ++layers) {
-            filters.Clear();
+            Filters &filters = layerFilters.emplace_back();
             // Create ad comparison object for each type / @n
-            AttNIntegerComparison matchStaff(STAFF, staves->first);
-            AttNIntegerComparison matchLayer(LAYER, layers->first);
-            filters.Add(&matchStaff);
-            filters.Add(&matchLayer);
+            filters.Add(&comparisons.emplace_back(STAFF, staves->first));
+            filters.Add(&comparisons.emplace_back(LAYER, layers->first));
 
-            GenerateMIDIFunctor generateMIDI(midiFile);
+            GenerateMIDIFunctor &generateMIDI = layerFunctors.emplace_back(addMIDIBuffer(midiTrack));
             generateMIDI.SetFilters(&filters);
 
             generateMIDI.SetChannel(midiChannel);
@@ -503,8 +580,23 @@ void Doc::ExportMIDI(smf::MidiFile *midiFile)
             generateMIDI.SetDeferredNotes(initMIDI.GetDeferredNotes());
             generateMIDI.SetCueExclusion(this->GetOptions()->m_midiNoCue.GetValue());
 
-            // LogDebug("Exporting track %d ----------------", midiTrack);
-            this->Process(generateMIDI);
+            generateMIDILayers.Add(&generateMIDI);
+        }
+    }
+
+    this->Process(generateMIDILayers);
+
+    // Merge the buffers into the MIDI file, moving the events without copying them
+    for (smf::MidiFile &midiBuffer : midiBuffers) {
+        if (midiFile->getTrackCount() < midiBuffer.getTrackCount()) {
+            midiFile->addTracks(midiBuffer.getTrackCount() - midiFile->getTrackCount());
+        }
+        for (int track = 0; track < midiBuffer.getTrackCount(); ++track) {
+            smf::MidiEventList &events = midiBuffer[track];
+            for (int i = 0; i < events.getEventCount(); ++i) {
+                (*midiFile)[track].push_back_no_copy(&events[i]);
+            }
+            events.detach();
         }
     }
 }
@@ -530,6 +622,27 @@ bool Doc::ExportTimemap(std::string &output, bool includeRests, bool includeMeas
     return true;
 }
 
+bool Doc::ExportBinaryTimemap(std::vector<unsigned char> &output, bool includeRests, bool includeMeasures)
+{
+    if (!this->HasTimemap()) {
+        // generate MIDI timemap before progressing
+        CalculateTimemap();
+    }
+    if (!this->HasTimemap()) {
+        LogWarning("Calculation of the timemap failed, the timemap cannot be exported.");
+        output.clear();
+        return false;
+    }
+    Timemap timemap;
+    GenerateTimemapFunctor generateTimemap(&timemap);
+    generateTimemap.SetCueExclusion(this->GetOptions()->m_midiNoCue.GetValue());
+    this->Process(generateTimemap);
+
+    timemap.ToBinary(output, includeRests, includeMeasures);
+
+    return true;
+}
+
 bool Doc::ExportExpansionMap(std::string &output)
 {
     if (m_expansionMap.HasExpansionMap()) {
@@ -561,6 +674,18 @@ bool Doc::ExportFeatures(std::string &output, const std::string &options)
 
 void Doc::PrepareData()
 {
+    // The wall time of each stage is recorded when the runtime clock is available
+    m_prepareDataTimings.clear();
+#ifndef NO_RUNTIME
+    RuntimeClock stageClock;
+#endif
+    auto endStage = [&](const std::string &stage) {
+#ifndef NO_RUNTIME
+        m_prepareDataTimings.push_back({ stage, stageClock.GetSeconds() * 1000.0 });
+        stageClock.Reset();
+#endif
+    };
+
     /************ Reset and initialization ************/
 
     if (m_dataPreparationDone) {
@@ -569,15 +694,25 @@ void Doc::PrepareData()
     }
     PrepareDataInitializationFunctor prepareDataInitialization(this);
     this->Process(prepareDataInitialization);
+    endStage("initialization");
 
     /************ Generate measure indices ************/
 
     this->PrepareMeasureIndices();
+    endStage("measureIndices");
 
-    /************ Store default durations ************/
+    /************ Store default durations and resolve <reh> without @startid ************/
 
+    // Resolve <reh> elements first, since they can be encoded without @startid or @tstamp, but we need one internally
+    // for placement. This does not depend on the durations and on the time spanning elements, so we can do both in a
+    // single traversal.
+    CompositeFunctor durationAndRehComposite;
     PrepareDurationFunctor prepareDuration;
-    this->Process(prepareDuration);
+    durationAndRehComposite.Add(&prepareDuration);
+    PrepareRehPositionFunctor prepareRehPosition;
+    durationAndRehComposite.Add(&prepareRehPosition);
+    this->Process(durationAndRehComposite);
+    endStage("durationAndReh");
 
     /************ Resolve @startid / @endid ************/
 
@@ -606,24 +741,36 @@ void Doc::PrepareData()
     if (unmatchedElements > 0) {
         LogWarning("%d time spanning element(s) with startid and endid could not be matched.", unmatchedElements);
     }
+    endStage("timeSpanning");
 
     /************ Resolve @startid (only) ************/
 
-    // Resolve <reh> elements first, since they can be encoded without @startid or @tstamp, but we need one internally
-    // for placement
-    PrepareRehPositionFunctor prepareRehPosition;
-    this->Process(prepareRehPosition);
-
     // Try to match all time pointing elements (tempo, fermata, etc) by processing backwards
     PrepareTimePointingFunctor prepareTimePointing;
     prepareTimePointing.SetDirection(BACKWARD);
     this->Process(prepareTimePointing);
+    endStage("timePointing");
 
-    /************ Resolve @tstamp / tstamp2 ************/
+    /************ Resolve @tstamp / tstamp2, linking (@next) and @plist ************/
+
+    // The timestamps, the links and the plist are independent and collected in a single traversal
+    CompositeFunctor timestampsAndLinkingComposite;
 
     // Now try to match the @tstamp and @tstamp2 attributes.
     PrepareTimestampsFunctor prepareTimestamps;
-    this->Process(prepareTimestamps);
+    timestampsAndLinkingComposite.Add(&prepareTimestamps);
+
+    // Try to match all pointing elements using @next, @sameas and @stem.sameas
+    PrepareLinkingFunctor prepareLinking;
+    timestampsAndLinkingComposite.Add(&prepareLinking);
+
+    // Try to match all pointing elements using @plist
+    PreparePlistFunctor preparePlist;
+    timestampsAndLinkingComposite.Add(&preparePlist);
+
+    this->Process(timestampsAndLinkingComposite);
+    prepareLinking.SetDataCollectionCompleted();
+    preparePlist.SetDataCollectionCompleted();
 
     // If some are still there, then it is probably an issue in the encoding
     if (!prepareTimestamps.GetInterfaceIDPairs().empty()) {
@@ -631,13 +778,6 @@ void Doc::PrepareData()
             prepareTimestamps.GetInterfaceIDPairs().size());
     }
 
-    /************ Resolve linking (@next) ************/
-
-    // Try to match all pointing elements using @next, @sameas and @stem.sameas
-    PrepareLinkingFunctor prepareLinking;
-    this->Process(prepareLinking);
-    prepareLinking.SetDataCollectionCompleted();
-
     // If we have some left process again backward
     if (!prepareLinking.GetSameasIDPairs().empty() || !prepareLinking.GetStemSameasIDPairs().empty()) {
         prepareLinking.SetDirection(BACKWARD);
@@ -656,13 +796,6 @@ void Doc::PrepareData()
             prepareLinking.GetStemSameasIDPairs().size());
     }
 
-    /************ Resolve @plist ************/
-
-    // Try to match all pointing elements using @plist
-    PreparePlistFunctor preparePlist;
-    this->Process(preparePlist);
-    preparePlist.SetDataCollectionCompleted();
-
     // Process plist after all pairs have been collected
     if (!preparePlist.GetInterfaceIDPairs().empty()) {
         this->Process(preparePlist);
@@ -672,22 +805,28 @@ void Doc::PrepareData()
     if (!preparePlist.GetInterfaceIDPairs().empty()) {
         LogWarning("%d element(s) with a @plist could not match the target", preparePlist.GetInterfaceIDPairs().size());
     }
+    endStage("timestampsAndLinking");
+
+    /************ Resolve cross staff and match pedal lines ************/
 
-    /************ Resolve cross staff ************/
+    CompositeFunctor crossStaffAndPedalsComposite;
 
     // Prepare the cross-staff pointers
     PrepareCrossStaffFunctor prepareCrossStaff;
-    this->Process(prepareCrossStaff);
+    crossStaffAndPedalsComposite.Add(&prepareCrossStaff);
+
+    PreparePedalsFunctor preparePedals(this);
+    crossStaffAndPedalsComposite.Add(&preparePedals);
+
+    this->Process(crossStaffAndPedalsComposite);
+    endStage("crossStaffAndPedals");
 
     /************ Resolve beamspan elements ***********/
 
+    // This has to be done once all the cross-staff pointers are set since they are overwritten for beam spans
     PrepareBeamSpanElementsFunctor prepareBeamSpanElements;
     this->Process(prepareBeamSpanElements);
-
-    /************ Match pedal lines ***********/
-
-    PreparePedalsFunctor preparePedals(this);
-    this->Process(preparePedals);
+    endStage("beamSpans");
 
     /************ Prepare processing by staff/layer/verse ************/
 
@@ -696,36 +835,51 @@ void Doc::PrepareData()
     InitProcessingListsFunctor initProcessingLists;
 
     // We first fill a tree of ints with [staff/layer] and [staff/layer/verse] numbers (@n) to be processed
-    // LogElapsedTimeStart();
     this->Process(initProcessingLists);
     const IntTree &layerTree = initProcessingLists.GetLayerTree();
     const IntTree &verseTree = initProcessingLists.GetVerseTree();
 
     // The tree is used to process each staff/layer/verse separately
     // For this, we use an array of AttNIntegerComparison that looks for each object if it is of the type
-    // and with @n specified
-
+    // and with @n specified. The functors for each staff/layer/verse are then processed in a single traversal.
     IntTree_t::const_iterator staves;
     IntTree_t::const_iterator layers;
     IntTree_t::const_iterator verses;
 
-    /************ Resolve some pointers by layer ************/
-
-    Filters filters;
+    std::list<AttNIntegerComparison> matchNs;
+    std::list<Filters> layerFilters;
     for (staves = layerTree.child.begin(); staves != layerTree.child.end(); ++staves) {
         for (layers = staves->second.child.begin(); layers != staves->second.child.end(); ++layers) {
-            filters.Clear();
             // Create ad comparison object for each type / @n
-            AttNIntegerComparison matchStaff(STAFF, staves->first);
-            AttNIntegerComparison matchLayer(LAYER, layers->first);
-            filters.Add(&matchStaff);
-            filters.Add(&matchLayer);
-
-            PreparePointersByLayerFunctor preparePointersByLayer;
-            preparePointersByLayer.SetFilters(&filters);
-            this->Process(preparePointersByLayer);
+            Filters &filters = layerFilters.emplace_back();
+            filters.Add(&matchNs.emplace_back(STAFF, staves->first));
+            filters.Add(&matchNs.emplace_back(LAYER, layers->first));
         }
     }
+    std::list<Filters> verseFilters;
+    for (staves = verseTree.child.begin(); staves != verseTree.child.end(); ++staves) {
+        for (layers = staves->second.child.begin(); layers != staves->second.child.end(); ++layers) {
+            for (verses = layers->second.child.begin(); verses != layers->second.child.end(); ++verses) {
+                Filters &filters = verseFilters.emplace_back();
+                filters.Add(&matchNs.emplace_back(STAFF, staves->first));
+                filters.Add(&matchNs.emplace_back(LAYER, layers->first));
+                filters.Add(&matchNs.emplace_back(VERSE, verses->first));
+            }
+        }
+    }
+    endStage("processingLists");
+
+    /************ Resolve some pointers by layer ************/
+
+    CompositeFunctor pointersByLayerComposite;
+    std::list<PreparePointersByLayerFunctor> preparePointersByLayer;
+    for (Filters &filters : layerFilters) {
+        PreparePointersByLayerFunctor &functor = preparePointersByLayer.emplace_back();
+        functor.SetFilters(&filters);
+        pointersByLayerComposite.Add(&functor);
+    }
+    this->Process(pointersByLayerComposite);
+    endStage("pointersByLayer");
 
     /************ Resolve delayed turns ************/
 
@@ -733,47 +887,30 @@ void Doc::PrepareData()
     this->Process(prepareDelayedTurns);
     prepareDelayedTurns.SetDataCollectionCompleted();
 
+    // The same functor is used for each layer, so the layers have to be processed one after the other
     if (!prepareDelayedTurns.GetDelayedTurns().empty()) {
-        for (staves = layerTree.child.begin(); staves != layerTree.child.end(); ++staves) {
-            for (layers = staves->second.child.begin(); layers != staves->second.child.end(); ++layers) {
-                filters.Clear();
-                // Create ad comparison object for each type / @n
-                AttNIntegerComparison matchStaff(STAFF, staves->first);
-                AttNIntegerComparison matchLayer(LAYER, layers->first);
-                filters.Add(&matchStaff);
-                filters.Add(&matchLayer);
-
-                prepareDelayedTurns.SetFilters(&filters);
-                prepareDelayedTurns.ResetCurrent();
-                this->Process(prepareDelayedTurns);
-            }
+        for (Filters &filters : layerFilters) {
+            prepareDelayedTurns.SetFilters(&filters);
+            prepareDelayedTurns.ResetCurrent();
+            this->Process(prepareDelayedTurns);
         }
     }
+    endStage("delayedTurns");
 
     /************ Resolve lyric connectors ************/
 
     // Same for the lyrics, but Verse by Verse since Syl are TimeSpanningInterface elements for handling connectors
-    for (staves = verseTree.child.begin(); staves != verseTree.child.end(); ++staves) {
-        for (layers = staves->second.child.begin(); layers != staves->second.child.end(); ++layers) {
-            for (verses = layers->second.child.begin(); verses != layers->second.child.end(); ++verses) {
-                // std::cout << staves->first << " => " << layers->first << " => " << verses->first << '\n';
-                filters.Clear();
-                // Create ad comparison object for each type / @n
-                AttNIntegerComparison matchStaff(STAFF, staves->first);
-                AttNIntegerComparison matchLayer(LAYER, layers->first);
-                AttNIntegerComparison matchVerse(VERSE, verses->first);
-                filters.Add(&matchStaff);
-                filters.Add(&matchLayer);
-                filters.Add(&matchVerse);
-
-                // The first pass sets m_drawingFirstNote and m_drawingLastNote for each syl
-                // m_drawingLastNote is set only if the syl has a forward connector
-                PrepareLyricsFunctor prepareLyrics;
-                prepareLyrics.SetFilters(&filters);
-                this->Process(prepareLyrics);
-            }
-        }
-    }
+    // Each functor sets m_drawingFirstNote and m_drawingLastNote for each syl of its verse
+    // m_drawingLastNote is set only if the syl has a forward connector
+    CompositeFunctor lyricsComposite;
+    std::list<PrepareLyricsFunctor> prepareLyrics;
+    for (Filters &filters : verseFilters) {
+        PrepareLyricsFunctor &functor = prepareLyrics.emplace_back();
+        functor.SetFilters(&filters);
+        lyricsComposite.Add(&functor);
+    }
+    this->Process(lyricsComposite);
+    endStage("lyrics");
 
     /************ Fill control event spanning ************/
 
@@ -788,54 +925,46 @@ void Doc::PrepareData()
         LogDebug("%d time spanning elements could not be set as running",
             prepareStaffCurrentTimeSpanning.GetTimeSpanningElements().size());
     }
+    endStage("staffCurrentTimeSpanning");
+
+    /************ Resolve mRpt, endings, floating groups, cue size and @altsym ************/
 
-    /************ Resolve mRpt ************/
+    // These are independent and processed in a single traversal
+    CompositeFunctor rptAndDrawingComposite;
 
     // Process by staff for matching mRpt elements and setting the drawing number
-    for (staves = layerTree.child.begin(); staves != layerTree.child.end(); ++staves) {
-        for (layers = staves->second.child.begin(); layers != staves->second.child.end(); ++layers) {
-            filters.Clear();
-            // Create ad comparison object for each type / @n
-            AttNIntegerComparison matchStaff(STAFF, staves->first);
-            AttNIntegerComparison matchLayer(LAYER, layers->first);
-            filters.Add(&matchStaff);
-            filters.Add(&matchLayer);
-
-            // We set multiNumber to NONE for indicated we need to look at the staffDef when reaching the first staff
-            PrepareRptFunctor prepareRpt(this);
-            prepareRpt.SetFilters(&filters);
-            this->Process(prepareRpt);
-        }
+    std::list<PrepareRptFunctor> prepareRpt;
+    for (Filters &filters : layerFilters) {
+        PrepareRptFunctor &functor = prepareRpt.emplace_back(this);
+        functor.SetFilters(&filters);
+        rptAndDrawingComposite.Add(&functor);
     }
 
-    /************ Resolve endings ************/
-
     // Prepare the endings (pointers to the measure after and before the boundaries)
     PrepareMilestonesFunctor prepareMilestones;
-    this->Process(prepareMilestones);
-
-    /************ Resolve floating groups for vertical alignment ************/
+    rptAndDrawingComposite.Add(&prepareMilestones);
 
     // Prepare the floating drawing groups
     PrepareFloatingGrpsFunctor prepareFloatingGrps;
-    this->Process(prepareFloatingGrps);
-
-    /************ Resolve cue size ************/
+    rptAndDrawingComposite.Add(&prepareFloatingGrps);
 
     // Prepare the drawing cue size
     PrepareCueSizeFunctor prepareCueSize;
-    this->Process(prepareCueSize);
+    rptAndDrawingComposite.Add(&prepareCueSize);
 
-    /************ Resolve @altsym ************/
-
-    // Try to match all pointing elements using @next, @sameas and @stem.sameas
+    // Try to match all pointing elements using @altsym
     PrepareAltSymFunctor prepareAltSym;
-    this->Process(prepareAltSym);
+    rptAndDrawingComposite.Add(&prepareAltSym);
+
+    this->Process(rptAndDrawingComposite);
+    endStage("rptAndDrawing");
 
     /************ Instanciate LayerElement parts (stem, flag, dots, etc) ************/
 
+    // This adds children to the layer elements and cannot be processed with the other functors
     PrepareLayerElementPartsFunctor prepareLayerElementParts;
     this->Process(prepareLayerElementParts);
+    endStage("layerElementParts");
 
     /************ Add default syl for syllables (if applicable) ************/
     ListOfObjects syllables = this->FindAllDescendantsByType(SYLLABLE);
@@ -860,8 +989,7 @@ void Doc::PrepareData()
 
     ScoreDefSetGrpSymFunctor scoreDefSetGrpSym;
     this->GetCurrentScoreDef()->Process(scoreDefSetGrpSym);
-
-    // LogElapsedTimeEnd ("Preparing drawing");
+    endStage("syllablesAndFacsimile");
 
     m_dataPreparationDone = true;
 }
@@ -936,6 +1064,9 @@ void Doc::CastOffDocBase(bool useSb, bool usePb, bool smart)
         return;
     }
 
+    // The index is rebuilt on the next lookup instead of being updated for every object moved
+    this->InvalidateIDIndex();
+
     std::list<Score *> scores = this->GetScores();
     assert(!scores.empty());
 
@@ -947,10 +1078,12 @@ void Doc::CastOffDocBase(bool useSb, bool usePb, bool smart)
     // Check if the the horizontal layout is cached by looking at the first measure
     // The cache is not set the first time, or can be reset by Doc::UnCastOffDoc
     Measure *firstMeasure = vrv_cast<Measure *>(unCastOffPage->FindDescendantByType(MEASURE));
-    if (!firstMeasure || !firstMeasure->HasCachedHorizontalLayout()) {
+    // It is also not valid anymore once some measures have been edited
+    if (!firstMeasure || !firstMeasure->HasCachedHorizontalLayout() || m_layoutDamagedCache) {
         // LogDebug("Performing the horizontal layout");
         unCastOffPage->LayOutHorizontally();
         unCastOffPage->LayOutHorizontallyWithCache();
+        m_layoutDamagedCache = false;
     }
     else {
         unCastOffPage->LayOutHorizontallyWithCache(true);
@@ -965,7 +1098,7 @@ void Doc::CastOffDocBase(bool useSb, bool usePb, bool smart)
     }
     else {
         CastOffSystemsFunctor castOffSystems(castOffSinglePage, this, smart);
-        castOffSystems.SetSystemWidth(m_drawingPageContentWidth);
+        castOffSystems.SetSystemWidth(this->GetDrawingContext().m_drawingPageContentWidth);
         unCastOffPage->Process(castOffSystems);
         leftoverSystem = castOffSystems.GetLeftoverSystem();
     }
@@ -1003,6 +1136,35 @@ void Doc::CastOffDocBase(bool useSb, bool usePb, bool smart)
     // Here we redo the alignment because of the new scoreDefs
     // Because of the new scoreDef, we need to reset cached drawingX
     castOffSinglePage->ResetCachedDrawingX();
+
+    if (m_options->m_progressiveLayout.GetValue()) {
+        // Detach the content page for calculating the running element heights
+        pages->DetachChild(0);
+        this->ResetDataPage();
+
+        for (Score *score : scores) {
+            score->CalcRunningElementHeight(this);
+        }
+
+        Page *castOffFirstPage = new Page();
+        m_castOffPages = new CastOffPagesFunctor(NULL, this, castOffFirstPage);
+        m_castOffPages->SetPageHeight(this->GetDrawingContext().m_drawingPageContentHeight);
+        m_castOffPages->SetLeftoverSystem(leftoverSystem);
+
+        // The content page is kept as last page until all its systems are cast off
+        pages->AddChild(castOffFirstPage);
+        pages->AddChild(castOffSinglePage);
+        m_castOffPendingPage = castOffSinglePage;
+        m_castOffShift = VRV_UNSET;
+        m_castOffScore = castOffSinglePage->m_score;
+        m_castOffScoreDefPageCount = 0;
+
+        m_isCastOff = true;
+
+        this->CastOffPendingPages(1);
+        return;
+    }
+
     castOffSinglePage->LayOutVertically();
 
     // Detach the contentPage to prepare for CastOffPages
@@ -1016,7 +1178,7 @@ void Doc::CastOffDocBase(bool useSb, bool usePb, bool smart)
 
     Page *castOffFirstPage = new Page();
     CastOffPagesFunctor castOffPages(castOffSinglePage, this, castOffFirstPage);
-    castOffPages.SetPageHeight(m_drawingPageContentHeight);
+    castOffPages.SetPageHeight(this->GetDrawingContext().m_drawingPageContentHeight);
     castOffPages.SetLeftoverSystem(leftoverSystem);
 
     pages->AddChild(castOffFirstPage);
@@ -1031,6 +1193,276 @@ void Doc::CastOffDocBase(bool useSb, bool usePb, bool smart)
     m_isCastOff = true;
 }
 
+void Doc::CastOffPendingPages(int pageCount)
+{
+    if (!m_castOffPendingPage) return;
+
+    if ((pageCount != VRV_UNSET) && (this->GetCastOffPageCount() >= pageCount)) return;
+
+    while (m_castOffPendingPage && ((pageCount == VRV_UNSET) || (this->GetCastOffPageCount() < pageCount))) {
+        this->CastOffPendingSystem();
+    }
+
+    this->ScoreDefSetCastOffPages();
+
+    // The pending page was deleted once empty
+    if (!m_castOffPendingPage) {
+        this->ResetPendingPages();
+    }
+}
+
+void Doc::CastOffPendingSystem()
+{
+    assert(m_castOffPendingPage);
+    assert(m_castOffPages);
+
+    Pages *pages = this->GetPages();
+    assert(pages);
+
+    // Move the next system with the page elements preceding it to a page of its own.
+    // The first one goes before the first page for the page header to be taken into account in the layout.
+    Page *systemPage = new Page();
+    pages->InsertChild(systemPage, (m_castOffShift == VRV_UNSET) ? 0 : m_castOffPendingPage->GetIdx());
+    System *system = NULL;
+    while (!system && (m_castOffPendingPage->GetChildCount() > 0)) {
+        Object *child = m_castOffPendingPage->DetachChild(0);
+        systemPage->AddChild(child);
+        if (child->Is(SCORE)) m_castOffScore = vrv_cast<Score *>(child);
+        if (child->Is(SYSTEM)) system = vrv_cast<System *>(child);
+    }
+    // Also move the end milestones following it since they mark the last system of an mdiv
+    while (system && (m_castOffPendingPage->GetChildCount() > 0)) {
+        if (!m_castOffPendingPage->GetChild(0)->Is(PAGE_MILESTONE_END)) break;
+        systemPage->AddChild(m_castOffPendingPage->DetachChild(0));
+    }
+
+    if (system) {
+        systemPage->m_score = m_castOffScore;
+        systemPage->m_scoreEnd = m_castOffScore;
+        this->ResetDataPage();
+        this->SetDrawingPage(systemPage->GetIdx());
+        this->SetCurrentScore(m_castOffScore);
+        systemPage->LayOutVertically();
+
+        // Position the system as the AlignSystemsFunctor does when all the systems are on one page
+        if (m_castOffShift != VRV_UNSET) {
+            const int unit = this->GetDrawingUnit(100);
+            const int systemSpacing = m_options->m_spacingSystem.GetValue() * unit;
+            m_castOffShift -= std::max(systemSpacing, 2 * unit);
+            system->SetDrawingYRel(m_castOffShift);
+        }
+        assert(system->m_systemAligner.GetBottomAlignment());
+        m_castOffShift = system->GetDrawingYRel() + system->m_systemAligner.GetBottomAlignment()->GetYRel();
+    }
+
+    pages->DetachChild(systemPage->GetIdx());
+    this->ResetDataPage();
+
+    m_castOffPages->SetContentPage(systemPage);
+    systemPage->Process(*m_castOffPages);
+    delete systemPage;
+
+    if (m_castOffPendingPage->GetChildCount() == 0) {
+        pages->DeleteChild(m_castOffPendingPage);
+        m_castOffPendingPage = NULL;
+    }
+}
+
+void Doc::ScoreDefSetCastOffPages()
+{
+    Pages *pages = this->GetPages();
+    assert(pages);
+
+    // Page::m_score and Page::m_scoreEnd are set as in Doc::ScoreDefSetCurrentDoc, which is cheap with a depth of 3
+    for (Object *child : pages->GetChildren()) {
+        Page *page = vrv_cast<Page *>(child);
+        assert(page);
+        page->m_score = NULL;
+        page->m_scoreEnd = NULL;
+    }
+    ScoreDefSetCurrentPageFunctor scoreDefSetCurrentPage(this);
+    scoreDefSetCurrentPage.SetDirection(BACKWARD);
+    this->Process(scoreDefSetCurrentPage, 3);
+    scoreDefSetCurrentPage.SetDirection(FORWARD);
+    this->Process(scoreDefSetCurrentPage, 3);
+
+    // Running the ScoreDefSetCurrentFunctor on the whole document for every page would be too slow.
+    // The content of the systems does not change with the cast-off, so the page scoreDef is the one of its first
+    // system.
+    const int castOffPageCount = this->GetCastOffPageCount();
+    for (; m_castOffScoreDefPageCount < castOffPageCount; ++m_castOffScoreDefPageCount) {
+        Page *page = vrv_cast<Page *>(pages->GetChild(m_castOffScoreDefPageCount));
+        assert(page);
+        System *system = vrv_cast<System *>(page->FindDescendantByType(SYSTEM, 1));
+        if (system && system->GetDrawingScoreDef()) {
+            page->m_drawingScoreDef = *system->GetDrawingScoreDef();
+        }
+        else if (page->m_score) {
+            page->m_drawingScoreDef = *page->m_score->GetScoreDef();
+        }
+    }
+}
+
+void Doc::ResetPendingPages()
+{
+    if (m_castOffPages) {
+        delete m_castOffPages;
+        m_castOffPages = NULL;
+    }
+    m_castOffPendingPage = NULL;
+    m_castOffShift = VRV_UNSET;
+    m_castOffScore = NULL;
+    m_castOffScoreDefPageCount = 0;
+}
+
+int Doc::GetCastOffPageCount() const
+{
+    // The last page before the pending page is still being filled
+    return (m_castOffPendingPage) ? std::max(this->GetPageCount() - 1, 0) : this->GetPageCount();
+}
+
+void Doc::AddLayoutDamage(Object *object)
+{
+    assert(object);
+
+    m_layoutDamagedCache = true;
+
+    Measure *measure = vrv_cast<Measure *>(object->Is(MEASURE) ? object : object->GetFirstAncestor(MEASURE));
+    if (!measure) {
+        m_layoutDamagedDoc = true;
+        return;
+    }
+    m_layoutDamagedMeasureIds.insert(measure->GetID());
+}
+
+bool Doc::LayOutDamagedPages()
+{
+    if (!this->IsCastOff() || this->HasPendingPages() || m_layoutDamagedDoc) return false;
+
+    Pages *pages = this->GetPages();
+    assert(pages);
+
+    // With encoded breaks, the system and page breaks do not depend on the layout
+    const bool encodedBreaks = (m_options->m_breaks.GetValue() == BREAKS_encoded) && this->FindDescendantByType(PB);
+    const bool encodedSystemBreaks = encodedBreaks || (m_options->m_breaks.GetValue() == BREAKS_line);
+
+    // Find the systems and the pages of the damaged measures in document order, with their size before the edition
+    ListOfObjects systems = this->FindAllDescendantsByType(SYSTEM, false, 3);
+    std::vector<System *> damagedSystems;
+    std::vector<std::pair<int, int>> previousWidths;
+    std::vector<Page *> damagedPages;
+    std::vector<int> previousJustifiableHeights;
+    int damagedMeasureCount = 0;
+    for (Object *object : systems) {
+        System *system = vrv_cast<System *>(object);
+        assert(system);
+        const ListOfObjects measures = system->FindAllDescendantsByType(MEASURE, false);
+        const int count = (int)std::count_if(measures.begin(), measures.end(),
+            [this](Object *measure) { return (m_layoutDamagedMeasureIds.count(measure->GetID()) > 0); });
+        if (count == 0) continue;
+        damagedMeasureCount += count;
+
+        Page *page = vrv_cast<Page *>(system->GetFirstAncestor(PAGE));
+        // The width of the systems before the edition is known only if the page was laid out
+        if (!page || !page->IsLayoutDone()) return false;
+        if (!encodedSystemBreaks && (system->m_castOffTotalWidth == 0)) return false;
+
+        damagedSystems.push_back(system);
+        previousWidths.push_back({ system->m_drawingTotalWidth, system->m_drawingJustifiableWidth });
+        if (damagedPages.empty() || (damagedPages.back() != page)) {
+            damagedPages.push_back(page);
+            previousJustifiableHeights.push_back(page->m_drawingJustifiableHeight);
+        }
+    }
+    // A damaged measure was deleted or is not in a system anymore
+    if (damagedMeasureCount != (int)m_layoutDamagedMeasureIds.size()) return false;
+
+    // Lay out the damaged pages horizontally and check if the system breaks still hold with the new widths
+    // Until everything is checked, only the layout of these pages is changed, which a full layout does again anyway
+    for (Page *page : damagedPages) {
+        this->SetDrawingPage(page->GetIdx());
+        page->LayOutHorizontally();
+        const int contentWidth = this->GetDrawingContext().m_drawingPageContentWidth;
+
+        if (encodedSystemBreaks) continue;
+        for (int i = 0; i < (int)damagedSystems.size(); ++i) {
+            System *system = damagedSystems.at(i);
+            if (system->GetParent() != page) continue;
+            const int widthChange = system->m_drawingTotalWidth - previousWidths.at(i).first;
+            // The width of the system as calculated by the CastOffSystemsFunctor, with the width change
+            const int castOffWidth = system->m_castOffTotalWidth + system->GetDrawingAbbrLabelsWidth() + widthChange;
+            // A system with a single measure is kept even when it is too wide
+            if ((widthChange > 0) && (castOffWidth > contentWidth)
+                && (system->FindAllDescendantsByType(MEASURE, false).size() > 1)) {
+                return false;
+            }
+            // Check if the first measure of the next system would now fit
+            auto next = std::find(systems.begin(), systems.end(), system);
+            if ((widthChange < 0) && (next != systems.end()) && (++next != systems.end())) {
+                Measure *nextMeasure = vrv_cast<Measure *>((*next)->FindDescendantByType(MEASURE));
+                if (nextMeasure && nextMeasure->HasCachedHorizontalLayout()
+                    && (castOffWidth + nextMeasure->GetCachedWidth() <= contentWidth)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < (int)damagedPages.size(); ++i) {
+        Page *page = damagedPages.at(i);
+        this->SetDrawingPage(page->GetIdx());
+        page->LayOut(true);
+
+        // The page overflows and a system needs to move to the next page
+        if (!encodedBreaks && (page->m_drawingJustifiableHeight < 0)
+            && (page->m_drawingJustifiableHeight < previousJustifiableHeights.at(i))
+            && (page->GetChildCount(SYSTEM) > 1)) {
+            return false;
+        }
+    }
+
+    // Nothing requires a full layout anymore - the cast-off widths are updated for the next incremental layout
+    for (int i = 0; i < (int)damagedSystems.size(); ++i) {
+        System *system = damagedSystems.at(i);
+        system->m_castOffTotalWidth += system->m_drawingTotalWidth - previousWidths.at(i).first;
+        system->m_castOffJustifiableWidth += system->m_drawingJustifiableWidth - previousWidths.at(i).second;
+    }
+
+    // Spanning elements can be drawn from the content of the previous or following page
+    auto isDamaged = [&damagedPages](Page *page) {
+        return (std::find(damagedPages.begin(), damagedPages.end(), page) != damagedPages.end());
+    };
+    for (Page *page : damagedPages) {
+        Page *previousPage = vrv_cast<Page *>(pages->GetPrevious(page));
+        if (previousPage && !isDamaged(previousPage)) previousPage->ResetLayoutDone();
+        Page *nextPage = vrv_cast<Page *>(pages->GetNext(page));
+        if (nextPage && !isDamaged(nextPage)) nextPage->ResetLayoutDone();
+    }
+
+    this->ResetLayoutDamage();
+
+    return true;
+}
+
+void Doc::ResetLayoutDamage()
+{
+    m_layoutDamagedMeasureIds.clear();
+    m_layoutDamagedDoc = false;
+}
+
+void Doc::EnableObjectArena(bool enable)
+{
+    if (enable == (m_objectArena != NULL)) return;
+
+    if (enable) {
+        m_objectArena = new ObjectArena();
+    }
+    else {
+        m_objectArena->Release();
+        m_objectArena = NULL;
+    }
+}
+
 void Doc::UnCastOffDoc(bool resetCache)
 {
     if (!this->IsCastOff()) {
@@ -1038,6 +1470,14 @@ void Doc::UnCastOffDoc(bool resetCache)
         return;
     }
 
+    // The pending page of a progressive layout is uncast off with the other pages
+    this->ResetPendingPages();
+    // The whole document is going to be laid out again
+    this->ResetLayoutDamage();
+
+    // The index is rebuilt on the next lookup instead of being updated for every object moved
+    this->InvalidateIDIndex();
+
     Pages *pages = this->GetPages();
     assert(pages);
 
@@ -1067,6 +1507,9 @@ void Doc::CastOffEncodingDoc()
         return;
     }
 
+    // The index is rebuilt on the next lookup instead of being updated for every object moved
+    this->InvalidateIDIndex();
+
     this->ScoreDefSetCurrentDoc();
 
     Pages *pages = this->GetPages();
@@ -1236,7 +1679,66 @@ void Doc::ReactivateSelection(bool resetAligners)
     pages->DetachChild(lastPage);
     pages->DetachChild(0);
     // Make sure we do not point to page moved out of the selection
-    this->m_drawingPage = NULL;
+    this->ResetDataPage();
+}
+
+const Object *Doc::FindInIDIndex(const std::string &id) const
+{
+    if (!m_idIndexIsValid) {
+        m_idIndexIsValid = true;
+        m_idIndexIsBuilding = true;
+        m_idIndexHasDuplicates = false;
+        // The doc itself is attached and is added to the index too
+        const_cast<Doc *>(this)->UpdateIDIndex(const_cast<Doc *>(this), true);
+        m_idIndexIsBuilding = false;
+    }
+
+    auto it = m_idIndex.find(id);
+    return (it != m_idIndex.end()) ? it->second : NULL;
+}
+
+void Doc::AddToIDIndex(Object *object)
+{
+    assert(object);
+
+    if (!m_idIndexIsValid) return;
+
+    auto result = m_idIndex.emplace(object->GetID(), object);
+    if (result.second || (result.first->second == object)) return;
+
+    // When building the index, the tree order is followed and we keep the first one.
+    // Otherwise, we do not know which one comes first and the index needs to be rebuilt.
+    if (m_idIndexIsBuilding) {
+        m_idIndexHasDuplicates = true;
+    }
+    else {
+        this->InvalidateIDIndex();
+    }
+}
+
+void Doc::RemoveFromIDIndex(Object *object)
+{
+    assert(object);
+
+    if (!m_idIndexIsValid) return;
+
+    auto it = m_idIndex.find(object->GetID());
+    if ((it == m_idIndex.end()) || (it->second != object)) return;
+
+    // Another object with the same id might have to take its place
+    if (m_idIndexHasDuplicates) {
+        this->InvalidateIDIndex();
+    }
+    else {
+        m_idIndex.erase(it);
+    }
+}
+
+void Doc::InvalidateIDIndex()
+{
+    m_idIndex.clear();
+    m_idIndexIsValid = false;
+    m_idIndexHasDuplicates = false;
 }
 
 void Doc::ConvertToPageBasedDoc()
@@ -1471,54 +1973,40 @@ const Pages *Doc::GetPages() const
 int Doc::GetPageCount() const
 {
     const Pages *pages = this->GetPages();
-    return ((pages) ? pages->GetChildCount() : 0);
+    if (!pages) return 0;
+    return (m_castOffPendingPage) ? pages->GetChildCount() - 1 : pages->GetChildCount();
+}
+
+const GlyphMetricsCache::Metrics &Doc::GetGlyphMetrics(char32_t code, int staffSize, bool graceSize) const
+{
+    const DrawingContext &context = this->GetDrawingContext();
+    context.m_glyphMetricsCache.SetScaling(context.m_drawingSmuflFontSize, m_options->m_graceFactor.GetValue());
+    return context.m_glyphMetricsCache.GetMetrics(this->GetResources(), code, staffSize, graceSize);
 }
 
 int Doc::GetGlyphHeight(char32_t code, int staffSize, bool graceSize) const
 {
-    int x, y, w, h;
-    const Resources &resources = this->GetResources();
-    const Glyph *glyph = resources.GetGlyph(code);
-    assert(glyph);
-    glyph->GetBoundingBox(x, y, w, h);
-    h = h * m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
-    if (graceSize) h = h * m_options->m_graceFactor.GetValue();
-    h = h * staffSize / 100;
-    return h;
+    return this->GetGlyphMetrics(code, staffSize, graceSize).m_height;
 }
 
 int Doc::GetGlyphWidth(char32_t code, int staffSize, bool graceSize) const
 {
-    int x, y, w, h;
-    const Resources &resources = this->GetResources();
-    const Glyph *glyph = resources.GetGlyph(code);
-    assert(glyph);
-    glyph->GetBoundingBox(x, y, w, h);
-    w = w * m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
-    if (graceSize) w = w * m_options->m_graceFactor.GetValue();
-    w = w * staffSize / 100;
-    return w;
+    return this->GetGlyphMetrics(code, staffSize, graceSize).m_width;
 }
 
 int Doc::GetGlyphAdvX(char32_t code, int staffSize, bool graceSize) const
 {
-    const Resources &resources = this->GetResources();
-    const Glyph *glyph = resources.GetGlyph(code);
-    assert(glyph);
-    int advX = glyph->GetHorizAdvX();
-    advX = advX * m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
-    if (graceSize) advX = advX * m_options->m_graceFactor.GetValue();
-    advX = advX * staffSize / 100;
-    return advX;
+    return this->GetGlyphMetrics(code, staffSize, graceSize).m_advX;
 }
 
 Point Doc::ConvertFontPoint(const Glyph *glyph, const Point &fontPoint, int staffSize, bool graceSize) const
 {
+    const DrawingContext &context = this->GetDrawingContext();
     assert(glyph);
 
     Point point;
-    point.x = fontPoint.x * m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
-    point.y = fontPoint.y * m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
+    point.x = fontPoint.x * context.m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
+    point.y = fontPoint.y * context.m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
     if (graceSize) {
         point.x = point.x * m_options->m_graceFactor.GetValue();
         point.y = point.y * m_options->m_graceFactor.GetValue();
@@ -1532,38 +2020,24 @@ Point Doc::ConvertFontPoint(const Glyph *glyph, const Point &fontPoint, int staf
 
 int Doc::GetGlyphLeft(char32_t code, int staffSize, bool graceSize) const
 {
-    int x, y, w, h;
-    const Resources &resources = this->GetResources();
-    const Glyph *glyph = resources.GetGlyph(code);
-    assert(glyph);
-    glyph->GetBoundingBox(x, y, w, h);
-    x = x * m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
-    if (graceSize) x = x * m_options->m_graceFactor.GetValue();
-    x = x * staffSize / 100;
-    return x;
+    return this->GetGlyphMetrics(code, staffSize, graceSize).m_x;
 }
 
 int Doc::GetGlyphRight(char32_t code, int staffSize, bool graceSize) const
 {
-    return this->GetGlyphLeft(code, staffSize, graceSize) + this->GetGlyphWidth(code, staffSize, graceSize);
+    const GlyphMetricsCache::Metrics &metrics = this->GetGlyphMetrics(code, staffSize, graceSize);
+    return metrics.m_x + metrics.m_width;
 }
 
 int Doc::GetGlyphBottom(char32_t code, int staffSize, bool graceSize) const
 {
-    int x, y, w, h;
-    const Resources &resources = this->GetResources();
-    const Glyph *glyph = resources.GetGlyph(code);
-    assert(glyph);
-    glyph->GetBoundingBox(x, y, w, h);
-    y = y * m_drawingSmuflFontSize / glyph->GetUnitsPerEm();
-    if (graceSize) y = y * m_options->m_graceFactor.GetValue();
-    y = y * staffSize / 100;
-    return y;
+    return this->GetGlyphMetrics(code, staffSize, graceSize).m_y;
 }
 
 int Doc::GetGlyphTop(char32_t code, int staffSize, bool graceSize) const
 {
-    return this->GetGlyphBottom(code, staffSize, graceSize) + this->GetGlyphHeight(code, staffSize, graceSize);
+    const GlyphMetricsCache::Metrics &metrics = this->GetGlyphMetrics(code, staffSize, graceSize);
+    return metrics.m_y + metrics.m_height;
 }
 
 int Doc::GetTextGlyphHeight(char32_t code, const FontInfo *font, bool graceSize) const
@@ -1659,7 +2133,7 @@ int Doc::GetDrawingOctaveSize(int staffSize) const
 
 int Doc::GetDrawingBrevisWidth(int staffSize) const
 {
-    return m_drawingBrevisWidth * staffSize / 100;
+    return this->GetDrawingContext().m_drawingBrevisWidth * staffSize / 100;
 }
 
 int Doc::GetDrawingBarLineWidth(int staffSize) const
@@ -1695,14 +2169,14 @@ int Doc::GetDrawingHairpinSize(int staffSize, bool withMargin) const
 
 int Doc::GetDrawingBeamWidth(int staffSize, bool graceSize) const
 {
-    int value = m_drawingBeamWidth * staffSize / 100;
+    int value = this->GetDrawingContext().m_drawingBeamWidth * staffSize / 100;
     if (graceSize) value = value * m_options->m_graceFactor.GetValue();
     return value;
 }
 
 int Doc::GetDrawingBeamWhiteWidth(int staffSize, bool graceSize) const
 {
-    int value = m_drawingBeamWhiteWidth * staffSize / 100;
+    int value = this->GetDrawingContext().m_drawingBeamWhiteWidth * staffSize / 100;
     if (graceSize) value = value * m_options->m_graceFactor.GetValue();
     return value;
 }
@@ -1733,28 +2207,33 @@ double Doc::GetCueScaling() const
 
 FontInfo *Doc::GetDrawingSmuflFont(int staffSize, bool graceSize)
 {
-    m_drawingSmuflFont.SetFaceName(m_options->m_font.GetValue().c_str());
-    int value = m_drawingSmuflFontSize * staffSize / 100;
+    DrawingContext &context = this->GetDrawingContext();
+    context.m_drawingSmuflFont.SetFaceName(m_options->m_font.GetValue().c_str());
+    int value = context.m_drawingSmuflFontSize * staffSize / 100;
     if (graceSize) value = value * m_options->m_graceFactor.GetValue();
-    m_drawingSmuflFont.SetPointSize(value);
-    return &m_drawingSmuflFont;
+    context.m_drawingSmuflFont.SetPointSize(value);
+    return &context.m_drawingSmuflFont;
 }
 
 FontInfo *Doc::GetDrawingLyricFont(int staffSize)
 {
-    m_drawingLyricFont.SetPointSize(m_drawingLyricFontSize * staffSize / 100);
-    return &m_drawingLyricFont;
+    DrawingContext &context = this->GetDrawingContext();
+    context.m_drawingLyricFont.SetPointSize(context.m_drawingLyricFontSize * staffSize / 100);
+    return &context.m_drawingLyricFont;
 }
 
 FontInfo *Doc::GetFingeringFont(int staffSize)
 {
-    m_fingeringFont.SetPointSize(m_fingeringFontSize * staffSize / 100);
-    return &m_fingeringFont;
+    DrawingContext &context = this->GetDrawingContext();
+    context.m_fingeringFont.SetPointSize(context.m_fingeringFontSize * staffSize / 100);
+    return &context.m_fingeringFont;
 }
 
 double Doc::GetMusicToLyricFontSizeRatio() const
 {
-    return (m_drawingLyricFontSize == 0.0) ? 1.0 : (double)m_drawingSmuflFontSize / (double)m_drawingLyricFontSize;
+    const DrawingContext &context = this->GetDrawingContext();
+    if (context.m_drawingLyricFontSize == 0.0) return 1.0;
+    return (double)context.m_drawingSmuflFontSize / (double)context.m_drawingLyricFontSize;
 }
 
 double Doc::GetLeftMargin(const ClassId classId) const
@@ -1916,88 +2395,123 @@ data_MEASUREMENTSIGNED Doc::GetStaffDistance(const ClassId classId, int staffInd
     return distance;
 }
 
+DrawingContext &Doc::GetDrawingContext()
+{
+    return const_cast<DrawingContext &>(std::as_const(*this).GetDrawingContext());
+}
+
+const DrawingContext &Doc::GetDrawingContext() const
+{
+    return (s_drawingContextDoc == this) ? *s_drawingContext : m_drawingContext;
+}
+
+Doc::DrawingContextScope::DrawingContextScope(const Doc *doc, DrawingContext *context)
+    : m_previousDoc(s_drawingContextDoc), m_previousContext(s_drawingContext)
+{
+    assert(doc);
+    assert(context);
+
+    s_drawingContextDoc = doc;
+    s_drawingContext = context;
+}
+
+Doc::DrawingContextScope::~DrawingContextScope()
+{
+    s_drawingContextDoc = m_previousDoc;
+    s_drawingContext = m_previousContext;
+}
+
+std::unique_lock<std::recursive_mutex> Doc::LockSharedDrawing() const
+{
+    std::recursive_mutex *mutex = this->GetDrawingContext().m_sharedDrawingMutex;
+    return (mutex) ? std::unique_lock<std::recursive_mutex>(*mutex) : std::unique_lock<std::recursive_mutex>();
+}
+
 Page *Doc::SetDrawingPage(int pageIdx)
 {
+    DrawingContext &context = this->GetDrawingContext();
     // out of range
     if (!HasPage(pageIdx)) {
         return NULL;
     }
     // nothing to do
-    if (m_drawingPage && m_drawingPage->GetIdx() == pageIdx) {
-        return m_drawingPage;
+    if (context.m_drawingPage && context.m_drawingPage->GetIdx() == pageIdx) {
+        return context.m_drawingPage;
     }
     Pages *pages = this->GetPages();
     assert(pages);
-    m_drawingPage = vrv_cast<Page *>(pages->GetChild(pageIdx));
-    assert(m_drawingPage);
+    context.m_drawingPage = vrv_cast<Page *>(pages->GetChild(pageIdx));
+    assert(context.m_drawingPage);
 
     int glyph_size;
 
     // we use the page members only if set (!= -1)
-    if (m_drawingPage->m_pageHeight != -1) {
-        m_drawingPageHeight = m_drawingPage->m_pageHeight;
-        m_drawingPageWidth = m_drawingPage->m_pageWidth;
-        m_drawingPageMarginBottom = m_drawingPage->m_pageMarginBottom;
-        m_drawingPageMarginLeft = m_drawingPage->m_pageMarginLeft;
-        m_drawingPageMarginRight = m_drawingPage->m_pageMarginRight;
-        m_drawingPageMarginTop = m_drawingPage->m_pageMarginTop;
+    if (context.m_drawingPage->m_pageHeight != -1) {
+        context.m_drawingPageHeight = context.m_drawingPage->m_pageHeight;
+        context.m_drawingPageWidth = context.m_drawingPage->m_pageWidth;
+        context.m_drawingPageMarginBottom = context.m_drawingPage->m_pageMarginBottom;
+        context.m_drawingPageMarginLeft = context.m_drawingPage->m_pageMarginLeft;
+        context.m_drawingPageMarginRight = context.m_drawingPage->m_pageMarginRight;
+        context.m_drawingPageMarginTop = context.m_drawingPage->m_pageMarginTop;
     }
     else if (m_pageHeight != -1) {
-        m_drawingPageHeight = m_pageHeight;
-        m_drawingPageWidth = m_pageWidth;
-        m_drawingPageMarginBottom = m_pageMarginBottom;
-        m_drawingPageMarginLeft = m_pageMarginLeft;
-        m_drawingPageMarginRight = m_pageMarginRight;
-        m_drawingPageMarginTop = m_pageMarginTop;
+        context.m_drawingPageHeight = m_pageHeight;
+        context.m_drawingPageWidth = m_pageWidth;
+        context.m_drawingPageMarginBottom = m_pageMarginBottom;
+        context.m_drawingPageMarginLeft = m_pageMarginLeft;
+        context.m_drawingPageMarginRight = m_pageMarginRight;
+        context.m_drawingPageMarginTop = m_pageMarginTop;
     }
     else {
-        m_drawingPageHeight = m_options->m_pageHeight.GetValue();
-        m_drawingPageWidth = m_options->m_pageWidth.GetValue();
-        m_drawingPageMarginBottom = m_options->m_pageMarginBottom.GetValue();
-        m_drawingPageMarginLeft = m_options->m_pageMarginLeft.GetValue();
-        m_drawingPageMarginRight = m_options->m_pageMarginRight.GetValue();
-        m_drawingPageMarginTop = m_options->m_pageMarginTop.GetValue();
+        context.m_drawingPageHeight = m_options->m_pageHeight.GetValue();
+        context.m_drawingPageWidth = m_options->m_pageWidth.GetValue();
+        context.m_drawingPageMarginBottom = m_options->m_pageMarginBottom.GetValue();
+        context.m_drawingPageMarginLeft = m_options->m_pageMarginLeft.GetValue();
+        context.m_drawingPageMarginRight = m_options->m_pageMarginRight.GetValue();
+        context.m_drawingPageMarginTop = m_options->m_pageMarginTop.GetValue();
 
         if (m_options->m_scaleToPageSize.GetValue()) {
-            m_drawingPageHeight = m_drawingPageHeight * 100 / m_options->m_scale.GetValue();
-            m_drawingPageWidth = m_drawingPageWidth * 100 / m_options->m_scale.GetValue();
+            context.m_drawingPageHeight = context.m_drawingPageHeight * 100 / m_options->m_scale.GetValue();
+            context.m_drawingPageWidth = context.m_drawingPageWidth * 100 / m_options->m_scale.GetValue();
             // Margins do remain the same
         }
     }
 
     if (m_options->m_landscape.GetValue()) {
-        int pageHeight = m_drawingPageWidth;
-        m_drawingPageWidth = m_drawingPageHeight;
-        m_drawingPageHeight = pageHeight;
-        int pageMarginRight = m_drawingPageMarginLeft;
-        m_drawingPageMarginLeft = m_drawingPageMarginRight;
-        m_drawingPageMarginRight = pageMarginRight;
+        int pageHeight = context.m_drawingPageWidth;
+        context.m_drawingPageWidth = context.m_drawingPageHeight;
+        context.m_drawingPageHeight = pageHeight;
+        int pageMarginRight = context.m_drawingPageMarginLeft;
+        context.m_drawingPageMarginLeft = context.m_drawingPageMarginRight;
+        context.m_drawingPageMarginRight = pageMarginRight;
     }
 
-    m_drawingPageContentHeight = m_drawingPageHeight - m_drawingPageMarginTop - m_drawingPageMarginBottom;
-    m_drawingPageContentWidth = m_drawingPageWidth - m_drawingPageMarginLeft - m_drawingPageMarginRight;
+    context.m_drawingPageContentHeight
+        = context.m_drawingPageHeight - context.m_drawingPageMarginTop - context.m_drawingPageMarginBottom;
+    context.m_drawingPageContentWidth
+        = context.m_drawingPageWidth - context.m_drawingPageMarginLeft - context.m_drawingPageMarginRight;
 
     // From here we could check if values have changed
     // Since m_options->m_interlDefin stays the same, it's useless to do it
     // every time for now.
 
-    m_drawingBeamMaxSlope = m_options->m_beamMaxSlope.GetValue();
-    m_drawingBeamMaxSlope /= 100;
+    context.m_drawingBeamMaxSlope = m_options->m_beamMaxSlope.GetValue();
+    context.m_drawingBeamMaxSlope /= 100;
 
     // values for beams
-    m_drawingBeamWidth = m_options->m_unit.GetValue();
-    m_drawingBeamWhiteWidth = m_options->m_unit.GetValue() / 2;
+    context.m_drawingBeamWidth = m_options->m_unit.GetValue();
+    context.m_drawingBeamWhiteWidth = m_options->m_unit.GetValue() / 2;
 
     // values for fonts
-    m_drawingSmuflFontSize = this->CalcMusicFontSize();
-    m_drawingLyricFontSize = m_options->m_unit.GetValue() * m_options->m_lyricSize.GetValue();
-    m_fingeringFontSize = m_drawingLyricFontSize * m_options->m_fingeringScale.GetValue();
+    context.m_drawingSmuflFontSize = this->CalcMusicFontSize();
+    context.m_drawingLyricFontSize = m_options->m_unit.GetValue() * m_options->m_lyricSize.GetValue();
+    context.m_fingeringFontSize = context.m_drawingLyricFontSize * m_options->m_fingeringScale.GetValue();
 
     glyph_size = this->GetGlyphWidth(SMUFL_E0A2_noteheadWhole, 100, 0);
 
-    m_drawingBrevisWidth = (int)((glyph_size * 0.8) / 2);
+    context.m_drawingBrevisWidth = (int)((glyph_size * 0.8) / 2);
 
-    return m_drawingPage;
+    return context.m_drawingPage;
 }
 
 int Doc::CalcMusicFontSize()
@@ -2007,26 +2521,28 @@ int Doc::CalcMusicFontSize()
 
 int Doc::GetAdjustedDrawingPageHeight() const
 {
-    assert(m_drawingPage);
+    const DrawingContext &context = this->GetDrawingContext();
+    assert(context.m_drawingPage);
 
     if ((this->GetType() == Transcription) || (this->GetType() == Facs)) {
-        return m_drawingPage->m_pageHeight / DEFINITION_FACTOR;
+        return context.m_drawingPage->m_pageHeight / DEFINITION_FACTOR;
     }
 
-    int contentHeight = m_drawingPage->GetContentHeight();
-    return (contentHeight + m_drawingPageMarginTop + m_drawingPageMarginBottom) / DEFINITION_FACTOR;
+    int contentHeight = context.m_drawingPage->GetContentHeight();
+    return (contentHeight + context.m_drawingPageMarginTop + context.m_drawingPageMarginBottom) / DEFINITION_FACTOR;
 }
 
 int Doc::GetAdjustedDrawingPageWidth() const
 {
-    assert(m_drawingPage);
+    const DrawingContext &context = this->GetDrawingContext();
+    assert(context.m_drawingPage);
 
     if ((this->GetType() == Transcription) || (this->GetType() == Facs)) {
-        return m_drawingPage->m_pageWidth / DEFINITION_FACTOR;
+        return context.m_drawingPage->m_pageWidth / DEFINITION_FACTOR;
     }
 
-    int contentWidth = m_drawingPage->GetContentWidth();
-    return (contentWidth + m_drawingPageMarginLeft + m_drawingPageMarginRight) / DEFINITION_FACTOR;
+    int contentWidth = context.m_drawingPage->GetContentWidth();
+    return (contentWidth + context.m_drawingPageMarginLeft + context.m_drawingPageMarginRight) / DEFINITION_FACTOR;
 }
 
 Score *Doc::GetCurrentScore()
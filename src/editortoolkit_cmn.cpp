@@ -215,6 +215,7 @@ bool EditorToolkitCMN::Delete(std::string &elementId)
     if (!element) return false;
 
     if (element->Is(NOTE)) {
+        m_doc->AddLayoutDamage(element);
         return this->DeleteNote(vrv_cast<Note *>(element));
     }
     return false;
@@ -234,6 +235,7 @@ bool EditorToolkitCMN::Drag(std::string &elementId, int x, int y)
             = (data_PITCHNAME)m_view->CalculatePitchCode(layer, m_view->ToLogicalY(y), element->GetDrawingX(), &oct);
         element->GetPitchInterface()->SetPname(pname);
         element->GetPitchInterface()->SetOct(oct);
+        m_doc->AddLayoutDamage(element);
 
         return true;
     }
@@ -256,6 +258,7 @@ bool EditorToolkitCMN::KeyDown(std::string &elementId, int key, bool shiftKey, b
             default: step = 0;
         }
         interface->AdjustPitchByOffset(step);
+        m_doc->AddLayoutDamage(element);
         return true;
     }
     return false;
@@ -306,6 +309,8 @@ bool EditorToolkitCMN::Insert(std::string &elementType, std::string const &start
     measure->AddChild(element);
     interface->SetStartid("#" + startid);
     interface->SetEndid("#" + endid);
+    m_doc->AddLayoutDamage(start);
+    m_doc->AddLayoutDamage(end);
 
     m_chainedId = element->GetID();
     m_editInfo.import("uuid", element->GetID());
@@ -352,6 +357,7 @@ bool EditorToolkitCMN::Insert(std::string &elementType, std::string const &start
     assert(interface);
     measure->AddChild(element);
     interface->SetStartid("#" + startid);
+    m_doc->AddLayoutDamage(start);
 
     m_chainedId = element->GetID();
     m_editInfo.import("uuid", element->GetID());
@@ -394,6 +400,7 @@ bool EditorToolkitCMN::Set(std::string &elementId, std::string const &attribute,
     else if (AttModule::SetVisual(element, attribute, value))
         success = true;
     if (success) {
+        m_doc->AddLayoutDamage(element);
         return true;
     }
     return false;
@@ -431,6 +438,8 @@ bool EditorToolkitCMN::InsertNote(Object *object)
         return false;
     }
 
+    m_doc->AddLayoutDamage(object);
+
     if (object->Is(CHORD)) {
         Chord *currentChord = vrv_cast<Chord *>(object);
         assert(currentChord);
@@ -11,6 +11,7 @@
 
 #include "layer.h"
 #include "layerelement.h"
+#include "layerelementindex.h"
 #include "staff.h"
 
 namespace vrv {
@@ -173,6 +174,15 @@ void FindSpannedLayerElementsFunctor::SetMinMaxLayerN(int minLayerN, int maxLaye
     m_maxLayerN = maxLayerN;
 }
 
+void FindSpannedLayerElementsFunctor::ProcessIndex(const LayerElementIndex &index)
+{
+    const std::vector<const LayerElement *> elements = index.FindElements(m_classIds, m_staffNs, m_minPos, m_maxPos,
+        m_interface->GetStartMeasure(), m_interface->GetEndMeasure());
+    for (const LayerElement *layerElement : elements) {
+        this->AddIfSpanned(layerElement);
+    }
+}
+
 FunctorCode FindSpannedLayerElementsFunctor::VisitLayerElement(const LayerElement *layerElement)
 {
     if (layerElement->IsScoreDefElement()) return FUNCTOR_SIBLINGS;
@@ -181,6 +191,13 @@ FunctorCode FindSpannedLayerElementsFunctor::VisitLayerElement(const LayerElemen
         return FUNCTOR_CONTINUE;
     }
 
+    this->AddIfSpanned(layerElement);
+
+    return FUNCTOR_CONTINUE;
+}
+
+void FindSpannedLayerElementsFunctor::AddIfSpanned(const LayerElement *layerElement)
+{
     if (layerElement->HasContentBB() && !layerElement->HasEmptyBB() && (layerElement->GetContentRight() > m_minPos)
         && (layerElement->GetContentLeft() < m_maxPos)) {
 
@@ -188,7 +205,7 @@ FunctorCode FindSpannedLayerElementsFunctor::VisitLayerElement(const LayerElemen
         const LayerElement *start = m_interface->GetStart();
         const LayerElement *end = m_interface->GetEnd();
         if ((layerElement == start) || (layerElement == end)) {
-            return FUNCTOR_CONTINUE;
+            return;
         }
 
         // Skip if neither parent staff nor cross staff matches the given staff number
@@ -198,7 +215,7 @@ FunctorCode FindSpannedLayerElementsFunctor::VisitLayerElement(const LayerElemen
                 const Layer *layer = NULL;
                 staff = layerElement->GetCrossStaff(layer);
                 if (!staff || (m_staffNs.find(staff->GetN()) == m_staffNs.end())) {
-                    return FUNCTOR_CONTINUE;
+                    return;
                 }
             }
         }
@@ -206,10 +223,10 @@ FunctorCode FindSpannedLayerElementsFunctor::VisitLayerElement(const LayerElemen
         // Skip if layer number is outside given bounds
         const int layerN = layerElement->GetOriginalLayerN();
         if (m_minLayerN && (m_minLayerN > layerN)) {
-            return FUNCTOR_CONTINUE;
+            return;
         }
         if (m_maxLayerN && (m_maxLayerN < layerN)) {
-            return FUNCTOR_CONTINUE;
+            return;
         }
 
         // Skip elements aligned at start/end, but on a different staff
@@ -217,21 +234,19 @@ FunctorCode FindSpannedLayerElementsFunctor::VisitLayerElement(const LayerElemen
             const Staff *staff = layerElement->GetAncestorStaff(RESOLVE_CROSS_STAFF);
             const Staff *startStaff = start->GetAncestorStaff(RESOLVE_CROSS_STAFF);
             if (staff->GetN() != startStaff->GetN()) {
-                return FUNCTOR_CONTINUE;
+                return;
             }
         }
         if ((layerElement->GetAlignment() == end->GetAlignment()) && !end->Is(TIMESTAMP_ATTR)) {
             const Staff *staff = layerElement->GetAncestorStaff(RESOLVE_CROSS_STAFF);
             const Staff *endStaff = end->GetAncestorStaff(RESOLVE_CROSS_STAFF);
             if (staff->GetN() != endStaff->GetN()) {
-                return FUNCTOR_CONTINUE;
+                return;
             }
         }
 
         m_elements.push_back(layerElement);
     }
-
-    return FUNCTOR_CONTINUE;
 }
 
 FunctorCode FindSpannedLayerElementsFunctor::VisitMeasure(const Measure *measure)
@@ -243,6 +258,36 @@ FunctorCode FindSpannedLayerElementsFunctor::VisitMeasure(const Measure *measure
     return FUNCTOR_CONTINUE;
 }
 
+//----------------------------------------------------------------------------
+// BuildLayerElementIndexFunctor
+//----------------------------------------------------------------------------
+
+BuildLayerElementIndexFunctor::BuildLayerElementIndexFunctor(LayerElementIndex *index) : ConstFunctor()
+{
+    m_index = index;
+    m_measureIdx = -1;
+}
+
+FunctorCode BuildLayerElementIndexFunctor::VisitLayerElement(const LayerElement *layerElement)
+{
+    // Same as FindSpannedLayerElementsFunctor
+    if (layerElement->IsScoreDefElement()) return FUNCTOR_SIBLINGS;
+
+    if (layerElement->HasContentBB() && !layerElement->HasEmptyBB()) {
+        m_index->AddElement(layerElement, m_measureIdx);
+    }
+
+    return FUNCTOR_CONTINUE;
+}
+
+FunctorCode BuildLayerElementIndexFunctor::VisitMeasure(const Measure *measure)
+{
+    m_index->AddMeasure(measure);
+    ++m_measureIdx;
+
+    return FUNCTOR_CONTINUE;
+}
+
 //----------------------------------------------------------------------------
 // GetRelativeLayerElementFunctor
 //----------------------------------------------------------------------------
@@ -9,6 +9,7 @@
 
 //----------------------------------------------------------------------------
 
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
 
@@ -36,6 +37,7 @@ Glyph::Glyph()
     m_unitsPerEm = 20480;
     m_codeStr = "[unset]";
     m_path = "[unset]";
+    m_embeddedXML = NULL;
     m_isFallback = false;
 }
 
@@ -48,6 +50,7 @@ Glyph::Glyph(std::string path, std::string codeStr)
     m_horizAdvX = 0;
     m_unitsPerEm = 20480;
     m_codeStr = codeStr;
+    m_embeddedXML = NULL;
     m_isFallback = false;
 
     pugi::xml_document doc;
@@ -85,6 +88,7 @@ Glyph::Glyph(int unitsPerEm)
     m_unitsPerEm = unitsPerEm * 10;
     m_codeStr = "[unset]";
     m_path = "[unset]";
+    m_embeddedXML = NULL;
 }
 
 Glyph::~Glyph() {}
@@ -144,4 +148,20 @@ const Point *Glyph::GetAnchor(SMuFLGlyphAnchor anchor) const
     return &m_anchors.at(anchor);
 }
 
+const pugi::xml_document &Glyph::GetXML() const
+{
+    // The glyph can be shared between threads - the first document stored is kept and never replaced
+    std::shared_ptr<pugi::xml_document> xml = std::atomic_load(&m_xml);
+    if (!xml) {
+        std::shared_ptr<pugi::xml_document> loaded = std::make_shared<pugi::xml_document>();
+        pugi::xml_parse_result result
+            = (m_embeddedXML) ? loaded->load_string(m_embeddedXML) : loaded->load_file(m_path.c_str());
+        if (!result) {
+            LogError("Glyph file '%s' could not be loaded", m_path.c_str());
+        }
+        if (std::atomic_compare_exchange_strong(&m_xml, &xml, loaded)) xml = loaded;
+    }
+    return *xml;
+}
+
 } // namespace vrv
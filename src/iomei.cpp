@@ -9,6 +9,7 @@
 
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -155,8 +156,145 @@
 
 namespace vrv {
 
-const std::vector<std::string> MEIInput::s_editorialElementNames = { "abbr", "add", "app", "annot", "choice", "corr",
-    "damage", "del", "expan", "orig", "ref", "reg", "restore", "sic", "subst", "supplied", "unclear" };
+const std::unordered_map<std::string_view, MEIInput::ElementReader> MEIInput::s_elementReaders = {
+    // editorial elements
+    { "abbr", { NULL, 0 } },
+    { "add", { NULL, 0 } },
+    { "annot", { NULL, 0 } },
+    { "app", { NULL, 0 } },
+    { "choice", { NULL, 0 } },
+    { "corr", { NULL, 0 } },
+    { "damage", { NULL, 0 } },
+    { "del", { NULL, 0 } },
+    { "expan", { NULL, 0 } },
+    { "orig", { NULL, 0 } },
+    { "ref", { NULL, 0 } },
+    { "reg", { NULL, 0 } },
+    { "restore", { NULL, 0 } },
+    { "sic", { NULL, 0 } },
+    { "subst", { NULL, 0 } },
+    { "supplied", { NULL, 0 } },
+    { "unclear", { NULL, 0 } },
+    // content
+    { "accid", { &MEIInput::ReadAccid, READING_LAYER } },
+    { "anchoredText", { &MEIInput::ReadAnchoredText, READING_MEASURE } },
+    { "arpeg", { &MEIInput::ReadArpeg, READING_MEASURE } },
+    { "artic", { &MEIInput::ReadArtic, READING_LAYER } },
+    { "barLine", { &MEIInput::ReadBarLine, READING_LAYER } },
+    { "beam", { &MEIInput::ReadBeam, READING_LAYER } },
+    { "beamSpan", { &MEIInput::ReadBeamSpan, READING_MEASURE } },
+    { "beatRpt", { &MEIInput::ReadBeatRpt, READING_LAYER } },
+    { "bracketSpan", { &MEIInput::ReadBracketSpan, READING_MEASURE } },
+    { "breath", { &MEIInput::ReadBreath, READING_MEASURE } },
+    { "bTrem", { &MEIInput::ReadBTrem, READING_LAYER } },
+    { "caesura", { &MEIInput::ReadCaesura, READING_MEASURE } },
+    { "chord", { &MEIInput::ReadChord, READING_LAYER } },
+    { "clef", { &MEIInput::ReadClef, READING_SCOREDEF | READING_LAYER } },
+    { "custos", { &MEIInput::ReadCustos, READING_LAYER } },
+    { "dir", { &MEIInput::ReadDir, READING_MEASURE } },
+    { "div", { &MEIInput::ReadDiv, READING_SECTION } },
+    { "divLine", { &MEIInput::ReadDivLine, READING_LAYER } },
+    { "dot", { &MEIInput::ReadDot, READING_LAYER } },
+    { "dynam", { &MEIInput::ReadDynam, READING_MEASURE } },
+    { "ending", { &MEIInput::ReadEnding, READING_SECTION } },
+    { "expansion", { &MEIInput::ReadExpansion, READING_SECTION } },
+    { "fermata", { &MEIInput::ReadFermata, READING_MEASURE } },
+    { "fing", { &MEIInput::ReadFing, READING_MEASURE } },
+    { "fTrem", { &MEIInput::ReadFTrem, READING_LAYER } },
+    { "gliss", { &MEIInput::ReadGliss, READING_MEASURE } },
+    { "graceGrp", { &MEIInput::ReadGraceGrp, READING_LAYER } },
+    { "grpSym", { &MEIInput::ReadGrpSym, READING_SCOREDEF } },
+    { "hairpin", { &MEIInput::ReadHairpin, READING_MEASURE } },
+    { "halfmRpt", { &MEIInput::ReadHalfmRpt, READING_LAYER } },
+    { "harm", { &MEIInput::ReadHarm, READING_MEASURE } },
+    { "keyAccid", { &MEIInput::ReadKeyAccid, READING_LAYER } },
+    { "keySig", { &MEIInput::ReadKeySig, READING_SCOREDEF | READING_LAYER } },
+    { "label", { &MEIInput::ReadLabel, READING_LAYER } },
+    { "labelAbbr", { &MEIInput::ReadLabelAbbr, READING_LAYER } },
+    { "layer", { &MEIInput::ReadLayer, READING_STAFF } },
+    { "ligature", { &MEIInput::ReadLigature, READING_LAYER } },
+    { "liquescent", { &MEIInput::ReadLiquescent, READING_LAYER } },
+    { "lv", { &MEIInput::ReadLv, READING_MEASURE } },
+    { "measure", { &MEIInput::ReadMeasure, READING_SECTION } },
+    { "mensur", { &MEIInput::ReadMensur, READING_SCOREDEF | READING_LAYER } },
+    { "meterSig", { &MEIInput::ReadMeterSig, READING_SCOREDEF | READING_LAYER } },
+    { "meterSigGrp", { &MEIInput::ReadMeterSigGrp, READING_SCOREDEF | READING_LAYER } },
+    { "mNum", { &MEIInput::ReadMNum, READING_MEASURE } },
+    { "mordent", { &MEIInput::ReadMordent, READING_MEASURE } },
+    { "mRest", { &MEIInput::ReadMRest, READING_LAYER } },
+    { "mRpt", { &MEIInput::ReadMRpt, READING_LAYER } },
+    { "mRpt2", { &MEIInput::ReadMRpt2, READING_LAYER } },
+    { "mSpace", { &MEIInput::ReadMSpace, READING_LAYER } },
+    { "multiRest", { &MEIInput::ReadMultiRest, READING_LAYER } },
+    { "multiRpt", { &MEIInput::ReadMultiRpt, READING_LAYER } },
+    { "nc", { &MEIInput::ReadNc, READING_LAYER } },
+    { "neume", { &MEIInput::ReadNeume, READING_LAYER } },
+    { "note", { &MEIInput::ReadNote, READING_LAYER } },
+    { "octave", { &MEIInput::ReadOctave, READING_MEASURE } },
+    { "ornam", { &MEIInput::ReadOrnam, READING_MEASURE } },
+    { "pb", { &MEIInput::ReadPb, READING_SECTION } },
+    { "pedal", { &MEIInput::ReadPedal, READING_MEASURE } },
+    { "phrase", { &MEIInput::ReadPhrase, READING_MEASURE } },
+    { "pitchInflection", { &MEIInput::ReadPitchInflection, READING_MEASURE } },
+    { "plica", { &MEIInput::ReadPlica, READING_LAYER } },
+    { "proport", { &MEIInput::ReadProport, READING_LAYER } },
+    { "reh", { &MEIInput::ReadReh, READING_MEASURE } },
+    { "repeatMark", { &MEIInput::ReadRepeatMark, READING_MEASURE } },
+    { "rest", { &MEIInput::ReadRest, READING_LAYER } },
+    { "sb", { &MEIInput::ReadSb, READING_SECTION } },
+    { "scoreDef", { &MEIInput::ReadScoreDef, READING_SECTION } },
+    { "section", { &MEIInput::ReadSection, READING_SECTION } },
+    { "slur", { &MEIInput::ReadSlur, READING_MEASURE } },
+    { "space", { &MEIInput::ReadSpace, READING_LAYER } },
+    { "staff", { &MEIInput::ReadStaff, READING_MEASURE } },
+    { "staffGrp", { &MEIInput::ReadStaffGrp, READING_SCOREDEF } },
+    { "stem", { &MEIInput::ReadStem, READING_LAYER } },
+    { "syl", { &MEIInput::ReadSyl, READING_LAYER } },
+    { "syllable", { &MEIInput::ReadSyllable, READING_LAYER } },
+    { "symbolTable", { &MEIInput::ReadSymbolTable, READING_SCOREDEF } },
+    { "tabDurSym", { &MEIInput::ReadTabDurSym, READING_LAYER } },
+    { "tabGrp", { &MEIInput::ReadTabGrp, READING_LAYER } },
+    { "tempo", { &MEIInput::ReadTempo, READING_MEASURE } },
+    { "tie", { &MEIInput::ReadTie, READING_MEASURE } },
+    { "trill", { &MEIInput::ReadTrill, READING_MEASURE } },
+    { "tuplet", { &MEIInput::ReadTuplet, READING_LAYER } },
+    { "turn", { &MEIInput::ReadTurn, READING_MEASURE } },
+    { "verse", { &MEIInput::ReadVerse, READING_LAYER } }
+};
+
+const std::unordered_map<ClassId, std::vector<std::string_view>> MEIInput::s_allowedChildren = {
+    { ANNOT, {} },
+    { BEAM, { "beam", "bTrem", "chord", "clef", "graceGrp", "note", "rest", "space", "tabGrp", "tuplet" } },
+    { BTREM, { "chord", "clef", "note" } },
+    { CHORD, { "note", "artic", "verse" } },
+    { CUSTOS, { "accid" } },
+    { DIR, { "lb", "rend", "symbol" } },
+    { DYNAM, { "lb", "rend" } },
+    { FIG, { "svg" } },
+    { FIGURE, {} },
+    { FTREM, { "chord", "clef", "note" } },
+    { GRACEGRP, { "beam", "chord", "note", "rest", "space" } },
+    { HARM, { "rend", "fb" } },
+    { KEYSIG, { "keyAccid" } },
+    { LABEL, { "lb", "rend" } },
+    { LABELABBR, { "lb", "rend" } },
+    { LIGATURE, { "dot", "note" } },
+    { NC, { "liquescent" } },
+    { NEUME, { "nc" } },
+    { NOTE, { "accid", "artic", "plica", "stem", "syl", "verse" } },
+    { NUM, {} },
+    { ORNAM, { "lb", "rend", "symbol" } },
+    { REND, { "lb", "num", "rend", "symbol" } },
+    { REPEATMARK, { "lb", "rend", "symbol" } },
+    { REST, {} },
+    { SYL, { "rend" } },
+    { SYLLABLE, { "accid", "clef", "divLine", "neume", "syl" } },
+    { TABGRP, { "tabDurSym", "note" } },
+    { TEMPO, { "lb", "rend", "symbol" } },
+    { TUNING, { "course" } },
+    { TUPLET, { "beam", "bTrem", "chord", "clef", "fTrem", "note", "rest", "space", "tabGrp", "tuplet" } },
+    { VERSE, { "label", "labelAbbr", "syl" } }
+};
 
 //----------------------------------------------------------------------------
 // MEIOutput
@@ -3369,7 +3507,25 @@ bool MEIInput::Import(const std::string &mei)
     }
 }
 
-bool MEIInput::IsAllowed(std::string element, Object *filterParent)
+bool MEIInput::ImportInPlace(char *mei, size_t size)
+{
+    try {
+        m_doc->Reset();
+        m_doc->SetType(Raw);
+        pugi::xml_document doc;
+        // The nodes point to the buffer instead of a copy owned by the document
+        doc.load_buffer_inplace(
+            mei, size, (pugi::parse_comments | pugi::parse_default) & ~pugi::parse_eol, pugi::encoding_utf8);
+        pugi::xml_node root = doc.first_child();
+        return this->ReadDoc(root);
+    }
+    catch (char *str) {
+        LogError("%s", str);
+        return false;
+    }
+}
+
+bool MEIInput::IsAllowed(std::string_view element, Object *filterParent)
 {
     if (!filterParent || (element == "")) {
         return true;
@@ -3378,461 +3534,31 @@ bool MEIInput::IsAllowed(std::string element, Object *filterParent)
     // editorial
     if (this->IsEditorialElementName(element)) {
         // Because of the Clone issue on annot do not support it in label and labelAbbr
-        if (filterParent->Is(LABEL) && (element == "annot")) {
-            return false;
-        }
-        else if (filterParent->Is(LABELABBR) && (element == "annot")) {
-            return false;
-        }
-        else {
-            return true;
-        }
-    }
-    // filter for annot
-    else if (filterParent->Is(ANNOT)) {
-        if (element == "") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for dynam
-    else if (filterParent->Is(DYNAM)) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "lb") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-        else {
-            return false;
-        }
+        return (!filterParent->Is({ LABEL, LABELABBR }) || (element != "annot"));
     }
-    // filter for dir or tempo
-    else if (filterParent->Is({ DIR, ORNAM, REPEATMARK, TEMPO })) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "lb") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-        else if (element == "symbol") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    else if (filterParent->Is(FIG)) {
-        if (element == "svg") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    else if (filterParent->Is(FIGURE)) {
-        if (element == "") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    else if (filterParent->Is(NUM)) {
-        if (element == "") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for harm
-    else if (filterParent->Is(HARM)) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-        else if (element == "fb") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for rend
-    else if (filterParent->Is(REND)) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "lb") {
-            return true;
-        }
-        else if (element == "num") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-        else if (element == "symbol") {
-            return true;
-        }
-        else {
-            return false;
-        }
+
+    static const std::vector<std::string_view> controlElementChildren = { "rend" };
+    static const std::vector<std::string_view> runningElementChildren = { "fig", "rend" };
+
+    const std::vector<std::string_view> *allowed = NULL;
+    auto iter = s_allowedChildren.find(filterParent->GetClassId());
+    if (iter != s_allowedChildren.end()) {
+        allowed = &iter->second;
     }
     // filter for any other control element
     else if (filterParent->IsControlElement()) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-        else {
-            return false;
-        }
+        allowed = &controlElementChildren;
     }
-    // filter for any other control element
+    // filter for running elements and div
     else if (filterParent->IsRunningElement() || filterParent->Is(DIV)) {
-        if (element == "fig") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for beam
-    else if (filterParent->Is(BEAM)) {
-        if (element == "beam") {
-            return true;
-        }
-        else if (element == "bTrem") {
-            return true;
-        }
-        else if (element == "chord") {
-            return true;
-        }
-        else if (element == "clef") {
-            return true;
-        }
-        else if (element == "graceGrp") {
-            return true;
-        }
-        else if (element == "note") {
-            return true;
-        }
-        else if (element == "rest") {
-            return true;
-        }
-        else if (element == "space") {
-            return true;
-        }
-        else if (element == "tabGrp") {
-            return true;
-        }
-        else if (element == "tuplet") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for bTrem
-    else if (filterParent->Is(BTREM)) {
-        if (element == "chord") {
-            return true;
-        }
-        else if (element == "clef") {
-            return true;
-        }
-        else if (element == "note") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for chord
-    else if (filterParent->Is(CHORD)) {
-        if (element == "note") {
-            return true;
-        }
-        else if (element == "artic") {
-            return true;
-        }
-        else if (element == "verse") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for custos
-    else if (filterParent->Is(CUSTOS)) {
-        if (element == "accid") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for fTrem
-    else if (filterParent->Is(FTREM)) {
-        if (element == "chord") {
-            return true;
-        }
-        else if (element == "clef") {
-            return true;
-        }
-        else if (element == "note") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for graceGrp
-    else if (filterParent->Is(GRACEGRP)) {
-        if (element == "beam") {
-            return true;
-        }
-        else if (element == "chord") {
-            return true;
-        }
-        else if (element == "note") {
-            return true;
-        }
-        else if (element == "rest") {
-            return true;
-        }
-        else if (element == "space") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for keySig
-    else if (filterParent->Is(KEYSIG)) {
-        if (element == "keyAccid") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for label
-    else if (filterParent->Is(LABEL)) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "lb") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-
-        else {
-            return false;
-        }
-    }
-    // filter for label
-    else if (filterParent->Is(LABELABBR)) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "lb") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-
-        else {
-            return false;
-        }
-    }
-    // filter for ligature
-    else if (filterParent->Is(LIGATURE)) {
-        if (element == "dot") {
-            return true;
-        }
-        else if (element == "note") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for neume
-    else if (filterParent->Is(NEUME)) {
-        if (element == "nc") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for nc
-    else if (filterParent->Is(NC)) {
-        if (element == "liquescent") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for note
-    else if (filterParent->Is(NOTE)) {
-        if (element == "accid") {
-            return true;
-        }
-        else if (element == "artic") {
-            return true;
-        }
-        else if (element == "plica") {
-            return true;
-        }
-        else if (element == "stem") {
-            return true;
-        }
-        else if (element == "syl") {
-            return true;
-        }
-        else if (element == "verse") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for rest
-    else if (filterParent->Is(REST)) {
-        return false;
-    }
-    // filter for syllable
-    else if (filterParent->Is(SYLLABLE)) {
-        if (element == "accid") {
-            return true;
-        }
-        else if (element == "clef") {
-            return true;
-        }
-        else if (element == "divLine") {
-            return true;
-        }
-        else if (element == "neume") {
-            return true;
-        }
-        else if (element == "syl") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for syl
-    else if (filterParent->Is(SYL)) {
-        if (element == "") {
-            return true;
-        }
-        else if (element == "rend") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for tabGrp
-    else if (filterParent->Is(TABGRP)) {
-        if (element == "tabDurSym") {
-            return true;
-        }
-        if (element == "note") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for tuplet
-    else if (filterParent->Is(TUPLET)) {
-        if (element == "beam") {
-            return true;
-        }
-        else if (element == "bTrem") {
-            return true;
-        }
-        else if (element == "chord") {
-            return true;
-        }
-        else if (element == "clef") {
-            return true;
-        }
-        else if (element == "fTrem") {
-            return true;
-        }
-        else if (element == "note") {
-            return true;
-        }
-        else if (element == "rest") {
-            return true;
-        }
-        else if (element == "space") {
-            return true;
-        }
-        else if (element == "tabGrp") {
-            return true;
-        }
-        else if (element == "tuplet") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for tunning
-    else if (filterParent->Is(TUNING)) {
-        if (element == "course") {
-            return true;
-        }
-        else {
-            return false;
-        }
-    }
-    // filter for verse
-    else if (filterParent->Is(VERSE)) {
-        if (element == "label") {
-            return true;
-        }
-        else if (element == "labelAbbr") {
-            return true;
-        }
-        else if (element == "syl") {
-            return true;
-        }
-        else {
-            return false;
-        }
+        allowed = &runningElementChildren;
     }
     else {
         LogDebug("Unknown filter for '%s'", filterParent->GetClassName().c_str());
         return true;
     }
+
+    return (std::find(allowed->begin(), allowed->end(), element) != allowed->end());
 }
 
 bool MEIInput::ReadDoc(pugi::xml_node root)
@@ -3898,8 +3624,8 @@ bool MEIInput::ReadDoc(pugi::xml_node root)
         this->ReadFacsimile(m_doc, facsimile);
         if (m_doc->GetOptions()->m_useFacsimile.GetValue()) {
             m_doc->SetType(Facs);
-            m_doc->m_drawingPageHeight = m_doc->GetFacsimile()->GetMaxY();
-            m_doc->m_drawingPageWidth = m_doc->GetFacsimile()->GetMaxX();
+            m_doc->GetDrawingContext().m_drawingPageHeight = m_doc->GetFacsimile()->GetMaxY();
+            m_doc->GetDrawingContext().m_drawingPageWidth = m_doc->GetFacsimile()->GetMaxX();
         }
         if (facsimile.next_sibling("facsimile")) {
             LogWarning("Only first <facsimile> is processed");
@@ -4408,37 +4134,14 @@ bool MEIInput::ReadSectionChildren(Object *parent, pugi::xml_node parentNode)
     for (current = parentNode.first_child(); current; current = current.next_sibling()) {
         if (!success) break;
         this->NormalizeAttributes(current);
+        const std::string_view currentName = current.name();
+        const ElementReader *reader = this->FindElementReader(currentName);
         // editorial
-        if (this->IsEditorialElementName(current.name())) {
+        if (reader && !reader->m_method) {
             success = this->ReadEditorialElement(parent, current, EDITORIAL_TOPLEVEL);
         }
-        // content
-        else if (std::string(current.name()) == "div") {
-            success = this->ReadDiv(parent, current);
-        }
-        else if (std::string(current.name()) == "ending") {
-            // we should not have endings with unmeasured music ... (?)
-            assert(!unmeasured);
-            success = this->ReadEnding(parent, current);
-        }
-        else if (std::string(current.name()) == "expansion") {
-            success = this->ReadExpansion(parent, current);
-        }
-        else if (std::string(current.name()) == "scoreDef") {
-            success = this->ReadScoreDef(parent, current);
-        }
-        else if (std::string(current.name()) == "section") {
-            success = this->ReadSection(parent, current);
-        }
-        // pb and sb
-        else if (std::string(current.name()) == "pb") {
-            success = this->ReadPb(parent, current);
-        }
-        else if (std::string(current.name()) == "sb") {
-            success = this->ReadSb(parent, current);
-        }
         // unmeasured music
-        else if (std::string(current.name()) == "staff") {
+        else if (currentName == "staff") {
             if (!unmeasured) {
                 if (parent->Is(SECTION)) {
                     unmeasured = new Measure(false);
@@ -4452,16 +4155,14 @@ bool MEIInput::ReadSectionChildren(Object *parent, pugi::xml_node parentNode)
             }
             success = this->ReadStaff(unmeasured, current);
         }
-        else if (std::string(current.name()) == "measure") {
-            // we should not mix measured and unmeasured music within a system...
-            assert(!unmeasured);
-            // if (parent->IsEditorialElement()) {
-            //    m_hasMeasureWithinEditMarkup = true;
-            //}
-            success = this->ReadMeasure(parent, current);
+        // content, including pb and sb
+        else if (reader && (reader->m_contexts & READING_SECTION)) {
+            // we should not mix measured and unmeasured music within a system, nor have endings with it ... (?)
+            assert(!unmeasured || ((currentName != "measure") && (currentName != "ending")));
+            success = (this->*reader->m_method)(parent, current);
         }
         // xml comment
-        else if (std::string(current.name()) == "") {
+        else if (currentName.empty()) {
             success = this->ReadXMLComment(parent, current);
         }
         else {
@@ -4819,64 +4520,31 @@ bool MEIInput::ReadScoreDefChildren(Object *parent, pugi::xml_node parentNode)
     for (current = parentNode.first_child(); current; current = current.next_sibling()) {
         if (!success) break;
         this->NormalizeAttributes(current);
+        const std::string_view currentName = current.name();
+        const ElementReader *reader = this->FindElementReader(currentName);
         // editorial
-        if (this->IsEditorialElementName(current.name())) {
+        if (reader && !reader->m_method) {
             success = this->ReadEditorialElement(parent, current, EDITORIAL_SCOREDEF);
         }
-        // clef, keySig, etc.
-        else if (std::string(current.name()) == "clef") {
-            success = this->ReadClef(parent, current);
-        }
-        else if (std::string(current.name()) == "grpSym") {
-            success = this->ReadGrpSym(parent, current);
-        }
-        else if (std::string(current.name()) == "keySig") {
-            success = this->ReadKeySig(parent, current);
-        }
-        else if (std::string(current.name()) == "mensur") {
-            success = this->ReadMensur(parent, current);
-        }
-        else if (std::string(current.name()) == "meterSig") {
-            success = this->ReadMeterSig(parent, current);
-        }
-        else if (std::string(current.name()) == "meterSigGrp") {
-            success = this->ReadMeterSigGrp(parent, current);
-        }
         // headers and footers
-        else if (std::string(current.name()) == "pgFoot") {
+        else if ((currentName == "pgFoot") || (currentName == "pgFoot2")) {
             if (m_meiversion <= meiVersion_MEIVERSION_5_0_0_dev) {
                 UpgradePgHeadFootTo_5_0_0(current);
             }
             success = this->ReadPgFoot(parent, current);
         }
-        else if (std::string(current.name()) == "pgFoot2") {
-            if (m_meiversion <= meiVersion_MEIVERSION_5_0_0_dev) {
-                UpgradePgHeadFootTo_5_0_0(current);
-            }
-            success = this->ReadPgFoot(parent, current);
-        }
-        else if (std::string(current.name()) == "pgHead") {
-            if (m_meiversion <= meiVersion_MEIVERSION_5_0_0_dev) {
-                UpgradePgHeadFootTo_5_0_0(current);
-            }
-            success = this->ReadPgHead(parent, current);
-        }
-        else if (std::string(current.name()) == "pgHead2") {
+        else if ((currentName == "pgHead") || (currentName == "pgHead2")) {
             if (m_meiversion <= meiVersion_MEIVERSION_5_0_0_dev) {
                 UpgradePgHeadFootTo_5_0_0(current);
             }
             success = this->ReadPgHead(parent, current);
         }
-        // symbolTable
-        else if (std::string(current.name()) == "symbolTable") {
-            success = this->ReadSymbolTable(parent, current);
-        }
-        // content
-        else if (std::string(current.name()) == "staffGrp") {
-            success = this->ReadStaffGrp(parent, current);
+        // clef, keySig, etc., symbolTable and staffGrp
+        else if (reader && (reader->m_contexts & READING_SCOREDEF)) {
+            success = (this->*reader->m_method)(parent, current);
         }
         // xml comment
-        else if (std::string(current.name()) == "") {
+        else if (currentName.empty()) {
             success = this->ReadXMLComment(parent, current);
         }
         else {
@@ -5370,100 +5038,17 @@ bool MEIInput::ReadMeasureChildren(Object *parent, pugi::xml_node parentNode)
     bool success = true;
     pugi::xml_node current;
     for (current = parentNode.first_child(); current; current = current.next_sibling()) {
-        const std::string currentName = current.name();
+        const std::string_view currentName = current.name();
         if (!success) break;
         this->NormalizeAttributes(current);
+        const ElementReader *reader = this->FindElementReader(currentName);
         // editorial
-        if (this->IsEditorialElementName(currentName)) {
+        if (reader && !reader->m_method) {
             success = this->ReadEditorialElement(parent, current, EDITORIAL_MEASURE);
         }
         // content
-        else if (currentName == "anchoredText") {
-            success = this->ReadAnchoredText(parent, current);
-        }
-        else if (currentName == "arpeg") {
-            success = this->ReadArpeg(parent, current);
-        }
-        else if (currentName == "beamSpan") {
-            success = this->ReadBeamSpan(parent, current);
-        }
-        else if (currentName == "bracketSpan") {
-            success = this->ReadBracketSpan(parent, current);
-        }
-        else if (currentName == "breath") {
-            success = this->ReadBreath(parent, current);
-        }
-        else if (currentName == "caesura") {
-            success = this->ReadCaesura(parent, current);
-        }
-        else if (currentName == "dir") {
-            success = this->ReadDir(parent, current);
-        }
-        else if (currentName == "dynam") {
-            success = this->ReadDynam(parent, current);
-        }
-        else if (currentName == "fermata") {
-            success = this->ReadFermata(parent, current);
-        }
-        else if (currentName == "fing") {
-            success = this->ReadFing(parent, current);
-        }
-        else if (currentName == "gliss") {
-            success = this->ReadGliss(parent, current);
-        }
-        else if (currentName == "hairpin") {
-            success = this->ReadHairpin(parent, current);
-        }
-        else if (currentName == "harm") {
-            success = this->ReadHarm(parent, current);
-        }
-        else if (currentName == "lv") {
-            success = this->ReadLv(parent, current);
-        }
-        else if (currentName == "mNum") {
-            success = this->ReadMNum(parent, current);
-        }
-        else if (currentName == "mordent") {
-            success = this->ReadMordent(parent, current);
-        }
-        else if (currentName == "octave") {
-            success = this->ReadOctave(parent, current);
-        }
-        else if (currentName == "ornam") {
-            success = this->ReadOrnam(parent, current);
-        }
-        else if (currentName == "pedal") {
-            success = this->ReadPedal(parent, current);
-        }
-        else if (currentName == "phrase") {
-            success = this->ReadPhrase(parent, current);
-        }
-        else if (currentName == "pitchInflection") {
-            success = this->ReadPitchInflection(parent, current);
-        }
-        else if (currentName == "reh") {
-            success = this->ReadReh(parent, current);
-        }
-        else if (currentName == "repeatMark") {
-            success = this->ReadRepeatMark(parent, current);
-        }
-        else if (currentName == "slur") {
-            success = this->ReadSlur(parent, current);
-        }
-        else if (currentName == "staff") {
-            success = this->ReadStaff(parent, current);
-        }
-        else if (currentName == "tempo") {
-            success = this->ReadTempo(parent, current);
-        }
-        else if (currentName == "tie") {
-            success = this->ReadTie(parent, current);
-        }
-        else if (currentName == "trill") {
-            success = this->ReadTrill(parent, current);
-        }
-        else if (currentName == "turn") {
-            success = this->ReadTurn(parent, current);
+        else if (reader && (reader->m_contexts & READING_MEASURE)) {
+            success = (this->*reader->m_method)(parent, current);
         }
         else if (currentName == "tupletSpan") {
             if (!ReadTupletSpanAsTuplet(dynamic_cast<Measure *>(parent), current)) {
@@ -5471,7 +5056,7 @@ bool MEIInput::ReadMeasureChildren(Object *parent, pugi::xml_node parentNode)
             }
         }
         // xml comment
-        else if (currentName == "") {
+        else if (currentName.empty()) {
             success = this->ReadXMLComment(parent, current);
         }
         else {
@@ -6070,16 +5655,18 @@ bool MEIInput::ReadStaffChildren(Object *parent, pugi::xml_node parentNode)
     for (current = parentNode.first_child(); current; current = current.next_sibling()) {
         if (!success) break;
         this->NormalizeAttributes(current);
+        const std::string_view currentName = current.name();
+        const ElementReader *reader = this->FindElementReader(currentName);
         // editorial
-        if (this->IsEditorialElementName(current.name())) {
+        if (reader && !reader->m_method) {
             success = this->ReadEditorialElement(parent, current, EDITORIAL_STAFF);
         }
         // content
-        else if (std::string(current.name()) == "layer") {
-            success = this->ReadLayer(parent, current);
+        else if (reader && (reader->m_contexts & READING_STAFF)) {
+            success = (this->*reader->m_method)(parent, current);
         }
         // xml comment
-        else if (std::string(current.name()) == "") {
+        else if (currentName.empty()) {
             success = this->ReadXMLComment(parent, current);
         }
         else {
@@ -6115,12 +5702,11 @@ bool MEIInput::ReadLayerChildren(Object *parent, pugi::xml_node parentNode, Obje
 {
     bool success = true;
     pugi::xml_node xmlElement;
-    std::string elementName;
     for (xmlElement = parentNode.first_child(); xmlElement; xmlElement = xmlElement.next_sibling()) {
         if (!success) break;
         this->NormalizeAttributes(xmlElement);
 
-        elementName = std::string(xmlElement.name());
+        const std::string_view elementName = xmlElement.name();
         // LogDebug("ReadLayerChildren: element <%s>", xmlElement.name());
         if (!this->IsAllowed(elementName, filter)) {
             std::string meiElementName = filter->GetClassName();
@@ -6129,142 +5715,17 @@ bool MEIInput::ReadLayerChildren(Object *parent, pugi::xml_node parentNode, Obje
                 meiElementName.c_str());
             continue;
         }
+        const ElementReader *reader = this->FindElementReader(elementName);
         // editorial
-        else if (this->IsEditorialElementName(xmlElement.name())) {
+        if (reader && !reader->m_method) {
             success = this->ReadEditorialElement(parent, xmlElement, EDITORIAL_LAYER, filter);
         }
         // content
-        else if (elementName == "accid") {
-            success = this->ReadAccid(parent, xmlElement);
-        }
-        else if (elementName == "artic") {
-            success = this->ReadArtic(parent, xmlElement);
-        }
-        else if (elementName == "barLine") {
-            success = this->ReadBarLine(parent, xmlElement);
-        }
-        else if (elementName == "beam") {
-            success = this->ReadBeam(parent, xmlElement);
-        }
-        else if (elementName == "beatRpt") {
-            success = this->ReadBeatRpt(parent, xmlElement);
-        }
-        else if (elementName == "bTrem") {
-            success = this->ReadBTrem(parent, xmlElement);
-        }
-        else if (elementName == "chord") {
-            success = this->ReadChord(parent, xmlElement);
-        }
-        else if (elementName == "clef") {
-            success = this->ReadClef(parent, xmlElement);
-        }
-        else if (elementName == "custos") {
-            success = this->ReadCustos(parent, xmlElement);
-        }
-        else if (elementName == "divLine") {
-            success = this->ReadDivLine(parent, xmlElement);
-        }
-        else if (elementName == "dot") {
-            success = this->ReadDot(parent, xmlElement);
-        }
-        else if (elementName == "fTrem") {
-            success = this->ReadFTrem(parent, xmlElement);
-        }
-        else if (elementName == "graceGrp") {
-            success = this->ReadGraceGrp(parent, xmlElement);
-        }
-        else if (elementName == "halfmRpt") {
-            success = this->ReadHalfmRpt(parent, xmlElement);
-        }
-        else if (elementName == "keyAccid") {
-            success = this->ReadKeyAccid(parent, xmlElement);
-        }
-        else if (elementName == "keySig") {
-            success = this->ReadKeySig(parent, xmlElement);
-        }
-        else if (elementName == "label") {
-            success = this->ReadLabel(parent, xmlElement);
-        }
-        else if (elementName == "labelAbbr") {
-            success = this->ReadLabelAbbr(parent, xmlElement);
-        }
-        else if (elementName == "ligature") {
-            success = this->ReadLigature(parent, xmlElement);
-        }
-        else if (elementName == "liquescent") {
-            success = this->ReadLiquescent(parent, xmlElement);
-        }
-        else if (elementName == "mensur") {
-            success = this->ReadMensur(parent, xmlElement);
-        }
-        else if (elementName == "meterSig") {
-            success = this->ReadMeterSig(parent, xmlElement);
-        }
-        else if (elementName == "meterSigGrp") {
-            success = this->ReadMeterSigGrp(parent, xmlElement);
-        }
-        else if (elementName == "nc") {
-            success = this->ReadNc(parent, xmlElement);
-        }
-        else if (elementName == "neume") {
-            success = this->ReadNeume(parent, xmlElement);
-        }
-        else if (elementName == "note") {
-            success = this->ReadNote(parent, xmlElement);
-        }
-        else if (elementName == "rest") {
-            success = this->ReadRest(parent, xmlElement);
-        }
-        else if (elementName == "mRest") {
-            success = this->ReadMRest(parent, xmlElement);
-        }
-        else if (elementName == "mRpt") {
-            success = this->ReadMRpt(parent, xmlElement);
-        }
-        else if (elementName == "mRpt2") {
-            success = this->ReadMRpt2(parent, xmlElement);
-        }
-        else if (elementName == "mSpace") {
-            success = this->ReadMSpace(parent, xmlElement);
-        }
-        else if (elementName == "multiRest") {
-            success = this->ReadMultiRest(parent, xmlElement);
-        }
-        else if (elementName == "multiRpt") {
-            success = this->ReadMultiRpt(parent, xmlElement);
-        }
-        else if (elementName == "plica") {
-            success = this->ReadPlica(parent, xmlElement);
-        }
-        else if (elementName == "proport") {
-            success = this->ReadProport(parent, xmlElement);
-        }
-        else if (elementName == "space") {
-            success = this->ReadSpace(parent, xmlElement);
-        }
-        else if (elementName == "stem") {
-            success = this->ReadStem(parent, xmlElement);
-        }
-        else if (elementName == "syl") {
-            success = this->ReadSyl(parent, xmlElement);
-        }
-        else if (elementName == "syllable") {
-            success = this->ReadSyllable(parent, xmlElement);
-        }
-        else if (elementName == "tabDurSym") {
-            success = this->ReadTabDurSym(parent, xmlElement);
-        }
-        else if (elementName == "tabGrp") {
-            success = this->ReadTabGrp(parent, xmlElement);
-        }
-        else if (elementName == "tuplet") {
-            success = this->ReadTuplet(parent, xmlElement);
-        }
-        else if (elementName == "verse") {
-            success = this->ReadVerse(parent, xmlElement);
+        else if (reader && (reader->m_contexts & READING_LAYER)) {
+            success = (this->*reader->m_method)(parent, xmlElement);
         }
         // xml comment
-        else if (elementName == "") {
+        else if (elementName.empty()) {
             success = this->ReadXMLComment(parent, xmlElement);
         }
         // unknown
@@ -7445,7 +6906,7 @@ bool MEIInput::ReadEditorialElement(Object *parent, pugi::xml_node current, Edit
         return this->ReadUnclear(parent, current, level, filter);
     }
     else {
-        assert(false); // this should never happen, MEIInput::s_editorialElementNames should be updated
+        assert(false); // this should never happen, MEIInput::s_elementReaders should be updated
         return false;
     }
 }
@@ -8111,17 +7572,25 @@ bool MEIInput::ReadXMLComment(Object *object, pugi::xml_node element)
     return true;
 }
 
-bool MEIInput::IsEditorialElementName(std::string elementName)
+bool MEIInput::IsEditorialElementName(std::string_view elementName)
 {
-    auto i = std::find(MEIInput::s_editorialElementNames.begin(), MEIInput::s_editorialElementNames.end(), elementName);
-    if (i != MEIInput::s_editorialElementNames.end()) return true;
-    return false;
+    const ElementReader *reader = this->FindElementReader(elementName);
+    return (reader && !reader->m_method);
+}
+
+const MEIInput::ElementReader *MEIInput::FindElementReader(std::string_view elementName) const
+{
+    auto it = s_elementReaders.find(elementName);
+    return (it != s_elementReaders.end()) ? &it->second : NULL;
 }
 
 void MEIInput::NormalizeAttributes(pugi::xml_node &xmlElement)
 {
     for (auto elem : xmlElement.attributes()) {
-        std::string name = elem.name();
+        // Most values have nothing to trim and do not need to be copied and set again
+        const std::string_view view = elem.value();
+        if (view.empty() || ((view.front() != ' ') && (view.back() != ' '))) continue;
+
         std::string value = elem.value();
 
         size_t pos = value.find_first_not_of(' ');
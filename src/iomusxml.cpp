@@ -10,6 +10,7 @@
 //----------------------------------------------------------------------------
 
 #include <cassert>
+#include <climits>
 #include <numeric>
 #include <regex>
 #include <sstream>
@@ -107,7 +108,11 @@ enum class MetronomeElements { BEAT_UNIT, BEAT_UNIT_DOT, PER_MINUTE, SEPARATOR }
 // MusicXmlInput
 //----------------------------------------------------------------------------
 
-MusicXmlInput::MusicXmlInput(Doc *doc) : Input(doc) {}
+MusicXmlInput::MusicXmlInput(Doc *doc) : Input(doc)
+{
+    m_sectionMeasureCount = 0;
+    m_isFirstPart = false;
+}
 
 MusicXmlInput::~MusicXmlInput()
 {
@@ -153,7 +158,7 @@ bool MusicXmlInput::IsElement(const pugi::xml_node node, const std::string &name
 {
     assert(node);
 
-    if (std::string(node.name()) == name) {
+    if (name == node.name()) {
         return true;
     }
     return false;
@@ -188,13 +193,132 @@ std::string MusicXmlInput::GetContentOfChild(const pugi::xml_node node, const st
     return "";
 }
 
+pugi::xml_node MusicXmlInput::GetPrintedChild(const pugi::xml_node node, const std::string &name) const
+{
+    for (pugi::xml_node child : node.children(name.c_str())) {
+        if (!HasAttributeWithValue(child, "print-object", "no")) return child;
+    }
+    return pugi::xml_node();
+}
+
+pugi::xml_node MusicXmlInput::GetChildWithoutAttribute(
+    const pugi::xml_node node, const std::string &name, const std::string &attribute) const
+{
+    for (pugi::xml_node child : node.children(name.c_str())) {
+        if (!child.attribute(attribute.c_str())) return child;
+    }
+    return pugi::xml_node();
+}
+
+pugi::xml_node MusicXmlInput::GetGrandChild(
+    const pugi::xml_node node, const std::string &child, const std::string &grandChild) const
+{
+    for (pugi::xml_node childNode : node.children(child.c_str())) {
+        pugi::xml_node grandChildNode = childNode.child(grandChild.c_str());
+        if (grandChildNode) return grandChildNode;
+    }
+    return pugi::xml_node();
+}
+
+pugi::xml_node MusicXmlInput::GetGrandChildWithAttribute(const pugi::xml_node node, const std::string &child,
+    const std::string &grandChild, const std::string &attribute, const std::string &value) const
+{
+    for (pugi::xml_node childNode : node.children(child.c_str())) {
+        for (pugi::xml_node grandChildNode : childNode.children(grandChild.c_str())) {
+            if (HasAttributeWithValue(grandChildNode, attribute, value)) return grandChildNode;
+        }
+    }
+    return pugi::xml_node();
+}
+
+pugi::xml_node MusicXmlInput::GetGrandChildContaining(
+    const pugi::xml_node node, const std::string &child, const std::vector<std::string> &parts) const
+{
+    for (pugi::xml_node childNode : node.children(child.c_str())) {
+        for (pugi::xml_node grandChildNode : childNode.children()) {
+            if (grandChildNode.type() != pugi::node_element) continue;
+            for (const std::string &part : parts) {
+                if (std::strstr(grandChildNode.name(), part.c_str())) return grandChildNode;
+            }
+        }
+    }
+    return pugi::xml_node();
+}
+
+std::vector<pugi::xml_node> MusicXmlInput::GetGrandChildren(
+    const pugi::xml_node node, const std::string &child, const std::vector<std::string> &names) const
+{
+    std::vector<pugi::xml_node> grandChildren;
+    for (pugi::xml_node childNode : node.children(child.c_str())) {
+        for (pugi::xml_node grandChildNode : childNode.children()) {
+            if (grandChildNode.type() != pugi::node_element) continue;
+            if (std::find(names.begin(), names.end(), grandChildNode.name()) != names.end()) {
+                grandChildren.push_back(grandChildNode);
+            }
+        }
+    }
+    return grandChildren;
+}
+
+pugi::xml_node MusicXmlInput::GetBeamWithValue(const pugi::xml_node node, const std::string &value, int number) const
+{
+    for (pugi::xml_node beam : node.children("beam")) {
+        if (number && !HasAttributeWithValue(beam, "number", std::to_string(number))) continue;
+        if (HasContentWithValue(beam, value)) return beam;
+    }
+    return pugi::xml_node();
+}
+
+void MusicXmlInput::CollectClosedEndings(const pugi::xml_node root)
+{
+    // Equivalent to following::ending[@number='n'][@type != 'start'] for each ending start, but in a single pass
+    // over the barlines in reverse document order
+    std::vector<pugi::xml_node> barLines;
+    for (pugi::xml_node part : root.children("part")) {
+        for (pugi::xml_node measure : part.children("measure")) {
+            for (pugi::xml_node barLine : measure.children("barline")) {
+                if (barLine.child("ending")) barLines.push_back(barLine);
+            }
+        }
+    }
+
+    std::set<std::string> closingNumbers;
+    for (auto iter = barLines.rbegin(); iter != barLines.rend(); ++iter) {
+        for (pugi::xml_node ending : iter->children("ending")) {
+            if (HasAttributeWithValue(ending, "type", "start")
+                && closingNumbers.count(ending.attribute("number").as_string())) {
+                m_closedEndings.insert(ending);
+            }
+        }
+        // Endings in the same barline do not follow each other
+        for (pugi::xml_node ending : iter->children("ending")) {
+            if (ending.attribute("number") && ending.attribute("type")
+                && !HasAttributeWithValue(ending, "type", "start")) {
+                closingNumbers.insert(ending.attribute("number").as_string());
+            }
+        }
+    }
+}
+
+void MusicXmlInput::AddSectionMeasure(Section *section, Measure *measure)
+{
+    section->AddChild(measure);
+    m_sectionMeasures[measure->GetN()].push_back(measure);
+    ++m_sectionMeasureCount;
+}
+
+Measure *MusicXmlInput::GetSectionMeasure(const std::string &measureNum) const
+{
+    const auto iter = m_sectionMeasures.find(measureNum);
+    return (iter != m_sectionMeasures.end()) ? iter->second.front() : NULL;
+}
+
 void MusicXmlInput::ProcessClefChangeQueue(Section *section)
 {
     while (!m_clefChangeQueue.empty()) {
         musicxml::ClefChange clefChange = m_clefChangeQueue.front();
         m_clefChangeQueue.pop();
-        AttNNumberLikeComparison comparisonMeasure(MEASURE, clefChange.m_measureNum);
-        Measure *currentMeasure = vrv_cast<Measure *>(section->FindDescendantByComparison(&comparisonMeasure));
+        Measure *currentMeasure = this->GetSectionMeasure(clefChange.m_measureNum);
         if (!currentMeasure) {
             LogWarning("MusicXML import: Clef change at measure %s, staff %d, time %d not inserted",
                 clefChange.m_measureNum.c_str(), clefChange.m_staff->GetN(), clefChange.m_scoreOnset);
@@ -354,27 +478,24 @@ void MusicXmlInput::AddMeasure(Section *section, Measure *measure, int i)
     Measure *contentMeasure = NULL;
 
     // we just need to add a measure
-    if (section->GetChildCount(MEASURE) <= i - GetMrestMeasuresCountBeforeIndex(i)) {
-        section->AddChild(measure);
+    if (m_sectionMeasureCount <= i - GetMrestMeasuresCountBeforeIndex(i)) {
+        this->AddSectionMeasure(section, measure);
         contentMeasure = measure;
     }
     // otherwise copy the content to the corresponding existing measure
     else {
         Measure *existingMeasure = NULL;
         // Search by measure number first
-        ListOfObjects matchingMeasures;
-        AttNNumberLikeComparison comparisonMeasure(MEASURE, measure->GetN());
-        section->FindAllDescendantsByComparison(&matchingMeasures, &comparisonMeasure, 1);
-        // For now take the first match
-        if (!matchingMeasures.empty()) {
-            existingMeasure = vrv_cast<Measure *>(matchingMeasures.front());
-        }
-        // Prefer any measure with matching index (measure numbers might be non-unique)
-        for (Object *object : matchingMeasures) {
-            Measure *matchingMeasure = vrv_cast<Measure *>(object);
-            if (m_measureCounts.at(matchingMeasure) == i) {
-                existingMeasure = matchingMeasure;
-                break;
+        const auto matchingMeasures = m_sectionMeasures.find(measure->GetN());
+        if (matchingMeasures != m_sectionMeasures.end()) {
+            // For now take the first match
+            existingMeasure = matchingMeasures->second.front();
+            // Prefer any measure with matching index (measure numbers might be non-unique)
+            for (Measure *matchingMeasure : matchingMeasures->second) {
+                if (m_measureCounts.at(matchingMeasure) == i) {
+                    existingMeasure = matchingMeasure;
+                    break;
+                }
             }
         }
         if (existingMeasure) {
@@ -656,10 +777,9 @@ std::string MusicXmlInput::GetWordsOrDynamicsText(const pugi::xml_node node) con
     return std::string();
 }
 
-void MusicXmlInput::TextRendition(const pugi::xpath_node_set words, ControlElement *element) const
+void MusicXmlInput::TextRendition(const std::vector<pugi::xml_node> &words, ControlElement *element) const
 {
-    for (pugi::xpath_node_set::const_iterator it = words.begin(); it != words.end(); ++it) {
-        pugi::xml_node textNode = it->node();
+    for (pugi::xml_node textNode : words) {
         pugi::xml_node soundNode = textNode.parent().next_sibling("sound");
         std::string textStr = GetWordsOrDynamicsText(textNode);
         std::string textColor = textNode.attribute("color").as_string();
@@ -840,6 +960,9 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
     // the section
     Section *section = new Section();
     score->AddChild(section);
+    m_sectionMeasureCount = 0;
+    m_sectionMeasures.clear();
+    m_isFirstPart = false;
     // initialize layout
     if (root.select_node("/score-partwise/part/measure/print[@new-system or @new-page]")) {
         m_layoutInformation = LAYOUT_ENCODED;
@@ -906,6 +1029,14 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
     pugi::xpath_node scoreMidiBpm = root.select_node("/score-partwise/part[1]/measure[1]/sound[@tempo][1]");
     if (scoreMidiBpm) m_doc->GetCurrentScoreDef()->SetMidiBpm(scoreMidiBpm.node().attribute("tempo").as_double());
 
+    // index the parts by id and collect the endings once instead of querying them for each part and ending
+    const pugi::xml_node scorePartwise = root.root().child("score-partwise");
+    std::map<std::string, pugi::xml_node> parts;
+    for (pugi::xml_node part : scorePartwise.children("part")) {
+        parts.emplace(part.attribute("id").as_string(), part);
+    }
+    this->CollectClosedEndings(scorePartwise);
+
     pugi::xpath_node_set partListChildren = root.select_nodes("/score-partwise/part-list/*");
     for (pugi::xpath_node_set::const_iterator it = partListChildren.begin(); it != partListChildren.end(); ++it) {
         pugi::xpath_node xpathNode = *it;
@@ -981,9 +1112,10 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
         else if (IsElement(xpathNode.node(), "score-part")) {
             // get the attributes element of the first measure of the part
             const std::string partId = xpathNode.node().attribute("id").as_string();
-            std::string xpath = StringFormat("/score-partwise/part[@id='%s']/measure[1]", partId.c_str());
-            pugi::xpath_node partFirstMeasure = root.select_node(xpath.c_str());
-            if (!partFirstMeasure.node().child("attributes")) {
+            const auto partIter = parts.find(partId);
+            const pugi::xml_node part = (partIter != parts.end()) ? partIter->second : pugi::xml_node();
+            const pugi::xml_node partFirstMeasure = part.child("measure");
+            if (!partFirstMeasure.child("attributes")) {
                 LogWarning("MusicXML import: Could not find the 'attributes' element in the first "
                            "measure of part '%s'",
                     partId.c_str());
@@ -1057,7 +1189,7 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
             StaffGrp *partStaffGrp = new StaffGrp();
             partStaffGrp->SetID(partId.c_str());
             const short int nbStaves
-                = ReadMusicXmlPartAttributesAsStaffDef(partFirstMeasure.node(), partStaffGrp, staffOffset);
+                = ReadMusicXmlPartAttributesAsStaffDef(partFirstMeasure, partStaffGrp, staffOffset);
             // if we have more than one staff in the part we create a new staffGrp
             if (nbStaves > 1) {
                 partStaffGrp->SetBarThru(BOOLEAN_true);
@@ -1073,14 +1205,12 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
                 delete partStaffGrp;
             }
 
-            // find the part and read it
-            xpath = StringFormat("/score-partwise/part[@id='%s']", partId.c_str());
-            pugi::xpath_node part = root.select_node(xpath.c_str());
+            // read the part
             if (!part) {
                 LogWarning("MusicXML import: Could not find the part '%s'", partId.c_str());
                 continue;
             }
-            ReadMusicXmlPart(part.node(), section, nbStaves, staffOffset);
+            ReadMusicXmlPart(part, section, nbStaves, staffOffset);
             // increment the staffOffset for reading the next part
             staffOffset += nbStaves;
         }
@@ -1095,8 +1225,7 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
     Measure *measure = NULL;
     for (auto iter = m_controlElements.begin(); iter != m_controlElements.end(); ++iter) {
         if (!measure || (measure->GetN() != iter->first)) {
-            AttNNumberLikeComparison comparisonMeasure(MEASURE, iter->first);
-            measure = vrv_cast<Measure *>(section->FindDescendantByComparison(&comparisonMeasure, 1));
+            measure = this->GetSectionMeasure(iter->first);
         }
         if (!measure) {
             LogWarning("MusicXML import: Element '%s' could not be added to measure %s",
@@ -1286,9 +1415,9 @@ short int MusicXmlInput::ReadMusicXmlPartAttributesAsStaffDef(
 
     // First get the number of staves in the part
     short int nbStaves = 1;
-    pugi::xpath_node staves = node.select_node("attributes[1]/staves");
+    pugi::xml_node staves = node.child("attributes").child("staves");
     if (staves) {
-        nbStaves = staves.node().text().as_int();
+        nbStaves = staves.text().as_int();
     }
     if (nbStaves > 1) {
         if (m_label) staffGrp->AddChild(m_label);
@@ -1316,12 +1445,10 @@ short int MusicXmlInput::ReadMusicXmlPartAttributesAsStaffDef(
             continue;
         }
 
-        std::string xpath;
         // Create as many staffDef
         for (int i = 0; i < nbStaves; ++i) {
             // Find or create the staffDef
-            AttNIntegerComparison comparisonStaffDef(STAFFDEF, i + 1 + staffOffset);
-            StaffDef *staffDef = vrv_cast<StaffDef *>(staffGrp->FindDescendantByComparison(&comparisonStaffDef, 1));
+            StaffDef *staffDef = m_staffDefs[i + 1 + staffOffset];
             if (!staffDef) {
                 staffDef = new StaffDef();
                 staffDef->SetN(i + 1 + staffOffset);
@@ -1335,19 +1462,20 @@ short int MusicXmlInput::ReadMusicXmlPartAttributesAsStaffDef(
                     m_instrdef = NULL;
                 }
                 staffGrp->AddChild(staffDef);
+                m_staffDefs[i + 1 + staffOffset] = staffDef;
                 // set initial octave shift
                 m_octDis.push_back(0);
             }
 
             // clef sign - first look if we have a clef-sign with the corresponding staff @number
-            std::string xpath = StringFormat("clef[@number='%d']", i + 1);
-            pugi::xpath_node clef = it->select_node(xpath.c_str());
+            const std::string staffNumber = std::to_string(i + 1);
+            pugi::xml_node clef = it->find_child_by_attribute("clef", "number", staffNumber.c_str());
             // if not, look at a common one
             if (!clef) {
-                clef = it->select_node("clef[not(@number)]");
-                if (nbStaves > 1) clef.node().remove_attribute("id");
+                clef = this->GetChildWithoutAttribute(*it, "clef", "number");
+                if (nbStaves > 1) clef.remove_attribute("id");
             }
-            Clef *meiClef = ConvertClef(clef.node());
+            Clef *meiClef = ConvertClef(clef);
             if (meiClef) {
                 staffDef->AddChild(meiClef);
                 // if TAB assume guitar tablature until we examine <staff-details>, if any
@@ -1355,49 +1483,46 @@ short int MusicXmlInput::ReadMusicXmlPartAttributesAsStaffDef(
             }
 
             // key sig
-            xpath = StringFormat("key[@number='%d']", i + 1);
-            pugi::xpath_node key = it->select_node(xpath.c_str());
+            pugi::xml_node key = it->find_child_by_attribute("key", "number", staffNumber.c_str());
             if (!key) {
-                key = it->select_node("key[not(@number)]");
-                if (nbStaves > 1) key.node().remove_attribute("id");
+                key = this->GetChildWithoutAttribute(*it, "key", "number");
+                if (nbStaves > 1) key.remove_attribute("id");
             }
             if (key) {
-                KeySig *meiKey = ConvertKey(key.node());
+                KeySig *meiKey = ConvertKey(key);
                 staffDef->AddChild(meiKey);
                 if (staffDef->GetNotationtype() == NOTATIONTYPE_tab_guitar) meiKey->IsAttribute(true);
             }
 
             // staff details
-            pugi::xpath_node staffDetails;
-            xpath = StringFormat("staff-details[@number='%d']", i + 1);
-            staffDetails = it->select_node(xpath.c_str());
+            pugi::xml_node staffDetails = it->find_child_by_attribute("staff-details", "number", staffNumber.c_str());
             if (!staffDetails) {
-                staffDetails = it->select_node("staff-details[not(@number)]");
+                staffDetails = this->GetChildWithoutAttribute(*it, "staff-details", "number");
             }
-            short int staffLines = staffDetails.node().select_node("staff-lines").node().text().as_int();
+            short int staffLines = staffDetails.child("staff-lines").text().as_int();
             if (staffLines) {
                 staffDef->SetLines(staffLines);
             }
             else if (!staffDef->HasLines()) {
                 staffDef->SetLines(5);
             }
-            std::string scaleStr = staffDetails.node().select_node("staff-size").node().text().as_string();
+            std::string scaleStr = staffDetails.child("staff-size").text().as_string();
             if (!scaleStr.empty()) {
                 staffDef->SetScale(staffDef->AttScalable::StrToPercent(scaleStr + "%"));
             }
             // Tablature?
-            if (staffDetails.node().child("staff-tuning") || (staffDef->GetNotationtype() == NOTATIONTYPE_tab_guitar)) {
+            if (staffDetails.child("staff-tuning") || (staffDef->GetNotationtype() == NOTATIONTYPE_tab_guitar)) {
                 // tablature type.  MusicXML does not support German tablature.
-                if (HasAttributeWithValue(staffDetails.node(), "show-frets", "letters")) {
+                if (HasAttributeWithValue(staffDetails, "show-frets", "letters")) {
                     staffDef->SetNotationtype(NOTATIONTYPE_tab_lute_french);
                 }
                 else {
                     // Frets are notated with numbers.
                     // Italian tablature if the top staff line has a lower pitch than the bottom line
                     // else guitar tablature.
-                    pugi::xml_node topLine = staffDetails.node().find_child_by_attribute(
+                    pugi::xml_node topLine = staffDetails.find_child_by_attribute(
                         "staff-tuning", "line", std::to_string(staffLines).c_str());
-                    pugi::xml_node botLine = staffDetails.node().find_child_by_attribute("staff-tuning", "line", "1");
+                    pugi::xml_node botLine = staffDetails.find_child_by_attribute("staff-tuning", "line", "1");
                     if (topLine && botLine
                         && PitchToMidi(topLine.child("tuning-step").text().as_string(),
                                topLine.child("tuning-alter").text().as_int(),
@@ -1420,7 +1545,7 @@ short int MusicXmlInput::ReadMusicXmlPartAttributesAsStaffDef(
                 Tuning *tuning = new Tuning();
                 staffDef->AddChild(tuning);
 
-                for (pugi::xml_node staffTuning : staffDetails.node().children("staff-tuning")) {
+                for (pugi::xml_node staffTuning : staffDetails.children("staff-tuning")) {
                     Course *courseTuning = new Course();
                     tuning->AddChild(courseTuning);
 
@@ -1451,45 +1576,41 @@ short int MusicXmlInput::ReadMusicXmlPartAttributesAsStaffDef(
             }
 
             // time
-            pugi::xpath_node time;
-            xpath = StringFormat("time[@number='%d']", i + 1);
-            time = it->select_node(xpath.c_str());
+            pugi::xml_node time = it->find_child_by_attribute("time", "number", staffNumber.c_str());
             if (!time) {
-                time = it->select_node("time[not(@number)]");
-                if (nbStaves > 1) time.node().remove_attribute("id");
+                time = this->GetChildWithoutAttribute(*it, "time", "number");
+                if (nbStaves > 1) time.remove_attribute("id");
             }
             if (time) {
-                ReadMusicXMLMeterSig(time.node(), staffDef);
+                ReadMusicXMLMeterSig(time, staffDef);
             }
             // add it if necessary
 
             // transpose
-            pugi::xpath_node transpose;
-            xpath = StringFormat("transpose[@number='%d']", i + 1);
-            transpose = it->select_node(xpath.c_str());
+            pugi::xml_node transpose = it->find_child_by_attribute("transpose", "number", staffNumber.c_str());
             if (!transpose) {
-                transpose = it->select_node("transpose");
+                transpose = it->child("transpose");
             }
             if (transpose) {
-                staffDef->SetTransDiat(transpose.node().child("diatonic").text().as_int());
-                staffDef->SetTransSemi(transpose.node().child("chromatic").text().as_int());
-                if (transpose.node().child("octave-change")) {
-                    staffDef->SetTransDiat(transpose.node().child("chromatic").text().as_int()
-                        + 7 * transpose.node().child("octave-change").text().as_int());
-                    staffDef->SetTransSemi(transpose.node().child("chromatic").text().as_int()
-                        + 12 * transpose.node().child("octave-change").text().as_int());
+                staffDef->SetTransDiat(transpose.child("diatonic").text().as_int());
+                staffDef->SetTransSemi(transpose.child("chromatic").text().as_int());
+                if (transpose.child("octave-change")) {
+                    staffDef->SetTransDiat(transpose.child("chromatic").text().as_int()
+                        + 7 * transpose.child("octave-change").text().as_int());
+                    staffDef->SetTransSemi(transpose.child("chromatic").text().as_int()
+                        + 12 * transpose.child("octave-change").text().as_int());
                 }
             }
             // ppq
-            pugi::xpath_node divisions = it->select_node("divisions");
+            pugi::xml_node divisions = it->child("divisions");
             if (divisions) {
-                m_ppq = divisions.node().text().as_int();
+                m_ppq = divisions.text().as_int();
                 staffDef->SetPpq(m_ppq);
             }
             // measure style
-            pugi::xpath_node measureSlash = it->select_node("measure-style/slash");
+            pugi::xml_node measureSlash = this->GetGrandChild(*it, "measure-style", "slash");
             if (measureSlash) {
-                m_slash = (HasAttributeWithValue(measureSlash.node(), "type", "start")) ? true : false;
+                m_slash = (HasAttributeWithValue(measureSlash, "type", "start")) ? true : false;
             }
         }
     }
@@ -1499,17 +1620,17 @@ short int MusicXmlInput::ReadMusicXmlPartAttributesAsStaffDef(
 
 void MusicXmlInput::ReadMusicXMLMeterSig(const pugi::xml_node &time, Object *parent)
 {
-    if ((time.select_nodes("beats").size() > 1) || time.select_node("interchangeable")) {
+    if (time.child("beats").next_sibling("beats") || time.child("interchangeable")) {
         MeterSigGrp *meterSigGrp = new MeterSigGrp();
         if (time.attribute("id")) {
             meterSigGrp->SetID(time.attribute("id").as_string());
         }
-        pugi::xpath_node interchangeable = time.select_node("interchangeable");
+        pugi::xml_node interchangeable = time.child("interchangeable");
         meterSigGrp->SetFunc(interchangeable ? meterSigGrpLog_FUNC_interchanging : meterSigGrpLog_FUNC_mixed);
 
         std::tie(m_meterCount, m_meterUnit) = this->GetMeterSigGrpValues(time, meterSigGrp);
         if (interchangeable) {
-            std::tie(std::ignore, std::ignore) = this->GetMeterSigGrpValues(interchangeable.node(), meterSigGrp);
+            std::tie(std::ignore, std::ignore) = this->GetMeterSigGrpValues(interchangeable, meterSigGrp);
         }
         parent->AddChild(meterSigGrp);
     }
@@ -1556,19 +1677,19 @@ bool MusicXmlInput::ReadMusicXmlPart(pugi::xml_node node, Section *section, shor
     assert(node);
     assert(section);
 
-    pugi::xpath_node_set measures = node.select_nodes("measure");
-    if (measures.size() == 0) {
+    if (!node.child("measure")) {
         LogWarning("MusicXML import: No measure to load");
         return false;
     }
 
+    m_isFirstPart = !node.previous_sibling("part");
+
     int i = 0;
-    for (pugi::xpath_node_set::const_iterator it = measures.begin(); it != measures.end(); ++it) {
-        pugi::xpath_node xmlMeasure = *it;
+    for (pugi::xml_node xmlMeasure : node.children("measure")) {
         if (!IsMultirestMeasure(i)) {
             Measure *measure = new Measure();
             m_measureCounts[measure] = i;
-            ReadMusicXmlMeasure(xmlMeasure.node(), section, measure, nbStaves, staffOffset, i);
+            ReadMusicXmlMeasure(xmlMeasure, section, measure, nbStaves, staffOffset, i);
             // Add the measure to the system - if already there from a previous part we'll just merge the content
             AddMeasure(section, measure, i);
         }
@@ -1582,7 +1703,7 @@ bool MusicXmlInput::ReadMusicXmlPart(pugi::xml_node node, Section *section, shor
                     [lastElementIter](
                         const std::pair<Measure *, int> &elem) { return lastElementIter->first == elem.second; });
                 if (measureIter != m_measureCounts.end()) {
-                    for (auto it = xmlMeasure.node().begin(); it != xmlMeasure.node().end(); ++it) {
+                    for (auto it = xmlMeasure.begin(); it != xmlMeasure.end(); ++it) {
                         if (IsElement(*it, "barline")) {
                             ReadMusicXmlBarLine(*it, measureIter->first, std::to_string(lastElementIter->first));
                         }
@@ -1657,10 +1778,17 @@ bool MusicXmlInput::ReadMusicXmlMeasure(
     // read the content of the measure
     for (pugi::xml_node::iterator it = node.begin(); it != node.end(); ++it) {
         // first check if there is a multi measure rest
-        if (it->select_node(".//multiple-rest")) {
-            const int multiRestLength = it->select_node(".//multiple-rest").node().text().as_int();
+        pugi::xml_node xmlMultiRest
+            = it->find_node([](pugi::xml_node descendant) { return !strcmp(descendant.name(), "multiple-rest"); });
+        if (xmlMultiRest) {
+            const int multiRestLength = xmlMultiRest.text().as_int();
             MultiRest *multiRest = new MultiRest;
-            if (it->select_node(".//multiple-rest[@use-symbols='yes']")) multiRest->SetBlock(BOOLEAN_false);
+            if (it->find_node([](pugi::xml_node descendant) {
+                    return !strcmp(descendant.name(), "multiple-rest")
+                        && !strcmp(descendant.attribute("use-symbols").value(), "yes");
+                })) {
+                multiRest->SetBlock(BOOLEAN_false);
+            }
             multiRest->SetNum(multiRestLength);
             Layer *layer = SelectLayer(1, measure);
             AddLayerElement(layer, multiRest);
@@ -1701,7 +1829,7 @@ bool MusicXmlInput::ReadMusicXmlMeasure(
             ReadMusicXmlNote(*it, measure, measureNum, staffOffset, section);
         }
         // for now only check first part
-        else if (IsElement(*it, "print") && node.select_node("parent::part[not(preceding-sibling::part)]")) {
+        else if (IsElement(*it, "print") && m_isFirstPart) {
             ReadMusicXmlPrint(*it, section);
         }
     }
@@ -1807,8 +1935,12 @@ void MusicXmlInput::ReadMusicXmlAttributes(
     pugi::xml_node time = node.child("time");
 
     // for now only read first key change in first part and update scoreDef
-    if ((key || time || divisionChange) && node.select_node("ancestor::part[not(preceding-sibling::part)]")
-        && !node.select_node("preceding-sibling::attributes/key")) {
+    bool precedingKey = false;
+    for (pugi::xml_node attributes = node.previous_sibling("attributes"); attributes && !precedingKey;
+         attributes = attributes.previous_sibling("attributes")) {
+        precedingKey = attributes.child("key");
+    }
+    if ((key || time || divisionChange) && m_isFirstPart && !precedingKey) {
         ScoreDef *scoreDef = new ScoreDef();
         if (key) {
             KeySig *meiKey = ConvertKey(key);
@@ -1826,13 +1958,13 @@ void MusicXmlInput::ReadMusicXmlAttributes(
         section->AddChild(scoreDef);
     }
 
-    pugi::xpath_node measureRepeat = node.select_node("measure-style/measure-repeat");
-    pugi::xpath_node measureSlash = node.select_node("measure-style/slash");
+    pugi::xml_node measureRepeat = this->GetGrandChild(node, "measure-style", "measure-repeat");
+    pugi::xml_node measureSlash = this->GetGrandChild(node, "measure-style", "slash");
     if (measureRepeat) {
-        m_mRpt = (HasAttributeWithValue(measureRepeat.node(), "type", "start")) ? true : false;
+        m_mRpt = (HasAttributeWithValue(measureRepeat, "type", "start")) ? true : false;
     }
     if (measureSlash) {
-        m_slash = (HasAttributeWithValue(measureSlash.node(), "type", "start")) ? true : false;
+        m_slash = (HasAttributeWithValue(measureSlash, "type", "start")) ? true : false;
     }
 }
 
@@ -1855,7 +1987,7 @@ void MusicXmlInput::ReadMusicXmlBarLine(pugi::xml_node node, Measure *measure, c
     assert(staff);
 
     const std::string barStyle = node.child("bar-style").text().as_string();
-    pugi::xpath_node repeat = node.select_node("repeat");
+    pugi::xml_node repeat = node.child("repeat");
     if (!barStyle.empty()) {
         data_BARRENDITION barRendition = ConvertStyleToRend(barStyle, repeat);
         if (HasAttributeWithValue(node, "location", "left")) {
@@ -1904,9 +2036,7 @@ void MusicXmlInput::ReadMusicXmlBarLine(pugi::xml_node node, Measure *measure, c
         // endingText.c_str());
         if (endingType == "start") {
             // check for corresponding stop points
-            std::string xpath = StringFormat("following::ending[@number='%s'][@type != 'start']", endingNumber.c_str());
-            pugi::xpath_node endingEnd = node.select_node(xpath.c_str());
-            if (endingEnd) {
+            if (m_closedEndings.count(ending)) {
                 m_currentEndingStart = musicxml::EndingInfo(endingNumber, endingType, endingText);
             }
         }
@@ -1960,7 +2090,7 @@ void MusicXmlInput::ReadMusicXmlDirection(
     const std::string directionId = node.attribute("id").as_string();
 
     const pugi::xml_node typeNode = node.child("direction-type");
-    const pugi::xpath_node voice = node.select_node("voice");
+    const pugi::xml_node voice = node.child("voice");
     const short int offset = node.child("offset").text().as_int();
     const pugi::xml_node staffNode = node.child("staff");
     const pugi::xml_node soundNode = node.child("sound");
@@ -2026,13 +2156,15 @@ void MusicXmlInput::ReadMusicXmlDirection(
     }
 
     // Dashes (to be connected with previous <dir> or <dynam> as @extender and @tstamp2 attribute
-    pugi::xpath_node dashes = typeNode.select_node("bracket|dashes");
+    pugi::xml_node dashes = typeNode.find_child([](pugi::xml_node child) {
+        return !strcmp(child.name(), "bracket") || !strcmp(child.name(), "dashes");
+    });
     if (dashes) {
-        short int dashesNumber = dashes.node().attribute("number").as_int();
+        short int dashesNumber = dashes.attribute("number").as_int();
         dashesNumber = (dashesNumber < 1) ? 1 : dashesNumber;
         short int staffNum = 1;
         if (staffNode) staffNum = staffNode.text().as_int() + staffOffset;
-        if (HasAttributeWithValue(dashes.node(), "type", "stop")) {
+        if (HasAttributeWithValue(dashes, "type", "stop")) {
             std::vector<std::pair<ControlElement *, musicxml::OpenDashes>>::iterator iter = m_openDashesStack.begin();
             while (iter != m_openDashesStack.end()) {
                 if (iter->second.m_dirN == dashesNumber && iter->second.m_staffNum == staffNum) {
@@ -2052,7 +2184,7 @@ void MusicXmlInput::ReadMusicXmlDirection(
                 }
             }
         }
-        else if (std::strncmp(dashes.node().name(), "dashes", 6) == 0) {
+        else if (std::strncmp(dashes.name(), "dashes", 6) == 0) {
             ControlElement *controlElement = nullptr;
             // find last ControlElement of type dynam or dir and activate extender
             // this is bad MusicXML and shouldn't happen
@@ -2092,19 +2224,21 @@ void MusicXmlInput::ReadMusicXmlDirection(
         }
     }
 
-    pugi::xpath_node_set words = node.select_nodes("direction-type/words");
+    const std::vector<pugi::xml_node> words = this->GetGrandChildren(node, "direction-type", { "words" });
     const bool containsWords = !words.empty();
     bool containsDynamics
-        = !node.select_node("direction-type/dynamics").node().empty() || soundNode.attribute("dynamics");
-    bool containsTempo = !node.select_node("direction-type/metronome").node().empty() || soundNode.attribute("tempo");
+        = !this->GetGrandChild(node, "direction-type", "dynamics").empty() || soundNode.attribute("dynamics");
+    bool containsTempo
+        = !this->GetGrandChild(node, "direction-type", "metronome").empty() || soundNode.attribute("tempo");
 
     // Directive
     int defaultY = 0; // y position attribute, only for directives and dynamics
     if (containsWords && !containsTempo && !containsDynamics) {
-        pugi::xpath_node_set words = node.select_nodes("direction-type/*[self::words or self::coda or self::segno]");
-        defaultY = words.first().node().attribute("default-y").as_int();
-        defaultY = (defaultY * 10) + words.first().node().attribute("relative-y").as_int();
-        std::string wordStr = words.first().node().text().as_string();
+        const std::vector<pugi::xml_node> words
+            = this->GetGrandChildren(node, "direction-type", { "words", "coda", "segno" });
+        defaultY = words.front().attribute("default-y").as_int();
+        defaultY = (defaultY * 10) + words.front().attribute("relative-y").as_int();
+        std::string wordStr = words.front().text().as_string();
         if (wordStr.rfind("cresc", 0) == 0 || wordStr.rfind("dim", 0) == 0 || wordStr.rfind("decresc", 0) == 0) {
             containsDynamics = true;
             defaultY += 10000;
@@ -2112,7 +2246,7 @@ void MusicXmlInput::ReadMusicXmlDirection(
         else {
             Dir *dir = new Dir();
             if (words.size() == 1) {
-                dir->SetLang(words.first().node().attribute("xml:lang").as_string());
+                dir->SetLang(words.front().attribute("xml:lang").as_string());
             }
             dir->SetPlace(dir->AttPlacementRelStaff::StrToStaffrel(placeStr.c_str()));
             dir->SetTstamp(timeStamp);
@@ -2135,16 +2269,15 @@ void MusicXmlInput::ReadMusicXmlDirection(
             m_controlElements.push_back({ measureNum, dir });
             m_dirStack.push_back(dir);
 
-            pugi::xpath_node extender = (words.end() - 1)->parent().next_sibling("direction-type").first_child();
-            if (!strcmp(extender.node().name(), "bracket") || !strcmp(extender.node().name(), "dashes")) {
-                short int extNumber = extender.node().attribute("number").as_int();
+            pugi::xml_node extender = words.back().parent().next_sibling("direction-type").first_child();
+            if (!strcmp(extender.name(), "bracket") || !strcmp(extender.name(), "dashes")) {
+                short int extNumber = extender.attribute("number").as_int();
                 extNumber = (extNumber < 1) ? 1 : extNumber;
                 short int staffNum = staffNode.text().as_int() + staffOffset;
                 staffNum = (staffNum < 1) ? 1 : staffNum;
                 dir->SetExtender(BOOLEAN_true);
-                if (std::strncmp(extender.node().name(), "bracket", 7) == 0) {
-                    dir->SetLform(
-                        dir->AttLineRendBase::StrToLineform(extender.node().attribute("line-type").as_string()));
+                if (std::strncmp(extender.name(), "bracket", 7) == 0) {
+                    dir->SetLform(dir->AttLineRendBase::StrToLineform(extender.attribute("line-type").as_string()));
                 }
                 else {
                     dir->SetLform(LINEFORM_dashed);
@@ -2157,10 +2290,9 @@ void MusicXmlInput::ReadMusicXmlDirection(
 
     // Dynamics
     if (containsDynamics) {
-        pugi::xpath_node_set dynamics = node.select_nodes(
-            containsWords ? "direction-type/dynamics|direction-type/words" : "direction-type/dynamics");
-
-        dynamics.sort();
+        const std::vector<pugi::xml_node> dynamics = containsWords
+            ? this->GetGrandChildren(node, "direction-type", { "dynamics", "words" })
+            : this->GetGrandChildren(node, "direction-type", { "dynamics" });
 
         Dynam *dynam = new Dynam();
         dynam->SetPlace(dynam->AttPlacementRelStaff::StrToStaffrel(placeStr.c_str()));
@@ -2185,9 +2317,9 @@ void MusicXmlInput::ReadMusicXmlDirection(
         }
 
         TextRendition(dynamics, dynam);
-        if (defaultY == 0) {
-            defaultY = dynamics.first().node().attribute("default-y").as_int();
-            defaultY = (defaultY * 10) + dynamics.first().node().attribute("relative-y").as_int();
+        if ((defaultY == 0) && !dynamics.empty()) {
+            defaultY = dynamics.front().attribute("default-y").as_int();
+            defaultY = (defaultY * 10) + dynamics.front().attribute("relative-y").as_int();
         }
         // parse the default_y attribute and transform to vgrp value, to vertically align dynamics and directives
         defaultY = (defaultY < 0) ? std::abs(defaultY) : defaultY + 2000;
@@ -2196,16 +2328,16 @@ void MusicXmlInput::ReadMusicXmlDirection(
         m_dynamStack.push_back(dynam);
 
         if (!dynamics.empty()) {
-            pugi::xpath_node extender = (dynamics.end() - 1)->parent().next_sibling("direction-type").first_child();
-            if (!strcmp(extender.node().name(), "bracket") || !strcmp(extender.node().name(), "dashes")) {
-                short int extNumber = extender.node().attribute("number").as_int();
+            pugi::xml_node extender = dynamics.back().parent().next_sibling("direction-type").first_child();
+            if (!strcmp(extender.name(), "bracket") || !strcmp(extender.name(), "dashes")) {
+                short int extNumber = extender.attribute("number").as_int();
                 extNumber = (extNumber < 1) ? 1 : extNumber;
                 short int staffNum = staffNode.text().as_int() + staffOffset;
                 staffNum = (staffNum < 1) ? 1 : staffNum;
                 dynam->SetExtender(BOOLEAN_true);
-                if (std::strncmp(extender.node().name(), "bracket", 7) == 0) {
+                if (std::strncmp(extender.name(), "bracket", 7) == 0) {
                     dynam->SetLform(
-                        dynam->AttLineRendBase::StrToLineform(extender.node().attribute("line-type").as_string()));
+                        dynam->AttLineRendBase::StrToLineform(extender.attribute("line-type").as_string()));
                 }
                 else {
                     dynam->SetLform(LINEFORM_dashed);
@@ -2217,12 +2349,12 @@ void MusicXmlInput::ReadMusicXmlDirection(
     }
 
     // Hairpins
-    pugi::xpath_node_set wedges = node.select_nodes("direction-type/wedge");
-    for (pugi::xpath_node_set::const_iterator wedge = wedges.begin(); wedge != wedges.end(); ++wedge) {
-        short int hairpinNumber = wedge->node().attribute("number").as_int();
+    const std::vector<pugi::xml_node> wedges = this->GetGrandChildren(node, "direction-type", { "wedge" });
+    for (auto wedge = wedges.begin(); wedge != wedges.end(); ++wedge) {
+        short int hairpinNumber = wedge->attribute("number").as_int();
         hairpinNumber = (hairpinNumber < 1) ? 1 : hairpinNumber;
         bool matchedWedge = false;
-        if (HasAttributeWithValue(wedge->node(), "type", "stop")) {
+        if (HasAttributeWithValue(*wedge, "type", "stop")) {
             // match wedge type=stop to open hairpin
             std::vector<std::pair<Hairpin *, musicxml::OpenSpanner>>::iterator iter;
             for (iter = m_hairpinStack.begin(); iter != m_hairpinStack.end(); ++iter) {
@@ -2231,13 +2363,13 @@ void MusicXmlInput::ReadMusicXmlDirection(
                     if (measureDifference >= 0) {
                         iter->first->SetTstamp2(std::pair<int, double>(measureDifference, timeStamp));
                     }
-                    if (wedge->node().attribute("niente")) {
-                        iter->first->SetNiente(ConvertWordToBool(wedge->node().attribute("niente").as_string()));
+                    if (wedge->attribute("niente")) {
+                        iter->first->SetNiente(ConvertWordToBool(wedge->attribute("niente").as_string()));
                     }
                     if (iter->first->GetForm() == hairpinLog_FORM_cres) {
-                        if (wedge->node().attribute("spread")) {
+                        if (wedge->attribute("spread")) {
                             data_MEASUREMENTSIGNED opening;
-                            opening.SetVu(wedge->node().attribute("spread").as_double() / 5);
+                            opening.SetVu(wedge->attribute("spread").as_double() / 5);
                             iter->first->SetOpening(opening);
                         }
                     }
@@ -2254,14 +2386,14 @@ void MusicXmlInput::ReadMusicXmlDirection(
         else {
             Hairpin *hairpin = new Hairpin();
             musicxml::OpenSpanner openHairpin(hairpinNumber, m_measureCounts.at(measure));
-            if (HasAttributeWithValue(wedge->node(), "type", "crescendo")) {
+            if (HasAttributeWithValue(*wedge, "type", "crescendo")) {
                 hairpin->SetForm(hairpinLog_FORM_cres);
             }
-            else if (HasAttributeWithValue(wedge->node(), "type", "diminuendo")) {
+            else if (HasAttributeWithValue(*wedge, "type", "diminuendo")) {
                 hairpin->SetForm(hairpinLog_FORM_dim);
-                if (wedge->node().attribute("spread")) {
+                if (wedge->attribute("spread")) {
                     data_MEASUREMENTSIGNED opening;
-                    opening.SetVu(wedge->node().attribute("spread").as_double() / 5);
+                    opening.SetVu(wedge->attribute("spread").as_double() / 5);
                     hairpin->SetOpening(opening);
                 }
             }
@@ -2270,14 +2402,14 @@ void MusicXmlInput::ReadMusicXmlDirection(
                 return;
             }
             hairpin->SetLform(
-                hairpin->AttLineRendBase::StrToLineform(wedge->node().attribute("line-type").as_string()));
-            if (wedge->node().attribute("niente")) {
-                hairpin->SetNiente(ConvertWordToBool(wedge->node().attribute("niente").as_string()));
+                hairpin->AttLineRendBase::StrToLineform(wedge->attribute("line-type").as_string()));
+            if (wedge->attribute("niente")) {
+                hairpin->SetNiente(ConvertWordToBool(wedge->attribute("niente").as_string()));
             }
-            hairpin->SetColor(wedge->node().attribute("color").as_string());
+            hairpin->SetColor(wedge->attribute("color").as_string());
             hairpin->SetPlace(hairpin->AttPlacementRelStaff::StrToStaffrel(placeStr.c_str()));
             hairpin->SetTstamp(timeStamp);
-            if (wedge->node().attribute("id")) hairpin->SetID(wedge->node().attribute("id").as_string());
+            if (wedge->attribute("id")) hairpin->SetID(wedge->attribute("id").as_string());
             if (staffNode) {
                 hairpin->SetStaff(hairpin->AttStaffIdent::StrToXsdPositiveIntegerList(
                     std::to_string(staffNode.text().as_int() + staffOffset)));
@@ -2289,8 +2421,8 @@ void MusicXmlInput::ReadMusicXmlDirection(
             else {
                 hairpin->SetStaff(hairpin->AttStaffIdent::StrToXsdPositiveIntegerList(std::to_string(1 + staffOffset)));
             }
-            int defaultY = wedge->node().attribute("default-y").as_int();
-            defaultY = (defaultY * 10) + wedge->node().attribute("relative-y").as_int();
+            int defaultY = wedge->attribute("default-y").as_int();
+            defaultY = (defaultY * 10) + wedge->attribute("relative-y").as_int();
             // parse the default_y attribute and transform to vgrp value, to vertically align hairpins
             defaultY = (defaultY < 0) ? std::abs(defaultY) : defaultY + 2000;
             hairpin->SetVgrp(defaultY);
@@ -2481,15 +2613,18 @@ void MusicXmlInput::ReadMusicXmlDirection(
     if (containsTempo) {
         Tempo *tempo = new Tempo();
         if (!words.empty()) {
-            const std::string lang = words.first().node().attribute("xml:lang")
-                ? words.first().node().attribute("xml:lang").as_string()
-                : "it";
+            const std::string lang
+                = words.front().attribute("xml:lang") ? words.front().attribute("xml:lang").as_string() : "it";
             tempo->SetLang(lang);
         }
         tempo->SetPlace(tempo->AttPlacementRelStaff::StrToStaffrel(placeStr.c_str()));
         if (words.size() != 0) TextRendition(words, tempo);
-        pugi::xpath_node metronome = node.select_node("direction-type/metronome[not(@print-object='no')]");
-        if (metronome) PrintMetronome(metronome.node(), tempo);
+        pugi::xml_node metronome;
+        for (pugi::xml_node directionType : node.children("direction-type")) {
+            metronome = this->GetPrintedChild(directionType, "metronome");
+            if (metronome) break;
+        }
+        if (metronome) PrintMetronome(metronome, tempo);
         if (soundNode.attribute("tempo")) {
             tempo->SetMidiBpm(soundNode.attribute("tempo").as_double());
         }
@@ -2577,9 +2712,9 @@ void MusicXmlInput::ReadMusicXmlHarmony(pugi::xml_node node, Measure *measure, c
 
     int durOffset = 0;
 
-    std::string harmText = GetContentOfChild(node, "root/root-step");
-    pugi::xpath_node alter = node.select_node("root/root-alter");
-    if (alter) harmText += ConvertAlterToSymbol(GetContent(alter.node()));
+    std::string harmText = this->GetGrandChild(node, "root", "root-step").text().as_string();
+    pugi::xml_node alter = this->GetGrandChild(node, "root", "root-alter");
+    if (alter) harmText += ConvertAlterToSymbol(GetContent(alter));
     pugi::xml_node kind = node.child("kind");
     if (kind) {
         if (HasAttributeWithValue(kind, "use-symbols", "yes")) {
@@ -2626,8 +2761,8 @@ void MusicXmlInput::ReadMusicXmlNote(
     assert(staff);
     // find staff's staffDef
     // TODO Tablature: is this the correct way to find a staff's staffDef?
-    AttNIntegerComparison cnc(STAFFDEF, staff->GetN());
-    StaffDef *staffDef = vrv_cast<StaffDef *>(m_doc->GetCurrentScoreDef()->FindDescendantByComparison(&cnc));
+    const auto staffDefIter = m_staffDefs.find(staff->GetN());
+    StaffDef *staffDef = (staffDefIter != m_staffDefs.end()) ? staffDefIter->second : NULL;
     bool isTablature = false;
     Tuning *tuning = NULL;
 
@@ -2660,49 +2795,47 @@ void MusicXmlInput::ReadMusicXmlNote(
         return;
     }
 
-    const pugi::xpath_node notations = node.select_node("notations[not(@print-object='no')]");
+    const pugi::xml_node notations = this->GetPrintedChild(node, "notations");
 
-    const bool cue = (node.child("cue") || node.select_node("type[@size='cue']")) ? true : false;
+    const bool cue = (node.child("cue") || node.find_child_by_attribute("type", "size", "cue")) ? true : false;
     pugi::xml_node grace = node.child("grace");
 
     // duration string and dots
     const std::string typeStr = node.child("type").text().as_string();
-    const int dots = (int)node.select_nodes("dot").size();
+    const int dots = (int)std::distance(node.children("dot").begin(), node.children("dot").end());
 
     short int tremSlashNum = -1;
 
     const bool readBeamsAndTuplets = ReadMusicXmlBeamsAndTuplets(node, layer, isChord);
 
     // beam start
-    bool beamStart = node.select_node("beam[@number='1'][text()='begin']");
+    bool beamStart = this->GetBeamWithValue(node, "begin", 1);
     // tremolos
-    pugi::xpath_node tremolo = notations.node().select_node("ornaments/tremolo");
+    pugi::xml_node tremolo = this->GetGrandChild(notations, "ornaments", "tremolo");
 
     if (tremolo) {
-        if (HasAttributeWithValue(tremolo.node(), "type", "start")) {
+        if (HasAttributeWithValue(tremolo, "type", "start")) {
             if (!isChord) {
                 FTrem *fTrem = new FTrem();
                 AddLayerElement(layer, fTrem);
                 m_elementStackMap.at(layer).push_back(fTrem);
-                int beamFloatNum = tremolo.node().text().as_int(); // number of floating beams
+                int beamFloatNum = tremolo.text().as_int(); // number of floating beams
                 int beamAttachedNum = 0; // number of attached beams
                 while (beamStart && beamAttachedNum < 8) { // count number of (attached) beams, max 8
-                    std::ostringstream o;
-                    o << "beam[@number='" << ++beamAttachedNum + 1 << "'][text()='begin']";
-                    beamStart = node.select_node(o.str().c_str());
+                    beamStart = this->GetBeamWithValue(node, "begin", ++beamAttachedNum + 1);
                 }
                 fTrem->SetBeams(beamFloatNum + beamAttachedNum);
                 fTrem->SetBeamsFloat(beamFloatNum);
             }
         }
-        else if (!HasAttributeWithValue(tremolo.node(), "type", "stop")) {
+        else if (!HasAttributeWithValue(tremolo, "type", "stop")) {
             // this is default tremolo type in MusicXML
-            tremSlashNum = tremolo.node().text().as_int();
+            tremSlashNum = tremolo.text().as_int();
             if (!isChord) {
                 BTrem *bTrem = new BTrem();
                 AddLayerElement(layer, bTrem);
                 m_elementStackMap.at(layer).push_back(bTrem);
-                if (HasAttributeWithValue(tremolo.node(), "type", "unmeasured")) {
+                if (HasAttributeWithValue(tremolo, "type", "unmeasured")) {
                     bTrem->SetForm(tremForm_FORM_unmeas);
                     tremSlashNum = 0;
                 }
@@ -2822,7 +2955,7 @@ void MusicXmlInput::ReadMusicXmlNote(
         // accidental
         pugi::xml_node accidental = node.child("accidental");
         if (!accidental) {
-            accidental = node.select_node("notations/accidental-mark").node();
+            accidental = this->GetGrandChild(node, "notations", "accidental-mark");
         }
         if (accidental) {
             Accid *accid = new Accid();
@@ -2905,8 +3038,8 @@ void MusicXmlInput::ReadMusicXmlNote(
         if (node.child("notehead-text")) LogWarning("MusicXML import: notehead-text is not supported");
 
         // look at the next note to see if we are starting or ending a chord
-        pugi::xpath_node nextNote = node.select_node("./following-sibling::note");
-        if (nextNote.node().child("chord")) nextIsChord = true;
+        pugi::xml_node nextNote = node.next_sibling("note");
+        if (nextNote.child("chord")) nextIsChord = true;
         Chord *chord = NULL;
         TabGrp *tabGrp = NULL;
         if (isTablature) {
@@ -3123,9 +3256,8 @@ void MusicXmlInput::ReadMusicXmlNote(
         }
 
         // slurs
-        pugi::xpath_node_set slurs = node.select_nodes("notations/slur");
-        for (pugi::xpath_node_set::const_iterator it = slurs.begin(); it != slurs.end(); ++it) {
-            pugi::xml_node slur = it->node();
+        const std::vector<pugi::xml_node> slurs = this->GetGrandChildren(node, "notations", { "slur" });
+        for (pugi::xml_node slur : slurs) {
             short int slurNumber = slur.attribute("number").as_int();
             slurNumber = (slurNumber < 1) ? 1 : slurNumber;
             const curvature_CURVEDIR dir = InferCurvedir(slur);
@@ -3147,11 +3279,11 @@ void MusicXmlInput::ReadMusicXmlNote(
         }
 
         // ties
-        ReadMusicXmlTies(notations.node(), layer, note, measureNum);
+        ReadMusicXmlTies(notations, layer, note, measureNum);
 
         // articulation
         std::vector<data_ARTICULATION> artics;
-        for (pugi::xml_node articulations : notations.node().children("articulations")) {
+        for (pugi::xml_node articulations : notations.children("articulations")) {
             for (pugi::xml_node articulation : articulations.children()) {
                 Artic *artic = new Artic();
                 artics.push_back(ConvertArticulations(articulation.name()));
@@ -3180,7 +3312,7 @@ void MusicXmlInput::ReadMusicXmlNote(
         }
 
         // technical
-        for (pugi::xml_node technical : notations.node().children("technical")) {
+        for (pugi::xml_node technical : notations.children("technical")) {
             for (pugi::xml_node technicalChild : technical.children()) {
                 const std::string technicalChildName = technicalChild.name();
 
@@ -3270,31 +3402,31 @@ void MusicXmlInput::ReadMusicXmlNote(
     m_ID = "#" + element->GetID();
 
     // breath marks
-    pugi::xpath_node xmlBreath = notations.node().select_node("articulations/breath-mark");
+    pugi::xml_node xmlBreath = this->GetGrandChild(notations, "articulations", "breath-mark");
     if (xmlBreath) {
         Breath *breath = new Breath();
         m_controlElements.push_back({ measureNum, breath });
         breath->SetStaff(staff->AttNInteger::StrToXsdPositiveIntegerList(std::to_string(staff->GetN())));
         breath->SetPlace(
-            breath->AttPlacementRelStaff::StrToStaffrel(xmlBreath.node().attribute("placement").as_string()));
-        breath->SetColor(xmlBreath.node().attribute("color").as_string());
+            breath->AttPlacementRelStaff::StrToStaffrel(xmlBreath.attribute("placement").as_string()));
+        breath->SetColor(xmlBreath.attribute("color").as_string());
         breath->SetTstamp((double)(m_durTotal) * (double)m_meterUnit / (double)(4 * m_ppq) + 0.5);
     }
 
     // caesura
-    pugi::xpath_node xmlCaesura = notations.node().select_node("articulations/caesura");
+    pugi::xml_node xmlCaesura = this->GetGrandChild(notations, "articulations", "caesura");
     if (xmlCaesura) {
         Caesura *caesura = new Caesura();
         m_controlElements.push_back({ measureNum, caesura });
         caesura->SetStaff(staff->AttNInteger::StrToXsdPositiveIntegerList(std::to_string(staff->GetN())));
         caesura->SetPlace(
-            caesura->AttPlacementRelStaff::StrToStaffrel(xmlCaesura.node().attribute("placement").as_string()));
-        caesura->SetColor(xmlCaesura.node().attribute("color").as_string());
+            caesura->AttPlacementRelStaff::StrToStaffrel(xmlCaesura.attribute("placement").as_string()));
+        caesura->SetColor(xmlCaesura.attribute("color").as_string());
         caesura->SetTstamp((double)(m_durTotal) * (double)m_meterUnit / (double)(4 * m_ppq) + 0.5);
     }
 
     // dynamics
-    pugi::xml_node xmlDynam = notations.node().child("dynamics");
+    pugi::xml_node xmlDynam = notations.child("dynamics");
     if (xmlDynam) {
         Dynam *dynam = new Dynam();
         m_controlElements.push_back({ measureNum, dynam });
@@ -3323,7 +3455,7 @@ void MusicXmlInput::ReadMusicXmlNote(
     }
 
     // fermatas
-    pugi::xml_node xmlFermata = notations.node().child("fermata");
+    pugi::xml_node xmlFermata = notations.child("fermata");
     if (xmlFermata) {
         Fermata *fermata = new Fermata();
         m_controlElements.push_back({ measureNum, fermata });
@@ -3334,9 +3466,9 @@ void MusicXmlInput::ReadMusicXmlNote(
     }
 
     // fingering
-    auto xmlFing = notations.node().select_node("technical/fingering");
+    pugi::xml_node xmlFing = this->GetGrandChild(notations, "technical", "fingering");
     if (xmlFing) {
-        const std::string fingText = xmlFing.node().text().as_string();
+        const std::string fingText = xmlFing.text().as_string();
         Fing *fing = new Fing();
         Text *text = new Text();
         text->SetText(UTF8to32(fingText));
@@ -3344,17 +3476,16 @@ void MusicXmlInput::ReadMusicXmlNote(
         const std::string startID = note ? ("#" + note->GetID()) : m_ID;
         fing->SetStartid(startID);
         fing->SetStaff(staff->AttNInteger::StrToXsdPositiveIntegerList(std::to_string(staff->GetN())));
-        fing->SetPlace(fing->AttPlacementRelStaff::StrToStaffrel(xmlFing.node().attribute("placement").as_string()));
+        fing->SetPlace(fing->AttPlacementRelStaff::StrToStaffrel(xmlFing.attribute("placement").as_string()));
         fing->AddChild(text);
     }
 
     // glissando and slide
-    pugi::xpath_node_set glissandi = notations.node().select_nodes("glissando|slide");
-    for (pugi::xpath_node_set::const_iterator it = glissandi.begin(); it != glissandi.end(); ++it) {
+    for (pugi::xml_node xmlGlissando : notations.children()) {
+        if (!IsElement(xmlGlissando, "glissando") && !IsElement(xmlGlissando, "slide")) continue;
         std::string noteID = m_ID;
         // prevent from using chords or tabGrps
         if (element->Is(CHORD) || element->Is(TABGRP)) noteID = "#" + element->GetChild(0)->GetID();
-        pugi::xml_node xmlGlissando = it->node();
         if (HasAttributeWithValue(xmlGlissando, "type", "start")) {
             Gliss *gliss = new Gliss();
             m_controlElements.push_back({ measureNum, gliss });
@@ -3383,25 +3514,25 @@ void MusicXmlInput::ReadMusicXmlNote(
     }
 
     // mordents
-    pugi::xpath_node xmlMordent = notations.node().select_node("ornaments/*[contains(name(), 'mordent')]");
+    pugi::xml_node xmlMordent = this->GetGrandChildContaining(notations, "ornaments", { "mordent" });
     if (xmlMordent) {
         Mordent *mordent = new Mordent();
         m_controlElements.push_back({ measureNum, mordent });
         mordent->SetStaff(staff->AttNInteger::StrToXsdPositiveIntegerList(std::to_string(staff->GetN())));
         mordent->SetStartid(m_ID);
         // color
-        mordent->SetColor(xmlMordent.node().attribute("color").as_string());
+        mordent->SetColor(xmlMordent.attribute("color").as_string());
         // long
-        mordent->SetLong(ConvertWordToBool(xmlMordent.node().attribute("long").as_string()));
+        mordent->SetLong(ConvertWordToBool(xmlMordent.attribute("long").as_string()));
         // place
         mordent->SetPlace(
-            mordent->AttPlacementRelStaff::StrToStaffrel(xmlMordent.node().attribute("placement").as_string()));
+            mordent->AttPlacementRelStaff::StrToStaffrel(xmlMordent.attribute("placement").as_string()));
         // form
         mordent->SetForm(mordentLog_FORM_lower);
-        if (!std::strncmp(xmlMordent.node().name(), "inverted", 7)) {
+        if (!std::strncmp(xmlMordent.name(), "inverted", 7)) {
             mordent->SetForm(mordentLog_FORM_upper);
         }
-        for (pugi::xml_node xmlAccidMark : notations.node().children("accidental-mark")) {
+        for (pugi::xml_node xmlAccidMark : notations.children("accidental-mark")) {
             const data_ACCIDENTAL_WRITTEN accid = ConvertAccidentalToAccid(xmlAccidMark.text().as_string());
             if (HasAttributeWithValue(xmlAccidMark, "placement", "above")) {
                 mordent->SetAccidupper(accid);
@@ -3416,13 +3547,13 @@ void MusicXmlInput::ReadMusicXmlNote(
         }
         if (BOOLEAN_true == mordent->GetLong()) {
             int mordentFlags = (mordentLog_FORM_upper == mordent->GetForm()) ? FORM_Inverted : FORM_Normal;
-            if (xmlMordent.node().attribute("approach")) {
-                mordentFlags |= (std::string(xmlMordent.node().attribute("approach").as_string()) == "above")
+            if (xmlMordent.attribute("approach")) {
+                mordentFlags |= (std::string(xmlMordent.attribute("approach").as_string()) == "above")
                     ? APPR_Above
                     : APPR_Below;
             }
-            if (xmlMordent.node().attribute("departure")) {
-                mordentFlags |= (std::string(xmlMordent.node().attribute("departure").as_string()) == "above")
+            if (xmlMordent.attribute("departure")) {
+                mordentFlags |= (std::string(xmlMordent.attribute("departure").as_string()) == "above")
                     ? DEP_Above
                     : DEP_Below;
             }
@@ -3435,48 +3566,48 @@ void MusicXmlInput::ReadMusicXmlNote(
     }
 
     // schleifer/haydn (counts as mordent with different glyph)
-    pugi::xpath_node xmlExtOrnament
-        = notations.node().select_node("ornaments/*[contains(name(), 'schleifer') or contains(name(), 'haydn')]");
+    pugi::xml_node xmlExtOrnament = this->GetGrandChildContaining(notations, "ornaments", { "schleifer", "haydn" });
     if (xmlExtOrnament) {
         Mordent *mordent = new Mordent();
         m_controlElements.push_back({ measureNum, mordent });
         mordent->SetStaff(staff->AttNInteger::StrToXsdPositiveIntegerList(std::to_string(staff->GetN())));
         mordent->SetStartid(m_ID);
         // color
-        mordent->SetColor(xmlExtOrnament.node().attribute("color").as_string());
+        mordent->SetColor(xmlExtOrnament.attribute("color").as_string());
         // place
         mordent->SetPlace(
-            mordent->AttPlacementRelStaff::StrToStaffrel(xmlExtOrnament.node().attribute("placement").as_string()));
-        const bool isHaydn = std::string(xmlExtOrnament.node().name()) == "haydn";
+            mordent->AttPlacementRelStaff::StrToStaffrel(xmlExtOrnament.attribute("placement").as_string()));
+        const bool isHaydn = std::string(xmlExtOrnament.name()) == "haydn";
         AttModule::SetExternalsymbols(mordent, "glyph.num", isHaydn ? "U+E56F" : "U+E587");
         AttModule::SetExternalsymbols(mordent, "glyph.auth", "smufl");
     }
 
     // trill
-    pugi::xpath_node xmlTrill = notations.node().select_node("ornaments/trill-mark");
-    pugi::xpath_node xmlTrillLine = notations.node().select_node("ornaments/wavy-line[@type='start']");
+    pugi::xml_node xmlTrill = this->GetGrandChild(notations, "ornaments", "trill-mark");
+    pugi::xml_node xmlTrillLine
+        = this->GetGrandChildWithAttribute(notations, "ornaments", "wavy-line", "type", "start");
     if (xmlTrill || xmlTrillLine) {
         Trill *trill = new Trill();
         m_controlElements.push_back({ measureNum, trill });
         trill->SetStaff(staff->AttNInteger::StrToXsdPositiveIntegerList(std::to_string(staff->GetN())));
         trill->SetStartid(m_ID);
         // color
-        trill->SetColor(xmlTrill.node().attribute("color").as_string());
+        trill->SetColor(xmlTrill.attribute("color").as_string());
         // place
-        trill->SetPlace(trill->AttPlacementRelStaff::StrToStaffrel(xmlTrill.node().attribute("placement").as_string()));
+        trill->SetPlace(trill->AttPlacementRelStaff::StrToStaffrel(xmlTrill.attribute("placement").as_string()));
         if (xmlTrillLine) {
             trill->SetExtender(BOOLEAN_true);
-            trill->SetN(xmlTrillLine.node().attribute("number").as_string());
+            trill->SetN(xmlTrillLine.attribute("number").as_string());
             if (!xmlTrill) {
                 trill->SetLstartsym(LINESTARTENDSYMBOL_none);
-                trill->SetColor(xmlTrillLine.node().attribute("color").as_string());
+                trill->SetColor(xmlTrillLine.attribute("color").as_string());
                 trill->SetPlace(
-                    trill->AttPlacementRelStaff::StrToStaffrel(xmlTrillLine.node().attribute("placement").as_string()));
+                    trill->AttPlacementRelStaff::StrToStaffrel(xmlTrillLine.attribute("placement").as_string()));
             }
             musicxml::OpenSpanner openTrill(1, m_measureCounts.at(measure));
             m_trillStack.push_back({ trill, openTrill });
         }
-        for (pugi::xml_node xmlAccidMark = xmlTrill.node().next_sibling("accidental-mark"); xmlAccidMark;
+        for (pugi::xml_node xmlAccidMark = xmlTrill.next_sibling("accidental-mark"); xmlAccidMark;
              xmlAccidMark = xmlAccidMark.next_sibling("accidental-mark")) {
             if (HasAttributeWithValue(xmlAccidMark, "placement", "below")) {
                 trill->SetAccidlower(ConvertAccidentalToAccid(xmlAccidMark.text().as_string()));
@@ -3486,9 +3617,10 @@ void MusicXmlInput::ReadMusicXmlNote(
             }
         }
     }
-    if (!m_trillStack.empty() && notations.node().select_node("ornaments/wavy-line[@type='stop']")) {
-        short int extNumber
-            = notations.node().select_node("ornaments/wavy-line[@type='stop']").node().attribute("number").as_int();
+    pugi::xml_node xmlTrillLineEnd
+        = this->GetGrandChildWithAttribute(notations, "ornaments", "wavy-line", "type", "stop");
+    if (!m_trillStack.empty() && xmlTrillLineEnd) {
+        short int extNumber = xmlTrillLineEnd.attribute("number").as_int();
         std::vector<std::pair<Trill *, musicxml::OpenSpanner>>::iterator iter = m_trillStack.begin();
         while (iter != m_trillStack.end()) {
             const int measureDifference = m_measureCounts.at(measure) - iter->second.m_lastMeasureCount;
@@ -3505,16 +3637,16 @@ void MusicXmlInput::ReadMusicXmlNote(
     }
 
     // turns
-    pugi::xpath_node xmlTurn = notations.node().select_node("ornaments/*[contains(name(), 'turn')]");
+    pugi::xml_node xmlTurn = this->GetGrandChildContaining(notations, "ornaments", { "turn" });
     if (xmlTurn) {
         Turn *turn = new Turn();
         m_controlElements.push_back({ measureNum, turn });
         turn->SetStaff(staff->AttNInteger::StrToXsdPositiveIntegerList(std::to_string(staff->GetN())));
         turn->SetStartid(m_ID);
-        turn->SetColor(xmlTurn.node().attribute("color").as_string());
-        turn->SetPlace(turn->AttPlacementRelStaff::StrToStaffrel(xmlTurn.node().attribute("placement").as_string()));
+        turn->SetColor(xmlTurn.attribute("color").as_string());
+        turn->SetPlace(turn->AttPlacementRelStaff::StrToStaffrel(xmlTurn.attribute("placement").as_string()));
         turn->SetForm(turnLog_FORM_upper);
-        for (pugi::xml_node xmlAccidMark = xmlTurn.node().next_sibling("accidental-mark"); xmlAccidMark;
+        for (pugi::xml_node xmlAccidMark = xmlTurn.next_sibling("accidental-mark"); xmlAccidMark;
              xmlAccidMark = xmlAccidMark.next_sibling("accidental-mark")) {
             if (HasAttributeWithValue(xmlAccidMark, "placement", "above")) {
                 turn->SetAccidupper(ConvertAccidentalToAccid(xmlAccidMark.text().as_string()));
@@ -3526,22 +3658,22 @@ void MusicXmlInput::ReadMusicXmlNote(
                 LogWarning("MusicXML import: Cannot add an accidental to a turn without placement");
             }
         }
-        if (xmlTurn.node().attribute("slash").as_bool()) {
+        if (xmlTurn.attribute("slash").as_bool()) {
             AttModule::SetExternalsymbols(turn, "glyph.auth", "smufl");
             AttModule::SetExternalsymbols(turn, "glyph.num", "U+E569");
         }
-        if (!std::strncmp(xmlTurn.node().name(), "inverted", 8)) {
+        if (!std::strncmp(xmlTurn.name(), "inverted", 8)) {
             turn->SetForm(turnLog_FORM_lower);
-            if (std::string(xmlTurn.node().name()).find("vertical") != std::string::npos) {
+            if (std::string(xmlTurn.name()).find("vertical") != std::string::npos) {
                 turn->SetType("vertical");
                 AttModule::SetExternalsymbols(turn, "glyph.auth", "smufl");
                 AttModule::SetExternalsymbols(turn, "glyph.num", "U+E56B");
             }
         }
-        if (!std::strncmp(xmlTurn.node().name(), "delayed", 7)) {
+        if (!std::strncmp(xmlTurn.name(), "delayed", 7)) {
             turn->SetDelayed(BOOLEAN_true);
         }
-        if (!std::strncmp(xmlTurn.node().name(), "vertical", 8)) {
+        if (!std::strncmp(xmlTurn.name(), "vertical", 8)) {
             turn->SetType("vertical");
             AttModule::SetExternalsymbols(turn, "glyph.auth", "smufl");
             AttModule::SetExternalsymbols(turn, "glyph.num", "U+E56A");
@@ -3549,11 +3681,12 @@ void MusicXmlInput::ReadMusicXmlNote(
     }
 
     // arpeggio
-    pugi::xpath_node xmlArpeggiate = notations.node().select_node("*[contains(name(), 'arpeggiate')]");
+    pugi::xml_node xmlArpeggiate = notations.find_child(
+        [](pugi::xml_node child) { return std::strstr(child.name(), "arpeggiate") != NULL; });
     if (xmlArpeggiate) {
-        short int arpegN = xmlArpeggiate.node().attribute("number").as_int();
+        short int arpegN = xmlArpeggiate.attribute("number").as_int();
         arpegN = (arpegN < 1) ? 1 : arpegN;
-        const std::string direction = xmlArpeggiate.node().attribute("direction").as_string();
+        const std::string direction = xmlArpeggiate.attribute("direction").as_string();
         bool added = false;
         if (!m_ArpeggioStack.empty()) { // check existing arpeggios
             for (auto iter = m_ArpeggioStack.begin(); iter != m_ArpeggioStack.end(); ++iter) {
@@ -3569,7 +3702,7 @@ void MusicXmlInput::ReadMusicXmlNote(
             Arpeg *arpeggio = new Arpeg();
             arpeggio->GetPlistInterface()->AddRef("#" + element->GetID());
             // color
-            arpeggio->SetColor(xmlArpeggiate.node().attribute("color").as_string());
+            arpeggio->SetColor(xmlArpeggiate.attribute("color").as_string());
             // direction (up/down) and in MEI arrow
             if (!direction.empty()) {
                 arpeggio->SetArrow(BOOLEAN_true);
@@ -3583,7 +3716,7 @@ void MusicXmlInput::ReadMusicXmlNote(
                     arpeggio->SetOrder(arpegLog_ORDER_NONE);
                 }
             }
-            if (!std::strncmp(xmlArpeggiate.node().name(), "non", 3)) {
+            if (!std::strncmp(xmlArpeggiate.name(), "non", 3)) {
                 arpeggio->SetOrder(arpegLog_ORDER_nonarp);
             }
             m_ArpeggioStack.push_back({ arpeggio, musicxml::OpenArpeggio(arpegN, onset) });
@@ -3593,24 +3726,27 @@ void MusicXmlInput::ReadMusicXmlNote(
 
     // tremolo end
     if (tremolo) {
-        if (HasAttributeWithValue(tremolo.node(), "type", "stop")) {
+        if (HasAttributeWithValue(tremolo, "type", "stop")) {
             RemoveLastFromStack(FTREM, layer);
         }
-        else if (!HasAttributeWithValue(tremolo.node(), "type", "start") && !isChord) {
+        else if (!HasAttributeWithValue(tremolo, "type", "start") && !isChord) {
             RemoveLastFromStack(BTREM, layer);
         }
     }
 
     // tuplet end
-    pugi::xpath_node tupletEnd = node.select_node("notations/tuplet[@type='stop']");
+    pugi::xml_node tupletEnd = this->GetGrandChildWithAttribute(node, "notations", "tuplet", "type", "stop");
     if (tupletEnd) {
         RemoveLastFromStack(TUPLET, layer);
     }
 
     // beam end
-    bool beamEnd = node.select_node("beam[text()='end']");
+    bool beamEnd = this->GetBeamWithValue(node, "end");
     if (beamEnd) {
-        int breakSec = (int)node.select_nodes("beam[text()='continue']").size();
+        int breakSec = 0;
+        for (pugi::xml_node beam : node.children("beam")) {
+            if (HasContentWithValue(beam, "continue")) ++breakSec;
+        }
         if (breakSec) {
             if (element->Is(NOTE)) {
                 Note *note = vrv_cast<Note *>(element);
@@ -3706,76 +3842,60 @@ void MusicXmlInput::ReadMusicXmlPrint(pugi::xml_node node, Section *section)
 
 bool MusicXmlInput::ReadMusicXmlBeamsAndTuplets(const pugi::xml_node &node, Layer *layer, bool isChord)
 {
-    pugi::xpath_node beamStart = node.select_node("beam[@number='1' and text()='begin']");
-    pugi::xpath_node tupletStart = node.select_node("notations/tuplet[@type='start']");
-    pugi::xpath_node currentMeasure = node.select_node("ancestor::measure");
-
-    pugi::xml_node beamEnd = node.select_node("./following-sibling::note[beam[@number='1' and text()='end']]").node();
-    pugi::xml_node tupletEnd = node.select_node("./following-sibling::note[notations/tuplet[@type='stop']]").node();
+    pugi::xml_node beamStart = this->GetBeamWithValue(node, "begin", 1);
+    pugi::xml_node tupletStart = this->GetGrandChildWithAttribute(node, "notations", "tuplet", "type", "start");
 
-    const auto measureNodeChildren = currentMeasure.node().children();
-    std::vector<pugi::xml_node> currentMeasureNodes(measureNodeChildren.begin(), measureNodeChildren.end());
-    // in case note is a start of both beam and tuplet - need to figure which one is longer
-    if (beamStart && tupletStart) {
-        const auto beamEndIterator = std::find(currentMeasureNodes.begin(), currentMeasureNodes.end(), beamEnd);
-        const auto tupletEndIterator = std::find(currentMeasureNodes.begin(), currentMeasureNodes.end(), tupletEnd);
+    if (!beamStart) {
+        // no special logic needed if we have just tupletStart - just read it as is
+        if (tupletStart && !isChord) ReadMusicXmlTupletStart(node, tupletStart, layer);
+        return true;
+    }
 
-        // find distance between iterator, i.e. whether beam or tuplet ends first.
-        // Negative number - beam ends first, positive - tuplet, zero - both are of the same length
-        const int distance = static_cast<int>(std::distance(beamEndIterator, tupletEndIterator));
-        if (distance > 0) {
-            if (!isChord) ReadMusicXmlTupletStart(node, tupletStart.node(), layer);
-            ReadMusicXmlBeamStart(node, beamStart.node(), layer);
+    // find the position of the following notes ending the beam and the tuplet in a single pass
+    pugi::xml_node beamEnd;
+    int beamEndPosition = INT_MAX;
+    int tupletEndPosition = INT_MAX;
+    int position = 0;
+    for (pugi::xml_node nextNote = node.next_sibling("note"); nextNote; nextNote = nextNote.next_sibling("note")) {
+        ++position;
+        if (!beamEnd && this->GetBeamWithValue(nextNote, "end", 1)) {
+            beamEnd = nextNote;
+            beamEndPosition = position;
         }
-        else {
-            ReadMusicXmlBeamStart(node, beamStart.node(), layer);
-            if (!isChord) ReadMusicXmlTupletStart(node, tupletStart.node(), layer);
-        }
-    }
-    // If note is a start of the beam only - check if there is a tuplet starting/ending in the span of
-    // the whole duration of this beam
-    else if (beamStart) {
-        // find whether there is a tuplet that starts during the span of the beam
-        pugi::xpath_node nextTupletStart
-            = node.select_node("./following-sibling::note[notations/tuplet[@type='start']]").node();
-
-        // find start and end of the beam
-        const auto beamStartIterator = std::find(currentMeasureNodes.begin(), currentMeasureNodes.end(), node);
-        const auto beamEndIterator = std::find(beamStartIterator, currentMeasureNodes.end(), beamEnd);
-
-        // find staff number for the corresponding elements - we do not want to match beam start on one staff with beam
-        // end on another
-        pugi::xpath_node nodeStaff = node.select_node("staff");
-        pugi::xpath_node endBeamStaff = beamEnd.select_node("staff");
-
-        if (beamEndIterator == currentMeasureNodes.end()
-            || (nodeStaff && endBeamStaff
-                && (nodeStaff.node().text().as_int() != endBeamStaff.node().text().as_int()))) {
-            std::string measureName = (currentMeasure.node().attribute("id"))
-                ? currentMeasure.node().attribute("id").as_string()
-                : currentMeasure.node().attribute("number").as_string();
-            LogDebug("MusicXML import: Beam without end in measure %s treated as <beamSpan>", measureName.c_str());
-            return false;
-        }
-        // form vector of the beam nodes and find whether there are tuplets that start or end within the beam
-        std::vector<pugi::xml_node> beamNodes(beamStartIterator, beamEndIterator + 1);
-        bool isTupletStartInBeam
-            = (beamNodes.end() != std::find(beamNodes.begin(), beamNodes.end(), nextTupletStart.node()));
-        bool isTupletEndInBeam = (beamNodes.end() != std::find(beamNodes.begin(), beamNodes.end(), tupletEnd));
-        // in case if there is only start/end of the tuplet in the beam, then we need to use beamSpan instead
-        if ((tupletEnd != beamEnd) && (isTupletStartInBeam != isTupletEndInBeam)) {
-            // TODO: same call as in else-case is intentional. Proper beamSpan support will need to be implemented
-            // before this case can be handled correctly
-            ReadMusicXmlBeamStart(node, beamStart.node(), layer);
+        if ((tupletEndPosition == INT_MAX)
+            && this->GetGrandChildWithAttribute(nextNote, "notations", "tuplet", "type", "stop")) {
+            tupletEndPosition = position;
+        }
+        if (beamEnd && (!tupletStart || (tupletEndPosition != INT_MAX))) break;
+    }
+
+    // in case note is a start of both beam and tuplet - need to figure which one is longer
+    if (tupletStart) {
+        // the tuplet ending last (or without end) is the outer element and is read first
+        if (tupletEndPosition > beamEndPosition) {
+            if (!isChord) ReadMusicXmlTupletStart(node, tupletStart, layer);
+            ReadMusicXmlBeamStart(node, beamStart, layer);
         }
         else {
-            ReadMusicXmlBeamStart(node, beamStart.node(), layer);
+            ReadMusicXmlBeamStart(node, beamStart, layer);
+            if (!isChord) ReadMusicXmlTupletStart(node, tupletStart, layer);
         }
+        return true;
     }
-    // no special logic needed if we have just tupletStart - just read it as is
-    else if (tupletStart) {
-        if (!isChord) ReadMusicXmlTupletStart(node, tupletStart.node(), layer);
+
+    // If note is a start of the beam only - we do not want to match beam start on one staff with beam end on another
+    pugi::xml_node nodeStaff = node.child("staff");
+    pugi::xml_node endBeamStaff = beamEnd.child("staff");
+    if (!beamEnd || (nodeStaff && endBeamStaff && (nodeStaff.text().as_int() != endBeamStaff.text().as_int()))) {
+        pugi::xml_node currentMeasure = node.parent();
+        std::string measureName = (currentMeasure.attribute("id")) ? currentMeasure.attribute("id").as_string()
+                                                                   : currentMeasure.attribute("number").as_string();
+        LogDebug("MusicXML import: Beam without end in measure %s treated as <beamSpan>", measureName.c_str());
+        return false;
     }
+    // TODO: a tuplet starting or ending only within the span of the beam would need a beamSpan. Proper beamSpan
+    // support will need to be implemented before this case can be handled correctly
+    ReadMusicXmlBeamStart(node, beamStart, layer);
 
     return true;
 }
@@ -3789,11 +3909,11 @@ void MusicXmlInput::ReadMusicXmlTupletStart(const pugi::xml_node &node, const pu
     Tuplet *tuplet = new Tuplet();
     AddLayerElement(layer, tuplet);
     m_elementStackMap.at(layer).push_back(tuplet);
-    short int num = node.select_node("time-modification/actual-notes").node().text().as_int();
-    short int numbase = node.select_node("time-modification/normal-notes").node().text().as_int();
+    short int num = this->GetGrandChild(node, "time-modification", "actual-notes").text().as_int();
+    short int numbase = this->GetGrandChild(node, "time-modification", "normal-notes").text().as_int();
     if (tupletStart.first_child()) {
-        num = tupletStart.select_node("tuplet-actual/tuplet-number").node().text().as_int();
-        numbase = tupletStart.select_node("tuplet-normal/tuplet-number").node().text().as_int();
+        num = this->GetGrandChild(tupletStart, "tuplet-actual", "tuplet-number").text().as_int();
+        numbase = this->GetGrandChild(tupletStart, "tuplet-normal", "tuplet-number").text().as_int();
     }
     if (num) tuplet->SetNum(num);
     if (numbase) tuplet->SetNumbase(numbase);
@@ -3806,7 +3926,10 @@ void MusicXmlInput::ReadMusicXmlTupletStart(const pugi::xml_node &node, const pu
 
 void MusicXmlInput::ReadMusicXmlBeamStart(const pugi::xml_node &node, const pugi::xml_node &beamStart, Layer *layer)
 {
-    if (!beamStart || (node.select_node("notations/ornaments/tremolo[@type='start']"))) return;
+    if (!beamStart) return;
+    for (pugi::xml_node notations : node.children("notations")) {
+        if (this->GetGrandChildWithAttribute(notations, "ornaments", "tremolo", "type", "start")) return;
+    }
     if (m_elementStackMap.at(layer).size() > 0 && m_elementStackMap.at(layer).back()->Is(BEAM)) {
         LogDebug("MusicXML import: Adding a beam to a beam");
         if (!node.child("grace")) return;
@@ -4658,17 +4781,15 @@ bool MusicXmlInput::IsMultirestMeasure(int index) const
 
 std::pair<std::vector<int>, int> MusicXmlInput::GetMeterSigGrpValues(const pugi::xml_node &node, MeterSigGrp *parent)
 {
-    pugi::xpath_node_set beats = node.select_nodes("beats");
-    pugi::xpath_node_set beat_type = node.select_nodes("beat-type");
     int maxUnit = 0;
     std::vector<int> meterCounts;
-    for (auto iter1 = beats.begin(), iter2 = beat_type.begin(); (iter1 != beats.end()) && (iter2 != beat_type.end());
-         ++iter1, ++iter2) {
+    for (pugi::xml_node beats = node.child("beats"), beatType = node.child("beat-type"); beats && beatType;
+         beats = beats.next_sibling("beats"), beatType = beatType.next_sibling("beat-type")) {
         // Process current beat/beat-type combination and add it to the meterSigGrp
         MeterSig *meterSig = new MeterSig();
-        data_METERCOUNT_pair count = meterSig->AttMeterSigLog::StrToMetercountPair(iter1->node().text().as_string());
+        data_METERCOUNT_pair count = meterSig->AttMeterSigLog::StrToMetercountPair(beats.text().as_string());
         meterSig->SetCount(count);
-        int currentUnit = iter2->node().text().as_int();
+        int currentUnit = beatType.text().as_int();
         meterSig->SetUnit(currentUnit);
         parent->AddChild(meterSig);
         std::vector<int> currentCount;
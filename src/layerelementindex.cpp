@@ -0,0 +1,166 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        layerelementindex.cpp
+// Author:      Marco Martinelli
+// Created:     17/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "layerelementindex.h"
+
+//----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+
+//----------------------------------------------------------------------------
+
+#include "findlayerelementsfunctor.h"
+#include "layer.h"
+#include "layerelement.h"
+#include "measure.h"
+#include "staff.h"
+#include "system.h"
+
+namespace vrv {
+
+//----------------------------------------------------------------------------
+// LayerElementIndex
+//----------------------------------------------------------------------------
+
+LayerElementIndex::LayerElementIndex()
+{
+    m_elementCount = 0;
+    m_isBuilt = false;
+}
+
+void LayerElementIndex::Build(const System *system)
+{
+    assert(system);
+
+    this->Reset();
+
+    BuildLayerElementIndexFunctor buildLayerElementIndex(this);
+    system->Process(buildLayerElementIndex);
+
+    this->Sort();
+    m_isBuilt = true;
+}
+
+void LayerElementIndex::Reset()
+{
+    m_lists.clear();
+    m_measures.clear();
+    m_measureIdx.clear();
+    m_elementCount = 0;
+    m_isBuilt = false;
+}
+
+void LayerElementIndex::AddElement(const LayerElement *layerElement, int measureIdx)
+{
+    assert(layerElement);
+
+    const Entry entry{ layerElement->GetContentLeft(), layerElement->GetContentRight(), m_elementCount++, measureIdx,
+        layerElement };
+    const ClassId classId = layerElement->GetClassId();
+
+    // The element is listed with its parent staff and its cross staff, if any
+    const Staff *staff = layerElement->GetAncestorStaff();
+    m_lists[{ classId, staff->GetN() }].m_entries.push_back(entry);
+
+    const Layer *layer = NULL;
+    const Staff *crossStaff = layerElement->GetCrossStaff(layer);
+    if (crossStaff && (crossStaff->GetN() != staff->GetN())) {
+        m_lists[{ classId, crossStaff->GetN() }].m_entries.push_back(entry);
+    }
+}
+
+void LayerElementIndex::AddMeasure(const Measure *measure)
+{
+    assert(measure);
+
+    m_measureIdx[measure] = (int)m_measures.size();
+    m_measures.push_back(measure);
+}
+
+void LayerElementIndex::Sort()
+{
+    for (auto &[key, list] : m_lists) {
+        std::stable_sort(list.m_entries.begin(), list.m_entries.end(),
+            [](const Entry &entry1, const Entry &entry2) { return (entry1.m_left < entry2.m_left); });
+        for (const Entry &entry : list.m_entries) {
+            list.m_maxWidth = std::max(list.m_maxWidth, entry.m_right - entry.m_left);
+        }
+    }
+}
+
+int LayerElementIndex::GetStartMeasureIdx(const Measure *startMeasure) const
+{
+    if (!startMeasure || m_measures.empty()) return 0;
+
+    auto iter = m_measureIdx.find(startMeasure);
+    if (iter != m_measureIdx.end()) return iter->second;
+
+    // The start measure is in another system, either before or after this one
+    return Object::IsPreOrdered(startMeasure, m_measures.front()) ? 0 : (int)m_measures.size();
+}
+
+int LayerElementIndex::GetEndMeasureIdx(const Measure *endMeasure) const
+{
+    if (!endMeasure || m_measures.empty()) return (int)m_measures.size();
+
+    auto iter = m_measureIdx.find(endMeasure);
+    if (iter != m_measureIdx.end()) return iter->second;
+
+    // The end measure is in another system, either before or after this one
+    return Object::IsPreOrdered(m_measures.back(), endMeasure) ? (int)m_measures.size() : -1;
+}
+
+std::vector<const LayerElement *> LayerElementIndex::FindElements(const std::vector<ClassId> &classIds,
+    const std::set<int> &staffNs, int minPos, int maxPos, const Measure *startMeasure,
+    const Measure *endMeasure) const
+{
+    assert(m_isBuilt);
+
+    const int startMeasureIdx = this->GetStartMeasureIdx(startMeasure);
+    const int endMeasureIdx = this->GetEndMeasureIdx(endMeasure);
+
+    std::vector<std::pair<int, const LayerElement *>> found;
+    auto findInList = [&](const EntryList &list) {
+        // An entry overlapping minPos cannot start before minPos - maxWidth
+        auto first = std::upper_bound(list.m_entries.begin(), list.m_entries.end(), minPos - list.m_maxWidth,
+            [](int pos, const Entry &entry) { return (pos < entry.m_left); });
+        for (auto iter = first; (iter != list.m_entries.end()) && (iter->m_left < maxPos); ++iter) {
+            if (iter->m_right <= minPos) continue;
+            if ((iter->m_measureIdx < startMeasureIdx) || (iter->m_measureIdx > endMeasureIdx)) continue;
+            found.push_back({ iter->m_order, iter->m_element });
+        }
+    };
+
+    for (const ClassId classId : std::set<ClassId>(classIds.begin(), classIds.end())) {
+        if (staffNs.empty()) {
+            auto iter = m_lists.lower_bound({ classId, VRV_UNSET });
+            for (; (iter != m_lists.end()) && (iter->first.first == classId); ++iter) {
+                findInList(iter->second);
+            }
+        }
+        else {
+            for (const int staffN : staffNs) {
+                auto iter = m_lists.find({ classId, staffN });
+                if (iter != m_lists.end()) findInList(iter->second);
+            }
+        }
+    }
+
+    // Return the elements in traversal order, without the ones listed with two staves
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+
+    std::vector<const LayerElement *> elements;
+    elements.reserve(found.size());
+    for (const auto &entry : found) {
+        elements.push_back(entry.second);
+    }
+    return elements;
+}
+
+} // namespace vrv
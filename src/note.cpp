@@ -191,6 +191,7 @@ void Note::AddChild(Object *child)
     else {
         children.push_back(child);
     }
+    this->OnChildAdded(child);
     Modify();
 }
 
@@ -67,6 +67,7 @@ namespace vrv {
 
 thread_local unsigned long Object::s_objectCounter = 0;
 thread_local uint32_t Object::s_xmlIDCounter = 0;
+Object::ClassRegistration Object::s_classRegistry[UNSPECIFIED + 1];
 
 Object::Object() : BoundingBox()
 {
@@ -111,10 +112,8 @@ Object::Object(const Object &object) : BoundingBox(object)
     m_isAttribute = object.m_isAttribute;
     m_isModified = true;
     m_isReferenceObject = object.m_isReferenceObject;
+    m_isAttachedToDoc = false;
 
-    // Also copy attribute classes
-    m_attClasses = object.m_attClasses;
-    m_interfaces = object.m_interfaces;
     // New id
     this->GenerateID();
     // For now do not copy them
@@ -157,10 +156,8 @@ Object &Object::operator=(const Object &object)
         m_isAttribute = object.m_isAttribute;
         m_isModified = true;
         m_isReferenceObject = object.m_isReferenceObject;
+        m_isAttachedToDoc = false;
 
-        // Also copy attribute classes
-        m_attClasses = object.m_attClasses;
-        m_interfaces = object.m_interfaces;
         // New id
         this->GenerateID();
         // For now do now copy them
@@ -200,6 +197,7 @@ void Object::Init(ClassId classId, const std::string &classIdStr)
     m_isAttribute = false;
     m_isModified = true;
     m_isReferenceObject = false;
+    m_isAttachedToDoc = (classId == DOC);
     // Comments
     m_comment = "";
     m_closingComment = "";
@@ -245,8 +243,54 @@ void Object::Reset()
 
 void Object::RegisterInterface(std::vector<AttClassId> *attClasses, InterfaceId interfaceId)
 {
-    m_attClasses.insert(m_attClasses.end(), attClasses->begin(), attClasses->end());
-    m_interfaces.push_back(interfaceId);
+    ClassRegistration &registration = s_classRegistry[m_classId];
+    // Already registered for the class - nothing to do
+    if (registration.HasInterface(interfaceId)) return;
+
+    for (AttClassId attClassId : *attClasses) {
+        registration.AddAttClass(attClassId);
+    }
+    // Set the interface bit last so its att classes are visible once it is
+    registration.m_interfaces.fetch_or(uint64_t(1) << interfaceId, std::memory_order_release);
+}
+
+int Object::ClassRegistration::GetAttClassCount() const
+{
+    int count = 0;
+    for (const std::atomic<uint64_t> &word : m_attClasses) {
+        for (uint64_t bits = word.load(std::memory_order_relaxed); bits; bits &= bits - 1) ++count;
+    }
+    return count;
+}
+
+int Object::ClassRegistration::GetInterfaceCount() const
+{
+    int count = 0;
+    for (uint64_t bits = m_interfaces.load(std::memory_order_relaxed); bits; bits &= bits - 1) ++count;
+    return count;
+}
+
+void Object::LogClassReport() const
+{
+    std::map<ClassId, std::pair<std::string, int>> counts;
+    int objectCount = 0;
+    std::function<void(const Object *)> countObjects = [&counts, &objectCount, &countObjects](const Object *object) {
+        auto result = counts.insert({ object->GetClassId(), { object->GetClassName(), 0 } });
+        ++result.first->second.second;
+        ++objectCount;
+        // Children of reference objects are not owned and counted elsewhere
+        if (object->IsReferenceObject()) return;
+        for (const Object *child : object->m_children) countObjects(child);
+    };
+    countObjects(this);
+
+    for (const auto &[classId, count] : counts) {
+        const ClassRegistration &registration = s_classRegistry[classId];
+        LogDebug("%s: %d object(s), %d att class(es), %d interface(s)", count.first.c_str(), count.second,
+            registration.GetAttClassCount(), registration.GetInterfaceCount());
+    }
+    LogInfo("%d object(s) of %d class(es), class registry of %d bytes", objectCount, (int)counts.size(),
+        (int)sizeof(s_classRegistry));
 }
 
 bool Object::IsMilestoneElement()
@@ -306,9 +350,11 @@ void Object::ReplaceChild(Object *currentChild, Object *replacingChild)
     assert(this->GetChildIndex(replacingChild) == -1);
 
     int idx = this->GetChildIndex(currentChild);
+    this->OnChildRemoved(currentChild);
     currentChild->ResetParent();
     m_children.at(idx) = replacingChild;
     replacingChild->SetParent(this);
+    this->OnChildAdded(replacingChild);
     this->Modify();
 }
 
@@ -371,6 +417,7 @@ void Object::ClearChildren()
         // we need to check if this is the parent
         // ownership might have been given up with Relinquish
         if ((*iter)->GetParent() == this) {
+            this->OnChildRemoved(*iter);
             delete *iter;
         }
     }
@@ -525,10 +572,12 @@ void Object::InsertChild(Object *element, int idx)
 
     if (idx >= (int)m_children.size()) {
         m_children.push_back(element);
-        return;
     }
-    ArrayOfObjects::iterator iter = m_children.begin();
-    m_children.insert(iter + (idx), element);
+    else {
+        ArrayOfObjects::iterator iter = m_children.begin();
+        m_children.insert(iter + (idx), element);
+    }
+    this->OnChildAdded(element);
 }
 
 Object *Object::DetachChild(int idx)
@@ -537,6 +586,7 @@ Object *Object::DetachChild(int idx)
         return NULL;
     }
     Object *child = m_children.at(idx);
+    this->OnChildRemoved(child);
     child->ResetParent();
     ArrayOfObjects::iterator iter = m_children.begin();
     m_children.erase(iter + (idx));
@@ -565,6 +615,7 @@ Object *Object::Relinquish(int idx)
         return NULL;
     }
     Object *child = m_children.at(idx);
+    this->OnChildRemoved(child);
     child->ResetParent();
     return child;
 }
@@ -589,6 +640,20 @@ Object *Object::FindDescendantByID(const std::string &id, int deepness, bool dir
 
 const Object *Object::FindDescendantByID(const std::string &id, int deepness, bool direction) const
 {
+    // Use the xml:id index of the document when the whole subtree is searched
+    const Object *element = NULL;
+    if ((deepness == UNLIMITED_DEPTH) && (direction == FORWARD) && this->FindInDocIDIndex(id, element)) {
+#ifdef VRV_CHECK_ID_INDEX
+        FindByIDFunctor checkByID(id);
+        this->Process(checkByID, deepness, true);
+        if (checkByID.GetElement() != element) {
+            LogError("Inconsistent xml:id index for '%s'", id.c_str());
+            assert(false);
+        }
+#endif
+        return element;
+    }
+
     FindByIDFunctor findByID(id);
     findByID.SetDirection(direction);
     this->Process(findByID, deepness, true);
@@ -740,6 +805,7 @@ bool Object::DeleteChild(Object *child)
     if (it != m_children.end()) {
         m_children.erase(it);
         if (!m_isReferenceObject) {
+            this->OnChildRemoved(child);
             delete child;
         }
         this->Modify();
@@ -757,7 +823,10 @@ int Object::DeleteChildrenByComparison(Comparison *comparison)
     ArrayOfObjects::iterator iter;
     for (iter = m_children.begin(); iter != m_children.end();) {
         if ((*comparison)(*iter)) {
-            if (!m_isReferenceObject) delete *iter;
+            if (!m_isReferenceObject) {
+                this->OnChildRemoved(*iter);
+                delete *iter;
+            }
             iter = m_children.erase(iter);
             ++count;
         }
@@ -774,9 +843,19 @@ void Object::GenerateID()
     m_id = m_classIdStr.at(0) + Object::GenerateHashID();
 }
 
+void Object::SetID(const std::string &id)
+{
+    // Changing the id of an object in the tree invalidates the xml:id index
+    if (m_isAttachedToDoc && (m_id != id)) {
+        Doc *doc = this->GetRootDoc();
+        if (doc) doc->InvalidateIDIndex();
+    }
+    m_id = id;
+}
+
 void Object::ResetID()
 {
-    GenerateID();
+    this->SetID(m_classIdStr.at(0) + Object::GenerateHashID());
 }
 
 void Object::SetParent(Object *parent)
@@ -820,9 +899,93 @@ void Object::AddChild(Object *child)
         i = std::min(i, (int)m_children.size());
         m_children.insert(m_children.begin() + i, child);
     }
+    this->OnChildAdded(child);
     Modify();
 }
 
+void Object::OnChildAdded(Object *child)
+{
+    assert(child);
+
+    if (!m_isAttachedToDoc || m_isReferenceObject) return;
+
+    Doc *doc = this->GetRootDoc();
+    if (doc) {
+        child->UpdateIDIndex(doc, true);
+        doc->ResetTimemapIndex();
+    }
+}
+
+void Object::OnChildRemoved(Object *child)
+{
+    assert(child);
+
+    if (!child->m_isAttachedToDoc || m_isReferenceObject) return;
+
+    Doc *doc = this->GetRootDoc();
+    if (doc) {
+        child->UpdateIDIndex(doc, false);
+        doc->ResetTimemapIndex();
+    }
+}
+
+void Object::UpdateIDIndex(Doc *doc, bool attached)
+{
+    assert(doc);
+
+    m_isAttachedToDoc = attached;
+    if (doc->IsIDIndexValid()) {
+        if (attached) {
+            doc->AddToIDIndex(this);
+        }
+        else {
+            doc->RemoveFromIDIndex(this);
+        }
+    }
+
+    if (m_isReferenceObject) return;
+
+    for (Object *child : m_children) {
+        // Skip children that have been relinquished
+        if (child->m_parent == this) child->UpdateIDIndex(doc, attached);
+    }
+}
+
+Doc *Object::GetRootDoc()
+{
+    return const_cast<Doc *>(std::as_const(*this).GetRootDoc());
+}
+
+const Doc *Object::GetRootDoc() const
+{
+    const Object *root = this;
+    while (root->m_parent) {
+        root = root->m_parent;
+    }
+    return (root->Is(DOC)) ? vrv_cast<const Doc *>(root) : NULL;
+}
+
+bool Object::FindInDocIDIndex(const std::string &id, const Object *&element) const
+{
+    if (!m_isAttachedToDoc) return false;
+
+    const Doc *doc = this->GetRootDoc();
+    if (!doc) return false;
+
+    element = doc->FindInIDIndex(id);
+    // The index holds all the objects in the tree, including hidden ones
+    if (!element) return true;
+
+    // The element must be a descendant reached by the functor processing, which skips the object itself and the
+    // hidden content. Otherwise, there can still be another object with the same id, so we need to process the tree.
+    for (const Object *ancestor = element->m_parent; ancestor; ancestor = ancestor->m_parent) {
+        if (ancestor->SkipChildren(true)) break;
+        if (ancestor == this) return true;
+    }
+    element = NULL;
+    return false;
+}
+
 int Object::GetInsertOrderForIn(ClassId classId, const std::vector<ClassId> &order) const
 {
     std::vector<ClassId>::const_iterator classIdIt = std::find(order.begin(), order.end(), classId);
@@ -1126,6 +1289,89 @@ void Object::Process(ConstFunctor &functor, int deepness, bool skipFirst) const
     }
 }
 
+template <class FUNCTOR, class OBJECT>
+void Object::ProcessComposite(OBJECT *object, std::vector<FUNCTOR *> &functors, size_t first, bool direction)
+{
+    // Keep only the functors that were not stopped
+    size_t end = first;
+    for (size_t i = first; i < functors.size(); ++i) {
+        if (functors.at(i)->GetCode() != FUNCTOR_STOP) functors.at(end++) = functors.at(i);
+    }
+    functors.resize(end);
+    if (end == first) return;
+
+    // Update the current score stored in the document
+    const_cast<Object *>(static_cast<const Object *>(object))->UpdateDocumentScore(direction);
+
+    // Visit the object and keep the functors going deeper, which are also the ones calling the end interface
+    size_t visitEnd = first;
+    for (size_t i = first; i < end; ++i) {
+        FUNCTOR *functor = functors.at(i);
+        assert(functor->GetDirection() == direction);
+        FunctorCode code = object->Accept(*functor);
+        functor->SetCode(code);
+        if (code == FUNCTOR_SIBLINGS) {
+            functor->SetCode(FUNCTOR_CONTINUE);
+        }
+        else {
+            functors.at(visitEnd++) = functor;
+        }
+    }
+    functors.resize(visitEnd);
+
+    // The functors processing a child are pushed after the ones of this object
+    auto processChild = [object, &functors, first, visitEnd, direction](OBJECT *child) {
+        const size_t childFirst = functors.size();
+        for (size_t i = first; i < visitEnd; ++i) {
+            FUNCTOR *functor = functors.at(i);
+            if (functor->GetCode() == FUNCTOR_STOP) continue;
+            if (object->SkipChildren(functor->VisibleOnly())) continue;
+            // we will end here if there is no filter at all or for the current child type
+            if (!object->FiltersApply(functor->GetFilters(), child)) continue;
+            functors.push_back(functor);
+        }
+        if (functors.size() > childFirst) ProcessComposite(child, functors, childFirst, direction);
+        functors.resize(childFirst);
+    };
+
+    if (visitEnd > first) {
+        if (direction == BACKWARD) {
+            for (auto iter = object->m_children.rbegin(); iter != object->m_children.rend(); ++iter) {
+                processChild(*iter);
+            }
+        }
+        else {
+            for (auto iter = object->m_children.begin(); iter != object->m_children.end(); ++iter) {
+                processChild(*iter);
+            }
+        }
+    }
+
+    for (size_t i = first; i < visitEnd; ++i) {
+        FUNCTOR *functor = functors.at(i);
+        if (functor->ImplementsEndInterface()) {
+            FunctorCode code = object->AcceptEnd(*functor);
+            functor->SetCode(code);
+        }
+    }
+}
+
+void Object::Process(CompositeFunctor &composite)
+{
+    std::vector<Functor *> functors = composite.GetFunctors();
+    if (functors.empty()) return;
+
+    ProcessComposite(this, functors, 0, composite.GetDirection());
+}
+
+void Object::Process(ConstCompositeFunctor &composite) const
+{
+    std::vector<ConstFunctor *> functors = composite.GetFunctors();
+    if (functors.empty()) return;
+
+    ProcessComposite(this, functors, 0, composite.GetDirection());
+}
+
 FunctorCode Object::Accept(Functor &functor)
 {
     return functor.VisitObject(this);
@@ -1194,7 +1440,7 @@ bool Object::SkipChildren(bool visibleOnly) const
     return false;
 }
 
-bool Object::FiltersApply(const Filters *filters, Object *object) const
+bool Object::FiltersApply(const Filters *filters, const Object *object) const
 {
     return filters ? filters->Apply(object) : true;
 }
@@ -0,0 +1,197 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        objectarena.cpp
+// Author:      Marco Martinelli
+// Created:     17/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "objectarena.h"
+
+//----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+//----------------------------------------------------------------------------
+
+#include "vrv.h"
+
+namespace vrv {
+
+//----------------------------------------------------------------------------
+// ObjectArena
+//----------------------------------------------------------------------------
+
+thread_local ObjectArena *ObjectArena::s_current = NULL;
+thread_local unsigned long ObjectArena::s_heapAllocationCount = 0;
+std::atomic<int> ObjectArena::s_arenaCount(0);
+std::atomic<std::atomic<ObjectArena *> *> ObjectArena::s_chunkOwners[ObjectArena::s_leafCount];
+std::mutex ObjectArena::s_chunkOwnersMutex;
+
+ObjectArena::ObjectArena()
+{
+    m_currentChunk = 0;
+    m_chunkOffset = 0;
+    m_freeLists.resize(s_maxBlockSize / s_alignment + 1, NULL);
+    m_released = false;
+
+    m_allocationCount = 0;
+    m_reuseCount = 0;
+    m_liveCount = 0;
+    m_rewindCount = 0;
+
+    ++s_arenaCount;
+}
+
+ObjectArena::~ObjectArena()
+{
+    assert(m_liveCount == 0);
+
+    // The owner is unregistered before the chunk is freed and its memory possibly given to objects on the heap
+    for (char *chunk : m_chunks) {
+        SetChunkOwner(chunk, NULL);
+        ::operator delete(chunk, std::align_val_t(s_chunkSize));
+    }
+
+    --s_arenaCount;
+}
+
+void ObjectArena::Release()
+{
+    assert(!m_released);
+
+    m_released = true;
+    if (m_liveCount == 0) delete this;
+}
+
+void *ObjectArena::Allocate(size_t blockSize)
+{
+    assert(blockSize % s_alignment == 0);
+    assert(blockSize <= s_maxBlockSize);
+
+    // First look for a freed block of the same size
+    void *&freeList = m_freeLists.at(blockSize / s_alignment);
+    if (freeList) {
+        void *block = freeList;
+        freeList = *static_cast<void **>(block);
+        ++m_allocationCount;
+        ++m_liveCount;
+        ++m_reuseCount;
+        return block;
+    }
+
+    if (m_currentChunk < m_chunks.size() && (m_chunkOffset + blockSize > s_chunkSize)) {
+        ++m_currentChunk;
+        m_chunkOffset = 0;
+    }
+    if (m_currentChunk == m_chunks.size()) {
+        // The chunk is aligned on its size so that it covers a single chunk number
+        char *chunk = static_cast<char *>(::operator new(s_chunkSize, std::align_val_t(s_chunkSize)));
+        if (!SetChunkOwner(chunk, this)) {
+            ::operator delete(chunk, std::align_val_t(s_chunkSize));
+            return NULL;
+        }
+        m_chunks.push_back(chunk);
+    }
+    void *block = m_chunks.at(m_currentChunk) + m_chunkOffset;
+    m_chunkOffset += blockSize;
+    ++m_allocationCount;
+    ++m_liveCount;
+    return block;
+}
+
+void ObjectArena::Free(void *block, size_t blockSize)
+{
+    assert(m_liveCount > 0);
+
+    void *&freeList = m_freeLists.at(blockSize / s_alignment);
+    *static_cast<void **>(block) = freeList;
+    freeList = block;
+
+    if (--m_liveCount > 0) return;
+
+    // The arena is empty
+    if (m_released) {
+        delete this;
+    }
+    else {
+        this->Rewind();
+    }
+}
+
+void ObjectArena::Rewind()
+{
+    std::fill(m_freeLists.begin(), m_freeLists.end(), (void *)NULL);
+    m_currentChunk = 0;
+    m_chunkOffset = 0;
+    ++m_rewindCount;
+}
+
+void ObjectArena::LogStatistics() const
+{
+    LogInfo("Object arena: %lu allocation(s) (%lu recycled), %lu alive, %lu rewind(s), %.1f MB reserved",
+        m_allocationCount, m_reuseCount, m_liveCount, m_rewindCount, this->GetReservedBytes() / (1024.0 * 1024.0));
+}
+
+ObjectArena *ObjectArena::FindArena(void *ptr)
+{
+    const uintptr_t chunkNumber = reinterpret_cast<uintptr_t>(ptr) >> s_chunkBits;
+    const uintptr_t leafIndex = chunkNumber >> s_leafBits;
+    if (leafIndex >= s_leafCount) return NULL;
+
+    // A chunk of an arena still alive cannot hold an object on the heap, so no lock is needed
+    std::atomic<ObjectArena *> *leaf = s_chunkOwners[leafIndex].load(std::memory_order_acquire);
+    if (!leaf) return NULL;
+    return leaf[chunkNumber & (((uintptr_t)1 << s_leafBits) - 1)].load(std::memory_order_acquire);
+}
+
+bool ObjectArena::SetChunkOwner(const char *chunk, ObjectArena *arena)
+{
+    const uintptr_t chunkNumber = reinterpret_cast<uintptr_t>(chunk) >> s_chunkBits;
+    const uintptr_t leafIndex = chunkNumber >> s_leafBits;
+    if (leafIndex >= s_leafCount) return false;
+
+    std::atomic<ObjectArena *> *leaf = s_chunkOwners[leafIndex].load(std::memory_order_acquire);
+    if (!leaf) {
+        // Only the creation of the leaves needs the lock
+        std::lock_guard<std::mutex> lock(s_chunkOwnersMutex);
+        leaf = s_chunkOwners[leafIndex].load(std::memory_order_relaxed);
+        if (!leaf) {
+            leaf = new std::atomic<ObjectArena *>[(size_t)1 << s_leafBits]();
+            s_chunkOwners[leafIndex].store(leaf, std::memory_order_release);
+        }
+    }
+    leaf[chunkNumber & (((uintptr_t)1 << s_leafBits) - 1)].store(arena, std::memory_order_release);
+    return true;
+}
+
+void *ObjectArena::AllocateObject(size_t size)
+{
+    ObjectArena *arena = s_current;
+    if (arena && (GetBlockSize(size) <= s_maxBlockSize)) {
+        // NULL if a chunk could not be registered, in which case the object is allocated on the heap
+        void *block = arena->Allocate(GetBlockSize(size));
+        if (block) return block;
+    }
+
+    ++s_heapAllocationCount;
+    return ::operator new(size);
+}
+
+void ObjectArena::FreeObject(void *ptr, size_t size)
+{
+    if (!ptr) return;
+
+    // Without any arena, the object is on the heap and the chunk owners do not need to be looked up
+    if (s_arenaCount > 0) {
+        ObjectArena *arena = FindArena(ptr);
+        if (arena) {
+            arena->Free(ptr, GetBlockSize(size));
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+} // namespace vrv
@@ -916,6 +916,13 @@ Options::Options()
     m_allPages.SetShortOption('a', true);
     m_baseOptions.AddOption(&m_allPages);
 
+    m_batch.SetInfo("Batch", "Process the inputs listed in a file (\"-\" for the standard input) with one path or "
+                             "one JSON object per line");
+    m_batch.Init("");
+    m_batch.SetKey("batch");
+    m_batch.SetShortOption('b', true);
+    m_baseOptions.AddOption(&m_batch);
+
     m_inputFrom.SetInfo("Input from",
         "Select input format from: \"abc\", \"darms\", \"humdrum\", \"mei\", \"pae\", \"xml\" (musicxml)");
     m_inputFrom.Init("mei");
@@ -923,6 +930,14 @@ Options::Options()
     m_inputFrom.SetShortOption('f', false);
     m_baseOptions.AddOption(&m_inputFrom);
 
+    m_threads.SetInfo("Threads",
+        "Number of threads for rendering all pages to SVG or for processing a batch (0 for the number of hardware "
+        "threads)");
+    m_threads.Init(1, 0, 256);
+    m_threads.SetKey("threads");
+    m_threads.SetShortOption('j', true);
+    m_baseOptions.AddOption(&m_threads);
+
     m_logLevel.SetInfo("Log level", "Set the log level: \"off\", \"error\", \"warning\", \"info\", or \"debug\"");
     m_logLevel.Init("warning");
     m_logLevel.SetKey("logLevel");
@@ -1077,6 +1092,11 @@ Options::Options()
     m_noJustification.Init(false);
     this->Register(&m_noJustification, "noJustification", &m_general);
 
+    m_objectArena.SetInfo("Object arena",
+        "Allocate the objects of the document in an arena, which reduces the allocation and deallocation costs");
+    m_objectArena.Init(false);
+    this->Register(&m_objectArena, "objectArena", &m_general);
+
     m_openControlEvents.SetInfo("Open control event", "Render open control events");
     m_openControlEvents.Init(false);
     this->Register(&m_openControlEvents, "openControlEvents", &m_general);
@@ -1131,6 +1151,11 @@ Options::Options()
     m_preserveAnalyticalMarkup.Init(false);
     this->Register(&m_preserveAnalyticalMarkup, "preserveAnalyticalMarkup", &m_general);
 
+    m_progressiveLayout.SetInfo("Progressive layout",
+        "Cast off the pages progressively when they are requested instead of all of them when loading");
+    m_progressiveLayout.Init(false);
+    this->Register(&m_progressiveLayout, "progressiveLayout", &m_general);
+
     m_removeIds.SetInfo("Remove IDs in MEI", "Remove XML IDs in the MEI output that are not referenced");
     m_removeIds.Init(false);
     this->Register(&m_removeIds, "removeIds", &m_general);
@@ -1140,6 +1165,11 @@ Options::Options()
     m_scaleToPageSize.Init(false);
     this->Register(&m_scaleToPageSize, "scaleToPageSize", &m_general);
 
+    m_showClassReport.SetInfo("Show class report on CLI",
+        "Display the number of objects per class and the size of the class registry with the runtime");
+    m_showClassReport.Init(false);
+    this->Register(&m_showClassReport, "showClassReport", &m_general);
+
     m_showRuntime.SetInfo("Show runtime on CLI", "Display the total runtime on command-line");
     m_showRuntime.Init(false);
     this->Register(&m_showRuntime, "showRuntime", &m_general);
@@ -1828,10 +1858,10 @@ Options::Options()
     */
 }
 
-Options::Options(const Options &options)
+Options::Options(const Options &options) : Options()
 {
-    LogDebug("Copy constructor not implemented for Options");
-    assert(false);
+    // The members are registered by the default constructor and only the option values are copied
+    *this = options;
 }
 
 Options &Options::operator=(const Options &options)
@@ -1851,6 +1881,14 @@ Options &Options::operator=(const Options &options)
         iter->second->CopyTo(opt);
     }
 
+    // The base options (e.g., the scale or the xml:id seed) are not registered and are listed in the same order
+    const std::vector<Option *> *baseOptions = options.GetBaseOptions();
+    const std::vector<Option *> *ownBaseOptions = this->GetBaseOptions();
+    assert(baseOptions->size() == ownBaseOptions->size());
+    for (int i = 0; i < (int)baseOptions->size(); ++i) {
+        baseOptions->at(i)->CopyTo(ownBaseOptions->at(i));
+    }
+
     return *this;
 }
 
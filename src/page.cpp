@@ -85,6 +85,8 @@ void Page::Reset()
     m_score = NULL;
     m_scoreEnd = NULL;
     m_layoutDone = false;
+    m_headerLayout.Reset();
+    m_footerLayout.Reset();
     this->ResetID();
 
     // by default we have no values and use the document ones
@@ -189,12 +191,15 @@ const RunningElement *Page::GetFooter() const
 void Page::LayOut(bool force)
 {
     if (m_layoutDone && !force) {
-        // We only need to reset the header - this will adjust the page number if necessary
-        if (this->GetHeader()) this->GetHeader()->SetDrawingPage(this);
-        if (this->GetFooter()) this->GetFooter()->SetDrawingPage(this);
+        // We only need to reset the header and the footer - this will adjust the page number if necessary
+        this->ResetRunningElements();
         return;
     }
 
+    // The layout stored for the header and the footer must not be restored while laying out the page
+    m_headerLayout.Reset();
+    m_footerLayout.Reset();
+
     this->LayOutHorizontally();
     this->JustifyHorizontally();
     this->LayOutVertically();
@@ -211,9 +216,26 @@ void Page::LayOut(bool force)
         view.DrawCurrentPage(&bBoxDC, false);
     }
 
+    if (this->GetHeader()) m_headerLayout.Store(this->GetHeader());
+    if (this->GetFooter()) m_footerLayout.Store(this->GetFooter());
+
     m_layoutDone = true;
 }
 
+void Page::ResetRunningElements()
+{
+    RunningElement *header = this->GetHeader();
+    if (header) {
+        header->SetDrawingPage(this);
+        m_headerLayout.Restore(header);
+    }
+    RunningElement *footer = this->GetFooter();
+    if (footer) {
+        footer->SetDrawingPage(this);
+        m_footerLayout.Restore(footer);
+    }
+}
+
 void Page::LayOutTranscription(bool force)
 {
     if (m_layoutDone && !force) {
@@ -564,7 +586,7 @@ void Page::LayOutVertically()
 
     // Adjust system Y position
     AlignSystemsFunctor alignSystems(doc);
-    alignSystems.SetShift(doc->m_drawingPageContentHeight);
+    alignSystems.SetShift(doc->GetDrawingContext().m_drawingPageContentHeight);
     alignSystems.SetSystemSpacing(doc->GetOptions()->m_spacingSystem.GetValue() * doc->GetDrawingUnit(100));
     this->Process(alignSystems);
 }
@@ -582,15 +604,16 @@ void Page::JustifyHorizontally()
     // Make sure we have the correct page
     assert(this == doc->GetDrawingPage());
 
+    DrawingContext &context = doc->GetDrawingContext();
     if ((doc->GetOptions()->m_adjustPageWidth.GetValue())) {
-        doc->m_drawingPageContentWidth = this->GetContentWidth();
-        doc->m_drawingPageWidth
-            = doc->m_drawingPageContentWidth + doc->m_drawingPageMarginLeft + doc->m_drawingPageMarginRight;
+        context.m_drawingPageContentWidth = this->GetContentWidth();
+        context.m_drawingPageWidth
+            = context.m_drawingPageContentWidth + context.m_drawingPageMarginLeft + context.m_drawingPageMarginRight;
     }
     else {
         // Justify X position
         JustifyXFunctor justifyX(doc);
-        justifyX.SetSystemFullWidth(doc->m_drawingPageContentWidth);
+        justifyX.SetSystemFullWidth(context.m_drawingPageContentWidth);
         this->Process(justifyX);
     }
 }
@@ -660,10 +683,10 @@ bool Page::IsJustificationRequired(const Doc *doc)
             if (childSystems * stavesPerSystem < 8) return false;
         }
     }
-    const double ratio = (double)m_drawingJustifiableHeight / (double)doc->m_drawingPageHeight;
+    const int pageHeight = doc->GetDrawingContext().m_drawingPageHeight;
+    const double ratio = (double)m_drawingJustifiableHeight / (double)pageHeight;
     if (ratio > doc->GetOptions()->m_justificationMaxVertical.GetValue()) {
-        m_drawingJustifiableHeight
-            = doc->m_drawingPageHeight * doc->GetOptions()->m_justificationMaxVertical.GetValue();
+        m_drawingJustifiableHeight = pageHeight * doc->GetOptions()->m_justificationMaxVertical.GetValue();
     }
 
     return true;
@@ -701,7 +724,7 @@ int Page::GetContentHeight() const
 
     const System *last = vrv_cast<const System *>(this->GetLast(SYSTEM));
     assert(last);
-    int height = doc->m_drawingPageContentHeight - last->GetDrawingYRel() + last->GetHeight();
+    int height = doc->GetDrawingContext().m_drawingPageContentHeight - last->GetDrawingYRel() + last->GetHeight();
 
     if (this->GetFooter()) {
         height += this->GetFooter()->GetTotalHeight(doc);
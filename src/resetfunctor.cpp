@@ -86,6 +86,8 @@ FunctorCode ResetDataFunctor::VisitBeam(Beam *beam)
     // Call parent one too
     this->VisitLayerElement(beam);
     beam->BeamDrawingInterface::Reset();
+    // The coords have to be initialized again since the beam staff is reset
+    beam->ClearCoords();
 
     beam->m_beamSegment.Reset();
     beam->SetStemSameasBeam(NULL);
@@ -638,6 +640,7 @@ FunctorCode ResetHorizontalAlignmentFunctor::VisitSystem(System *system)
 {
     system->SetDrawingXRel(0);
     system->ResetDrawingAbbrLabelsWidth();
+    system->ResetLayerElementIndex();
 
     return FUNCTOR_CONTINUE;
 }
@@ -9,10 +9,13 @@
 
 //----------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cassert>
 #include <string>
 
 //----------------------------------------------------------------------------
 
+#include "embeddedresources.h"
 #include "smufl.h"
 #include "vrv.h"
 #include "vrvdef.h"
@@ -30,6 +33,8 @@ namespace vrv {
 thread_local std::string Resources::s_defaultPath = VRV_RESOURCE_DIR;
 const Resources::StyleAttributes Resources::k_defaultStyle{ data_FONTWEIGHT::FONTWEIGHT_normal,
     data_FONTSTYLE::FONTSTYLE_normal };
+Resources::FontTablesRegistry Resources::s_fontTablesRegistry;
+std::mutex Resources::s_fontTablesRegistryMutex;
 
 //----------------------------------------------------------------------------
 // Function defined in toolkitdef.h
@@ -47,19 +52,45 @@ void SetDefaultResourcePath(const std::string &path)
 Resources::Resources()
 {
     m_path = s_defaultPath;
+    m_fontTables = std::make_shared<FontTables>();
     m_currentStyle = k_defaultStyle;
 }
 
 bool Resources::InitFonts()
+{
+    // The default fonts are loaded only once for a resource path and the glyph tables are then shared
+    std::lock_guard<std::mutex> lock(s_fontTablesRegistryMutex);
+
+    const FontTablesRegistry::key_type key = { m_path, "" };
+    if (s_fontTablesRegistry.count(key) == 0) {
+        std::shared_ptr<FontTables> fontTables = std::make_shared<FontTables>();
+        if (!this->LoadDefaultFonts(*fontTables)) {
+            // Keep what could be loaded but do not share it
+            m_fontTables = fontTables;
+            m_defaultFontTables = NULL;
+            return false;
+        }
+        s_fontTablesRegistry[key] = fontTables;
+    }
+
+    m_fontTables = s_fontTablesRegistry.at(key);
+    m_defaultFontTables = m_fontTables;
+    m_currentStyle = k_defaultStyle;
+
+    return true;
+}
+
+bool Resources::LoadDefaultFonts(FontTables &fontTables) const
 {
     // We will need to rethink this for adding the option to add custom fonts
     // Font Bravura first since it is expected to have always all symbols
-    if (!LoadFont("Bravura", false)) LogError("Bravura font could not be loaded.");
+    if (!LoadFont(fontTables, "Bravura", false)) LogError("Bravura font could not be loaded.");
     // The Leipzig as the default font
-    if (!LoadFont("Leipzig", false)) LogError("Leipzig font could not be loaded.");
+    if (!LoadFont(fontTables, "Leipzig", false)) LogError("Leipzig font could not be loaded.");
 
-    if (m_fontGlyphTable.size() < SMUFL_COUNT) {
-        LogError("Expected %d default SMuFL glyphs but could load only %d.", SMUFL_COUNT, m_fontGlyphTable.size());
+    if (fontTables.m_fontGlyphTable.size() < SMUFL_COUNT) {
+        LogError("Expected %d default SMuFL glyphs but could load only %d.", SMUFL_COUNT,
+            fontTables.m_fontGlyphTable.size());
         return false;
     }
 
@@ -75,35 +106,76 @@ bool Resources::InitFonts()
               { { FONTWEIGHT_normal, FONTSTYLE_italic }, "Times-italic", false } };
 
     for (const auto &textFontInfo : textFontInfos) {
-        if (!InitTextFont(textFontInfo.m_fileName, textFontInfo.m_style) && textFontInfo.m_isMandatory) {
+        if (!LoadTextFont(fontTables, textFontInfo.m_fileName, textFontInfo.m_style) && textFontInfo.m_isMandatory) {
             LogError("Text font could not be initialized.");
             return false;
         }
     }
 
-    m_currentStyle = k_defaultStyle;
+    return true;
+}
+
+bool Resources::InitTextFont(const std::string &fontName, const StyleAttributes &style)
+{
+    // The text font is loaded into a copy of the glyph tables that is not shared
+    std::shared_ptr<FontTables> fontTables = std::make_shared<FontTables>(*m_fontTables);
+    if (!this->LoadTextFont(*fontTables, fontName, style)) return false;
 
+    m_fontTables = fontTables;
     return true;
 }
 
 bool Resources::SetFont(const std::string &fontName)
 {
-    return LoadFont(fontName);
+    // Without default fonts, the font is loaded into a copy of the current glyph tables that is not shared
+    if (!m_defaultFontTables) {
+        std::shared_ptr<FontTables> fontTables = std::make_shared<FontTables>(*m_fontTables);
+        if (!this->LoadFont(*fontTables, fontName)) return false;
+
+        m_fontTables = fontTables;
+        return true;
+    }
+
+    // Otherwise, the font is loaded on top of the default fonts only once and the glyph tables are then shared
+    std::lock_guard<std::mutex> lock(s_fontTablesRegistryMutex);
+
+    const FontTablesRegistry::key_type key = { m_path, fontName };
+    if (s_fontTablesRegistry.count(key) == 0) {
+        // The default fonts are loaded again rather than copied to keep the glyphs in the order they are loaded
+        std::shared_ptr<FontTables> fontTables = std::make_shared<FontTables>();
+        if (!this->LoadDefaultFonts(*fontTables) || !this->LoadFont(*fontTables, fontName)) return false;
+        s_fontTablesRegistry[key] = fontTables;
+    }
+
+    m_fontTables = s_fontTablesRegistry.at(key);
+    return true;
 }
 
 const Glyph *Resources::GetGlyph(char32_t smuflCode) const
 {
-    return m_fontGlyphTable.count(smuflCode) ? &m_fontGlyphTable.at(smuflCode) : NULL;
+    // SMuFL glyphs are looked up directly in the index
+    const std::vector<const Glyph *> &privateUseGlyphs = m_fontTables->m_privateUseGlyphs;
+    if ((smuflCode >= k_privateUseFirst) && (smuflCode - k_privateUseFirst < privateUseGlyphs.size())) {
+        return privateUseGlyphs[smuflCode - k_privateUseFirst];
+    }
+
+    const GlyphTable &fontGlyphTable = m_fontTables->m_fontGlyphTable;
+    auto iter = fontGlyphTable.find(smuflCode);
+    return (iter != fontGlyphTable.end()) ? &iter->second : NULL;
 }
 
 const Glyph *Resources::GetGlyph(const std::string &smuflName) const
 {
-    return m_glyphNameTable.count(smuflName) ? &m_fontGlyphTable.at(m_glyphNameTable.at(smuflName)) : NULL;
+    const GlyphNameTable &glyphNameTable = m_fontTables->m_glyphNameTable;
+    auto iter = glyphNameTable.find(smuflName);
+    return (iter != glyphNameTable.end()) ? this->GetGlyph(iter->second) : NULL;
 }
 
 char32_t Resources::GetGlyphCode(const std::string &smuflName) const
 {
-    return m_glyphNameTable.count(smuflName) ? m_glyphNameTable.at(smuflName) : 0;
+    const GlyphNameTable &glyphNameTable = m_fontTables->m_glyphNameTable;
+    auto iter = glyphNameTable.find(smuflName);
+    return (iter != glyphNameTable.end()) ? iter->second : 0;
 }
 
 bool Resources::IsSmuflFallbackNeeded(const std::u32string &text) const
@@ -126,7 +198,7 @@ void Resources::SelectTextFont(data_FONTWEIGHT fontWeight, data_FONTSTYLE fontSt
     }
 
     m_currentStyle = { fontWeight, fontStyle };
-    if (m_textFont.count(m_currentStyle) == 0) {
+    if (m_fontTables->m_textFont.count(m_currentStyle) == 0) {
         LogWarning("Text font for style (%d, %d) is not loaded. Use default", fontWeight, fontStyle);
         m_currentStyle = k_defaultStyle;
     }
@@ -134,15 +206,13 @@ void Resources::SelectTextFont(data_FONTWEIGHT fontWeight, data_FONTSTYLE fontSt
 
 const Glyph *Resources::GetTextGlyph(char32_t code) const
 {
-    const StyleAttributes style = (m_textFont.count(m_currentStyle) != 0) ? m_currentStyle : k_defaultStyle;
-    if (m_textFont.count(style) == 0) return NULL;
-
-    const GlyphTable &currentTable = m_textFont.at(style);
-    if (currentTable.count(code) == 0) {
-        return NULL;
-    }
+    const GlyphTextMap &textFont = m_fontTables->m_textFont;
+    const StyleAttributes style = (textFont.count(m_currentStyle) != 0) ? m_currentStyle : k_defaultStyle;
+    if (textFont.count(style) == 0) return NULL;
 
-    return &currentTable.at(code);
+    const GlyphTable &currentTable = textFont.at(style);
+    auto iter = currentTable.find(code);
+    return (iter != currentTable.end()) ? &iter->second : NULL;
 }
 
 char32_t Resources::GetSmuflGlyphForUnicodeChar(const char32_t unicodeChar)
@@ -158,8 +228,14 @@ char32_t Resources::GetSmuflGlyphForUnicodeChar(const char32_t unicodeChar)
     return smuflChar;
 }
 
-bool Resources::LoadFont(const std::string &fontName, bool withFallback)
+bool Resources::LoadFont(FontTables &fontTables, const std::string &fontName, bool withFallback) const
 {
+#ifdef VRV_EMBED_RESOURCES
+    // Fonts compiled into the library are loaded without reading the resource directory
+    const EmbeddedFont *embeddedFont = this->UseEmbeddedResources() ? GetEmbeddedFont(fontName) : NULL;
+    if (embeddedFont) return this->LoadEmbeddedFont(fontTables, *embeddedFont, withFallback);
+#endif
+
     pugi::xml_document doc;
     const std::string filename = Resources::GetPath() + "/" + fontName + ".xml";
     pugi::xml_parse_result parseResult = doc.load_file(filename.c_str());
@@ -175,7 +251,7 @@ bool Resources::LoadFont(const std::string &fontName, bool withFallback)
     }
 
     if (withFallback) {
-        for (auto &glyph : m_fontGlyphTable) {
+        for (auto &glyph : fontTables.m_fontGlyphTable) {
             glyph.second.SetFallback(true);
         }
     }
@@ -212,16 +288,22 @@ bool Resources::LoadFont(const std::string &fontName, bool withFallback)
 
         const char32_t smuflCode = (char32_t)strtol(c_attribute.value(), NULL, 16);
         glyph.SetFallback(false);
-        m_fontGlyphTable[smuflCode] = glyph;
-        m_glyphNameTable[n_attribute.value()] = smuflCode;
+        fontTables.m_fontGlyphTable[smuflCode] = glyph;
+        fontTables.m_glyphNameTable[n_attribute.value()] = smuflCode;
     }
 
-    m_fontName = fontName;
+    fontTables.m_fontName = fontName;
+    fontTables.IndexGlyphs();
     return true;
 }
 
-bool Resources::InitTextFont(const std::string &fontName, const StyleAttributes &style)
+bool Resources::LoadTextFont(FontTables &fontTables, const std::string &fontName, const StyleAttributes &style) const
 {
+#ifdef VRV_EMBED_RESOURCES
+    const EmbeddedFont *embeddedFont = this->UseEmbeddedResources() ? GetEmbeddedTextFont(fontName) : NULL;
+    if (embeddedFont) return this->LoadEmbeddedTextFont(fontTables, *embeddedFont, style);
+#endif
+
     // For the text font, we load the bounding boxes only
     pugi::xml_document doc;
     // For now, we have only Times bounding boxes for ASCII chars
@@ -240,10 +322,10 @@ bool Resources::InitTextFont(const std::string &fontName, const StyleAttributes
     }
     const int unitsPerEm = root.attribute("units-per-em").as_int();
     pugi::xml_node current;
-    if (m_textFont.count(style) == 0) {
-        m_textFont[style] = {};
+    if (fontTables.m_textFont.count(style) == 0) {
+        fontTables.m_textFont[style] = {};
     }
-    GlyphTable &currentTable = m_textFont.at(style);
+    GlyphTable &currentTable = fontTables.m_textFont.at(style);
     for (current = root.child("g"); current; current = current.next_sibling("g")) {
         if (current.attribute("c")) {
             char32_t code = (char32_t)strtol(current.attribute("c").value(), NULL, 16);
@@ -268,4 +350,167 @@ bool Resources::InitTextFont(const std::string &fontName, const StyleAttributes
     return true;
 }
 
+//----------------------------------------------------------------------------
+// Resources::FontTables
+//----------------------------------------------------------------------------
+
+Resources::FontTables::FontTables(const FontTables &fontTables)
+    : m_fontName(fontTables.m_fontName)
+    , m_fontGlyphTable(fontTables.m_fontGlyphTable)
+    , m_textFont(fontTables.m_textFont)
+    , m_glyphNameTable(fontTables.m_glyphNameTable)
+{
+    // The index of the copy points to the glyphs of its own table
+    this->IndexGlyphs();
+}
+
+void Resources::FontTables::IndexGlyphs()
+{
+    m_privateUseGlyphs.assign(k_privateUseLast - k_privateUseFirst + 1, NULL);
+    for (const auto &[code, glyph] : m_fontGlyphTable) {
+        if ((code >= k_privateUseFirst) && (code <= k_privateUseLast)) {
+            m_privateUseGlyphs[code - k_privateUseFirst] = &glyph;
+        }
+    }
+}
+
+#ifdef VRV_EMBED_RESOURCES
+
+bool Resources::LoadEmbeddedFont(FontTables &fontTables, const EmbeddedFont &embeddedFont, bool withFallback) const
+{
+    if (withFallback) {
+        for (auto &glyph : fontTables.m_fontGlyphTable) {
+            glyph.second.SetFallback(true);
+        }
+    }
+
+    for (int i = 0; i < embeddedFont.m_glyphCount; ++i) {
+        const EmbeddedGlyph &embeddedGlyph = embeddedFont.m_glyphs[i];
+
+        // Values are converted to float as when they are read from the XML file
+        Glyph glyph;
+        glyph.SetUnitsPerEm(embeddedFont.m_unitsPerEm * 10);
+        glyph.SetCodeStr(embeddedGlyph.m_codeStr);
+        glyph.SetBoundingBox((float)embeddedGlyph.m_x, (float)embeddedGlyph.m_y, (float)embeddedGlyph.m_width,
+            (float)embeddedGlyph.m_height);
+        glyph.SetPath(Resources::GetPath() + "/" + embeddedFont.m_name + "/" + embeddedGlyph.m_codeStr + ".xml");
+        glyph.SetEmbeddedXML(embeddedGlyph.m_xml);
+        glyph.SetHorizAdvX((float)embeddedGlyph.m_horizAdvX);
+
+        for (int j = 0; j < embeddedGlyph.m_anchorCount; ++j) {
+            const EmbeddedAnchor &anchor = embeddedGlyph.m_anchors[j];
+            glyph.SetAnchor(anchor.m_name, (float)anchor.m_x, (float)anchor.m_y);
+        }
+
+        glyph.SetFallback(false);
+        fontTables.m_fontGlyphTable[embeddedGlyph.m_code] = glyph;
+        fontTables.m_glyphNameTable[embeddedGlyph.m_name] = embeddedGlyph.m_code;
+    }
+
+    fontTables.m_fontName = embeddedFont.m_name;
+    fontTables.IndexGlyphs();
+    return true;
+}
+
+bool Resources::LoadEmbeddedTextFont(
+    FontTables &fontTables, const EmbeddedFont &embeddedFont, const StyleAttributes &style) const
+{
+    if (fontTables.m_textFont.count(style) == 0) {
+        fontTables.m_textFont[style] = {};
+    }
+    GlyphTable &currentTable = fontTables.m_textFont.at(style);
+    for (int i = 0; i < embeddedFont.m_glyphCount; ++i) {
+        const EmbeddedGlyph &embeddedGlyph = embeddedFont.m_glyphs[i];
+        Glyph glyph(embeddedFont.m_unitsPerEm);
+        glyph.SetBoundingBox((float)embeddedGlyph.m_x, (float)embeddedGlyph.m_y, (float)embeddedGlyph.m_width,
+            (float)embeddedGlyph.m_height);
+        glyph.SetHorizAdvX((float)embeddedGlyph.m_horizAdvX);
+        if (currentTable.count(embeddedGlyph.m_code) > 0) {
+            LogDebug("Redefining %d with %s", embeddedGlyph.m_code, embeddedFont.m_name);
+        }
+        currentTable[embeddedGlyph.m_code] = glyph;
+    }
+    return true;
+}
+
+#endif
+
+//----------------------------------------------------------------------------
+// GlyphMetricsCache
+//----------------------------------------------------------------------------
+
+GlyphMetricsCache::GlyphMetricsCache()
+{
+    m_fontSize = 0;
+    m_graceFactor = 0.0;
+
+    this->Reset();
+}
+
+void GlyphMetricsCache::Reset()
+{
+    m_tables.clear();
+    m_lastTable = -1;
+}
+
+void GlyphMetricsCache::SetScaling(int fontSize, double graceFactor)
+{
+    if ((fontSize == m_fontSize) && (graceFactor == m_graceFactor)) return;
+
+    this->Reset();
+    m_fontSize = fontSize;
+    m_graceFactor = graceFactor;
+}
+
+const GlyphMetricsCache::Metrics &GlyphMetricsCache::GetMetrics(
+    const Resources &resources, char32_t code, int staffSize, bool graceSize)
+{
+    if ((code < Resources::k_privateUseFirst) || (code > Resources::k_privateUseLast)) {
+        this->CalcMetrics(resources.GetGlyph(code), staffSize, graceSize, m_uncachedMetrics);
+        return m_uncachedMetrics;
+    }
+
+    // Look for the table, starting with the last one used
+    if ((m_lastTable == -1) || (m_tables.at(m_lastTable).m_staffSize != staffSize)
+        || (m_tables.at(m_lastTable).m_graceSize != graceSize)) {
+        auto iter = std::find_if(m_tables.begin(), m_tables.end(), [staffSize, graceSize](const Table &table) {
+            return ((table.m_staffSize == staffSize) && (table.m_graceSize == graceSize));
+        });
+        if (iter == m_tables.end()) {
+            const int size = Resources::k_privateUseLast - Resources::k_privateUseFirst + 1;
+            iter = m_tables.insert(iter, { staffSize, graceSize, std::vector<Metrics>(size) });
+        }
+        m_lastTable = (int)(iter - m_tables.begin());
+    }
+
+    Metrics &metrics = m_tables[m_lastTable].m_metrics[code - Resources::k_privateUseFirst];
+    if (!metrics.m_isSet) {
+        this->CalcMetrics(resources.GetGlyph(code), staffSize, graceSize, metrics);
+    }
+    return metrics;
+}
+
+void GlyphMetricsCache::CalcMetrics(const Glyph *glyph, int staffSize, bool graceSize, Metrics &metrics) const
+{
+    assert(glyph);
+
+    int x, y, w, h;
+    glyph->GetBoundingBox(x, y, w, h);
+    int advX = glyph->GetHorizAdvX();
+
+    // Scaled in steps with integer truncation, as for the text glyphs and the font points
+    for (int *value : { &x, &y, &w, &h, &advX }) {
+        *value = *value * m_fontSize / glyph->GetUnitsPerEm();
+        if (graceSize) *value = *value * m_graceFactor;
+        *value = *value * staffSize / 100;
+    }
+
+    metrics.m_isSet = true;
+    metrics.m_x = x;
+    metrics.m_y = y;
+    metrics.m_width = w;
+    metrics.m_height = h;
+    metrics.m_advX = advX;
+}
+
 } // namespace vrv
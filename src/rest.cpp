@@ -218,6 +218,7 @@ void Rest::AddChild(Object *child)
     else {
         children.push_back(child);
     }
+    this->OnChildAdded(child);
     Modify();
 }
 
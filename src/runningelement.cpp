@@ -9,12 +9,14 @@
 
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
 
 //----------------------------------------------------------------------------
 
 #include "doc.h"
 #include "editorial.h"
+#include "embeddedresources.h"
 #include "fig.h"
 #include "functor.h"
 #include "num.h"
@@ -23,6 +25,7 @@
 #include "staff.h"
 #include "svg.h"
 #include "text.h"
+#include "textelement.h"
 #include "vrv.h"
 
 namespace vrv {
@@ -103,7 +106,7 @@ void RunningElement::SetDrawingYRel(int drawingYRel)
 
 int RunningElement::GetTotalWidth(const Doc *doc) const
 {
-    return (doc->m_drawingPageContentWidth);
+    return (doc->GetDrawingContext().m_drawingPageContentWidth);
 }
 
 void RunningElement::SetDrawingPage(Page *page)
@@ -141,10 +144,19 @@ void RunningElement::LoadFooter(const Doc *doc)
     Fig *fig = new Fig();
     Svg *svg = new Svg();
 
+    pugi::xml_document footerDoc;
     const Resources &resources = doc->GetResources();
     const std::string footerPath = resources.GetPath() + "/footer.svg";
-    pugi::xml_document footerDoc;
+#ifdef VRV_EMBED_RESOURCES
+    if (resources.UseEmbeddedResources()) {
+        footerDoc.load_string(GetEmbeddedFooter());
+    }
+    else {
+        footerDoc.load_file(footerPath.c_str());
+    }
+#else
     footerDoc.load_file(footerPath.c_str());
+#endif
     svg->Set(footerDoc.first_child());
     fig->AddChild(svg);
     fig->SetHalign(HORIZONTALALIGNMENT_center);
@@ -200,4 +212,82 @@ FunctorCode RunningElement::AcceptEnd(ConstFunctor &functor) const
     return functor.VisitRunningElementEnd(this);
 }
 
+//----------------------------------------------------------------------------
+// RunningElementLayout
+//----------------------------------------------------------------------------
+
+RunningElementLayout::RunningElementLayout()
+{
+    this->Reset();
+}
+
+void RunningElementLayout::Reset()
+{
+    m_runningElement = NULL;
+    m_drawingYRel = 0;
+    m_objects.clear();
+}
+
+void RunningElementLayout::Store(const RunningElement *runningElement)
+{
+    assert(runningElement);
+
+    this->Reset();
+
+    m_runningElement = runningElement;
+    m_drawingYRel = runningElement->GetDrawingYRel();
+
+    ListOfConstObjects objects;
+    ListObjects(runningElement, objects);
+    for (const Object *object : objects) {
+        ObjectLayout layout;
+        layout.m_object = object;
+        const TextElement *textElement = dynamic_cast<const TextElement *>(object);
+        layout.m_drawingXRel = (textElement) ? textElement->GetDrawingXRel() : 0;
+        layout.m_drawingYRel = (textElement) ? textElement->GetDrawingYRel() : 0;
+        layout.m_boundingBox = object->GetBoundingBoxValues();
+        m_objects.push_back(layout);
+    }
+}
+
+void RunningElementLayout::Restore(RunningElement *runningElement) const
+{
+    assert(runningElement);
+
+    if (m_runningElement != runningElement) return;
+
+    // Check that the content is the one stored before changing anything
+    ListOfConstObjects objects;
+    ListObjects(runningElement, objects);
+    if (objects.size() != m_objects.size()) return;
+    if (!std::equal(objects.begin(), objects.end(), m_objects.begin(),
+            [](const Object *object, const ObjectLayout &layout) { return (object == layout.m_object); })) {
+        return;
+    }
+
+    runningElement->SetDrawingYRel(m_drawingYRel);
+    for (const ObjectLayout &layout : m_objects) {
+        // The objects are the content of the running element we can modify
+        Object *object = const_cast<Object *>(layout.m_object);
+        TextElement *textElement = dynamic_cast<TextElement *>(object);
+        if (textElement) {
+            textElement->SetDrawingXRel(layout.m_drawingXRel);
+            textElement->SetDrawingYRel(layout.m_drawingYRel);
+        }
+        object->SetBoundingBoxValues(layout.m_boundingBox);
+    }
+}
+
+void RunningElementLayout::ListObjects(const Object *object, ListOfConstObjects &objects)
+{
+    objects.push_back(object);
+    // The text drawn for the page number is not a child of the num
+    if (object->Is(NUM)) {
+        objects.push_back(vrv_cast<const Num *>(object)->GetCurrentText());
+    }
+    for (const Object *child : object->GetChildren()) {
+        ListObjects(child, objects);
+    }
+}
+
 } // namespace vrv
@@ -9,6 +9,10 @@
 
 #ifndef NO_RUNTIME
 
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
 //----------------------------------------------------------------------------
 
 namespace vrv {
@@ -34,6 +38,22 @@ double RuntimeClock::GetSeconds() const
     return duration<double, seconds::period>(timeDiff).count();
 }
 
+size_t RuntimeClock::GetPeakMemory()
+{
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    // In kilobytes on Linux
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
 } // namespace vrv
 
 #endif // NO_RUNTIME
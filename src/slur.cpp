@@ -240,8 +240,13 @@ SpannedElements Slur::CollectSpannedElements(const Staff *staff, int xMin, int x
     }
     findSpannedLayerElements.SetStaffNs(staffNumbers);
 
-    // Run the search without layer bounds
-    container->Process(findSpannedLayerElements);
+    // Run the search without layer bounds, with the index of the system when searching the whole system
+    if (container->Is(SYSTEM)) {
+        findSpannedLayerElements.ProcessIndex(vrv_cast<const System *>(container)->GetLayerElementIndex());
+    }
+    else {
+        container->Process(findSpannedLayerElements);
+    }
 
     // Now determine the minimal and maximal layer
     std::set<int> layersN;
@@ -168,19 +168,17 @@ void SvgDeviceContext::Commit(bool xml_declaration)
     if (m_smuflGlyphs.size() > 0) {
 
         pugi::xml_node defs = m_svgNode.prepend_child("defs");
-        pugi::xml_document sourceDoc;
 
         // for each needed glyph
         for (const Glyph *smuflGlyph : m_smuflGlyphs) {
-            // load the XML file that contains it as a pugi::xml_document
-            std::ifstream source(smuflGlyph->GetPath());
-            sourceDoc.load(source);
+            // the XML of the glyph is loaded only once and kept in memory by the glyph
+            const pugi::xml_document &sourceDoc = smuflGlyph->GetXML();
 
             // copy all the nodes inside into the master document
             for (pugi::xml_node child = sourceDoc.first_child(); child; child = child.next_sibling()) {
                 std::string id = StringFormat("%s-%s", child.attribute("id").value(), m_glyphPostfixId.c_str());
-                child.attribute("id").set_value(id.c_str());
-                defs.append_copy(child);
+                pugi::xml_node copy = defs.append_copy(child);
+                copy.attribute("id").set_value(id.c_str());
             }
         }
     }
@@ -84,6 +84,8 @@ void System::Reset()
     m_castOffJustifiableWidth = 0;
     m_drawingAbbrLabelsWidth = 0;
     m_drawingIsOptimized = false;
+
+    m_layerElementIndex.Reset();
 }
 
 bool System::IsSupportedChild(Object *child)
@@ -284,6 +286,14 @@ bool System::HasMixedDrawingStemDir(const LayerElement *start, const LayerElemen
     return false;
 }
 
+const LayerElementIndex &System::GetLayerElementIndex() const
+{
+    if (!m_layerElementIndex.IsBuilt()) {
+        m_layerElementIndex.Build(this);
+    }
+    return m_layerElementIndex;
+}
+
 curvature_CURVEDIR System::GetPreferredCurveDirection(
     const LayerElement *start, const LayerElement *end, const Slur *slur) const
 {
@@ -294,7 +304,7 @@ curvature_CURVEDIR System::GetPreferredCurveDirection(
     const Layer *layerStart = vrv_cast<const Layer *>(start->GetFirstAncestor(LAYER));
     assert(layerStart);
 
-    this->Process(findSpannedLayerElements);
+    findSpannedLayerElements.ProcessIndex(this->GetLayerElementIndex());
 
     curvature_CURVEDIR preferredDirection = curvature_CURVEDIR_NONE;
     for (auto element : findSpannedLayerElements.GetElements()) {
@@ -419,8 +429,8 @@ double System::EstimateJustificationRatio(const Doc *doc) const
 
     const double nonJustifiableWidth
         = m_systemLeftMar + m_systemRightMar + m_castOffTotalWidth - m_castOffJustifiableWidth;
-    double estimatedRatio
-        = (double)(doc->m_drawingPageContentWidth - nonJustifiableWidth) / ((double)m_castOffJustifiableWidth);
+    const int contentWidth = doc->GetDrawingContext().m_drawingPageContentWidth;
+    double estimatedRatio = (double)(contentWidth - nonJustifiableWidth) / ((double)m_castOffJustifiableWidth);
 
     // Apply dampening and bound compression
     estimatedRatio *= 0.95;
@@ -77,6 +77,7 @@ void TabDurSym::AddChild(Object *child)
     else {
         children.push_back(child);
     }
+    this->OnChildAdded(child);
     Modify();
 }
 
@@ -9,10 +9,17 @@
 
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
 
 //----------------------------------------------------------------------------
 
+#include "comparison.h"
+#include "doc.h"
+#include "durationinterface.h"
 #include "jsonxx.h"
 #include "measure.h"
 #include "note.h"
@@ -94,4 +101,240 @@ void Timemap::ToJson(std::string &output, bool includeRests, bool includeMeasure
     output = timemap.json();
 }
 
+void Timemap::ToBinary(std::vector<unsigned char> &output, bool includeRests, bool includeMeasures)
+{
+    auto writeUint32 = [&output](uint32_t value) {
+        for (int i = 0; i < 4; ++i) output.push_back((value >> (8 * i)) & 0xFF);
+    };
+    auto writeDouble = [&output](double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 8; ++i) output.push_back((bits >> (8 * i)) & 0xFF);
+    };
+
+    // Build the id table
+    std::vector<const std::string *> ids;
+    std::unordered_map<std::string, uint32_t> idIndices;
+    auto getIdIndex = [&ids, &idIndices](const std::string &id) -> uint32_t {
+        auto [it, inserted] = idIndices.emplace(id, (uint32_t)ids.size());
+        if (inserted) ids.push_back(&it->first);
+        return it->second;
+    };
+
+    // The columns of ids of each entry
+    std::vector<uint32_t> columns[4];
+    std::vector<uint32_t> columnStarts[4];
+    std::vector<int32_t> measuresOn;
+    std::vector<double> tempos;
+    measuresOn.reserve(m_map.size());
+    tempos.reserve(m_map.size());
+
+    double currentTempo = 0.0;
+    for (auto &[tstamp, entry] : m_map) {
+        const std::vector<std::string> *entryIds[4] = { &entry.notesOn, &entry.notesOff, &entry.restsOn, &entry.restsOff };
+        for (int column = 0; column < 4; ++column) {
+            columnStarts[column].push_back((uint32_t)columns[column].size());
+            // Rests are in the last two columns
+            if ((column > 1) && !includeRests) continue;
+            for (const std::string &id : *entryIds[column]) {
+                columns[column].push_back(getIdIndex(id));
+            }
+        }
+        measuresOn.push_back((includeMeasures && !entry.measureOn.empty()) ? (int32_t)getIdIndex(entry.measureOn) : -1);
+        if (entry.tempo != -1000.0) currentTempo = entry.tempo;
+        tempos.push_back(currentTempo);
+    }
+    for (int column = 0; column < 4; ++column) {
+        columnStarts[column].push_back((uint32_t)columns[column].size());
+    }
+
+    output.clear();
+
+    // Header
+    for (const char c : { 'V', 'R', 'V', 'T' }) output.push_back(c);
+    writeUint32(1);
+    writeUint32((uint32_t)m_map.size());
+    writeUint32((uint32_t)ids.size());
+    for (int column = 0; column < 4; ++column) {
+        writeUint32((uint32_t)columns[column].size());
+    }
+
+    // Float64 columns
+    for (auto &[tstamp, entry] : m_map) writeDouble(tstamp);
+    for (auto &[tstamp, entry] : m_map) writeDouble(entry.qstamp);
+    for (double tempo : tempos) writeDouble(tempo);
+
+    // Int32 and uint32 columns
+    for (int32_t measureOn : measuresOn) writeUint32((uint32_t)measureOn);
+    for (int column = 0; column < 4; ++column) {
+        for (uint32_t start : columnStarts[column]) writeUint32(start);
+        for (uint32_t index : columns[column]) writeUint32(index);
+    }
+
+    // Id table
+    uint32_t idStart = 0;
+    for (const std::string *id : ids) {
+        writeUint32(idStart);
+        idStart += (uint32_t)id->size();
+    }
+    writeUint32(idStart);
+    for (const std::string *id : ids) {
+        output.insert(output.end(), id->begin(), id->end());
+    }
+}
+
+//----------------------------------------------------------------------------
+// TimemapIndex
+//----------------------------------------------------------------------------
+
+TimemapIndex::TimemapIndex()
+{
+    this->Reset();
+}
+
+TimemapIndex::~TimemapIndex() {}
+
+void TimemapIndex::Reset()
+{
+    m_isBuilt = false;
+    m_measures.clear();
+    m_measurePositions.clear();
+    m_measureRepeats.clear();
+    m_measureRepeatIntervals.Clear();
+}
+
+void TimemapIndex::Build(const Doc *doc)
+{
+    assert(doc);
+
+    this->Reset();
+
+    ListOfConstObjects measures;
+    ClassIdComparison matchMeasure(MEASURE);
+    doc->FindAllDescendantsByComparison(&measures, &matchMeasure);
+
+    m_measures.reserve(measures.size());
+    ClassIdsComparison matchNoteOrRest({ NOTE, REST });
+    for (const Object *object : measures) {
+        const Measure *measure = vrv_cast<const Measure *>(object);
+        assert(measure);
+
+        const int position = (int)m_measures.size();
+        m_measurePositions.emplace(measure, position);
+        MeasureEntry &entry = m_measures.emplace_back();
+        entry.m_measure = measure;
+
+        // Each repeat of the measure is indexed with the interval checked by Measure::EnclosesTime
+        if (measure->GetRealTimeOffsetCount() > 0) {
+            const double duration = measure->GetRealTimeDurationMilliseconds();
+            for (int repeat = 1; repeat <= measure->GetRealTimeOffsetCount(); ++repeat) {
+                const double offset = measure->GetRealTimeOffsetMilliseconds(repeat);
+                m_measureRepeats.push_back({ position, repeat });
+                m_measureRepeatIntervals.Add(offset, offset + duration);
+            }
+        }
+
+        ListOfConstObjects notesOrRests;
+        measure->FindAllDescendantsByComparison(&notesOrRests, &matchNoteOrRest);
+        entry.m_notesOrRests.reserve(notesOrRests.size());
+        for (const Object *noteOrRest : notesOrRests) {
+            const DurationInterface *interface = noteOrRest->GetDurationInterface();
+            assert(interface);
+            entry.m_notesOrRests.push_back(noteOrRest);
+            entry.m_intervals.Add(interface->GetRealTimeOnsetMilliseconds(), interface->GetRealTimeOffsetMilliseconds());
+        }
+        entry.m_intervals.Sort();
+    }
+    m_measureRepeatIntervals.Sort();
+
+    m_isBuilt = true;
+}
+
+const Measure *TimemapIndex::GetMeasureAtTime(int time, int &repeat) const
+{
+    std::vector<int> values;
+    m_measureRepeatIntervals.FindValues(time, time, values);
+
+    repeat = 0;
+    if (values.empty()) return NULL;
+
+    // The first value is the first measure in the document order and its first repeat
+    const auto &[position, measureRepeat] = m_measureRepeats.at(values.front());
+    repeat = measureRepeat;
+    return m_measures.at(position).m_measure;
+}
+
+void TimemapIndex::GetMeasuresInTimeRange(
+    int startTime, int endTime, std::vector<std::pair<const Measure *, int>> &measures) const
+{
+    std::vector<int> values;
+    m_measureRepeatIntervals.FindValues(startTime, endTime, values);
+
+    measures.clear();
+    measures.reserve(values.size());
+    for (int value : values) {
+        const auto &[position, repeat] = m_measureRepeats.at(value);
+        measures.push_back({ m_measures.at(position).m_measure, repeat });
+    }
+}
+
+void TimemapIndex::GetNotesOrRestsInTimeRange(
+    const Measure *measure, int startTime, int endTime, ListOfConstObjects &notesOrRests) const
+{
+    notesOrRests.clear();
+
+    auto it = m_measurePositions.find(measure);
+    if (it == m_measurePositions.end()) return;
+    const MeasureEntry &entry = m_measures.at(it->second);
+
+    std::vector<int> values;
+    entry.m_intervals.FindValues(startTime, endTime, values);
+    for (int value : values) {
+        notesOrRests.push_back(entry.m_notesOrRests.at(value));
+    }
+}
+
+//----------------------------------------------------------------------------
+// TimemapIndex::IntervalList
+//----------------------------------------------------------------------------
+
+void TimemapIndex::IntervalList::Clear()
+{
+    m_intervals.clear();
+    m_maxOffsets.clear();
+}
+
+void TimemapIndex::IntervalList::Add(double onset, double offset)
+{
+    m_intervals.push_back({ onset, offset, (int)m_intervals.size() });
+}
+
+void TimemapIndex::IntervalList::Sort()
+{
+    std::stable_sort(m_intervals.begin(), m_intervals.end(),
+        [](const Interval &interval1, const Interval &interval2) { return interval1.m_onset < interval2.m_onset; });
+
+    m_maxOffsets.resize(m_intervals.size());
+    double maxOffset = 0.0;
+    for (int i = 0; i < (int)m_intervals.size(); ++i) {
+        maxOffset = (i == 0) ? m_intervals.at(i).m_offset : std::max(maxOffset, m_intervals.at(i).m_offset);
+        m_maxOffsets.at(i) = maxOffset;
+    }
+}
+
+void TimemapIndex::IntervalList::FindValues(double start, double end, std::vector<int> &values) const
+{
+    values.clear();
+
+    // The intervals starting after the end
+    auto it = std::upper_bound(m_intervals.begin(), m_intervals.end(), end,
+        [](double time, const Interval &interval) { return time < interval.m_onset; });
+
+    // Look backward as long as an interval (up to the current one) can end after the start
+    for (int i = (int)(it - m_intervals.begin()) - 1; (i >= 0) && (m_maxOffsets.at(i) >= start); --i) {
+        if (m_intervals.at(i).m_offset >= start) values.push_back(m_intervals.at(i).m_value);
+    }
+    std::sort(values.begin(), values.end());
+}
+
 } // namespace vrv
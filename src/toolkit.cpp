@@ -9,10 +9,20 @@
 
 //----------------------------------------------------------------------------
 
+#include <atomic>
 #include <cassert>
 #include <codecvt>
 #include <locale>
+#include <mutex>
 #include <regex>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 //----------------------------------------------------------------------------
 
@@ -62,8 +72,6 @@ const char *ZIP_SIGNATURE = "\x50\x4B\x03\x04";
 // Toolkit
 //----------------------------------------------------------------------------
 
-char *Toolkit::m_humdrumBuffer = NULL;
-
 Toolkit::Toolkit(bool initFont)
 {
     m_inputFrom = AUTO;
@@ -106,6 +114,7 @@ Toolkit::~Toolkit()
         m_runtimeClock = NULL;
     }
 #endif
+    if (GetLogBuffer() == &m_logBuffer) SetLogBuffer(NULL);
 }
 
 std::string Toolkit::GetResourcePath() const
@@ -299,6 +308,31 @@ bool Toolkit::LoadFile(const std::string &filename)
         return this->LoadZipFile(filename);
     }
 
+#ifndef _WIN32
+    // Map the file in memory so MEI can be parsed in place without reading it into a string first
+    // The mapping is private so the changes made by the parser are not written to the file
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat fileStat;
+    void *mapped = MAP_FAILED;
+    size_t mappedSize = 0;
+    if ((fstat(fd, &fileStat) == 0) && (fileStat.st_size > 0)) {
+        mappedSize = (size_t)fileStat.st_size;
+        mapped = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapped != MAP_FAILED) {
+        char *buffer = static_cast<char *>(mapped);
+        const bool success = (this->IsInPlaceInput(buffer, mappedSize))
+            ? this->LoadDataInPlace(buffer, mappedSize)
+            : this->LoadData(std::string(buffer, mappedSize));
+        munmap(mapped, mappedSize);
+        return success;
+    }
+#endif
+
     std::ifstream in(filename.c_str());
     if (!in.is_open()) {
         return false;
@@ -313,7 +347,7 @@ bool Toolkit::LoadFile(const std::string &filename)
     std::string content(fileSize, 0);
     in.read(&content[0], fileSize);
 
-    return this->LoadData(content);
+    return this->LoadData(std::move(content));
 }
 
 bool Toolkit::IsUTF16(const std::string &filename)
@@ -463,22 +497,64 @@ bool Toolkit::LoadZipDataBuffer(const unsigned char *data, int length)
     return this->LoadZipData(bytes);
 }
 
-bool Toolkit::LoadData(const std::string &data)
+bool Toolkit::LoadData(std::string &&data)
 {
-    std::string newData;
-    Input *input = NULL;
+    // Only MEI is parsed in place, other formats are loaded from the string as it is
+    if (!this->IsInPlaceInput(data.data(), data.size())) {
+        return this->LoadData(static_cast<const std::string &>(data));
+    }
+
+    // Take the ownership of the data, which is released once loaded
+    std::string content = std::move(data);
+    return this->LoadDataInPlace(content.data(), content.size());
+}
+
+bool Toolkit::IsInPlaceInput(const char *data, size_t size)
+{
+    if (m_inputFrom != AUTO) return (m_inputFrom == MEI);
+    // Identifying the input looks only at the beginning of the data
+    return (this->IdentifyInputFrom(std::string(data, std::min(size, (size_t)2000))) == MEI);
+}
 
+void Toolkit::InitLoading(const char *data, size_t size)
+{
     m_doc.m_expansionMap.Reset();
+    m_doc.EnableObjectArena(m_options->m_objectArena.GetValue());
 
     if (m_options->m_xmlIdChecksum.GetValue()) {
         crcInit();
-        unsigned int cr = crcFast((unsigned char *)data.c_str(), (int)data.size());
+        unsigned int cr = crcFast((const unsigned char *)data, (int)size);
         Object::SeedID(cr);
     }
 
 #ifndef NO_HUMDRUM_SUPPORT
     this->ClearHumdrumBuffer();
 #endif
+}
+
+bool Toolkit::LoadDataInPlace(char *data, size_t size)
+{
+    // The checksum needs to be calculated before the data is modified by the parser
+    this->InitLoading(data, size);
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+
+    Input *input = new MEIInput(&m_doc);
+    if (!input->ImportInPlace(data, size)) {
+        LogError("Error importing data");
+        delete input;
+        return false;
+    }
+
+    return this->FinishLoading(input);
+}
+
+bool Toolkit::LoadData(const std::string &data)
+{
+    std::string newData;
+    Input *input = NULL;
+
+    this->InitLoading(data.c_str(), data.size());
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
 
     auto inputFormat = m_inputFrom;
     if (inputFormat == AUTO) {
@@ -591,40 +667,17 @@ bool Toolkit::LoadData(const std::string &data)
         std::string buffer = conversion.str();
         this->SetHumdrumBuffer(buffer.c_str());
 
-        // Now convert Humdrum into MEI:
-        Doc tempdoc;
-        tempdoc.SetOptions(m_doc.GetOptions());
-        Input *tempinput = new HumdrumInput(&tempdoc);
-        if (!tempinput->Import(conversion.str())) {
-            LogError("Error importing Humdrum data (2)");
-            delete tempinput;
-            return false;
-        }
-        MEIOutput meioutput(&tempdoc);
-        meioutput.SetScoreBasedMEI(true);
-        newData = meioutput.GetOutput();
-        delete tempinput;
-        input = new MEIInput(&m_doc);
+        // Now import the Humdrum data:
+        input = this->ImportHumdrumConversion(buffer);
+        if (!input) return false;
     }
 
     else if (inputFormat == MEIHUM) {
         ConvertMEIToHumdrum(data);
 
-        // Now convert Humdrum into MEI:
-        std::string conversion = this->GetHumdrumBuffer();
-        Doc tempdoc;
-        tempdoc.SetOptions(m_doc.GetOptions());
-        Input *tempinput = new HumdrumInput(&tempdoc);
-        if (!tempinput->Import(conversion)) {
-            LogError("Error importing Humdrum data (3)");
-            delete tempinput;
-            return false;
-        }
-        MEIOutput meioutput(&tempdoc);
-        meioutput.SetScoreBasedMEI(true);
-        newData = meioutput.GetOutput();
-        delete tempinput;
-        input = new MEIInput(&m_doc);
+        // Now import the Humdrum data:
+        input = this->ImportHumdrumConversion(this->GetHumdrumBuffer());
+        if (!input) return false;
     }
 
     else if (inputFormat == MUSEDATAHUM) {
@@ -639,20 +692,9 @@ bool Toolkit::LoadData(const std::string &data)
         std::string buffer = conversion.str();
         this->SetHumdrumBuffer(buffer.c_str());
 
-        // Now convert Humdrum into MEI:
-        Doc tempdoc;
-        tempdoc.SetOptions(m_doc.GetOptions());
-        Input *tempinput = new HumdrumInput(&tempdoc);
-        if (!tempinput->Import(conversion.str())) {
-            LogError("Error importing Humdrum data (4)");
-            delete tempinput;
-            return false;
-        }
-        MEIOutput meioutput(&tempdoc);
-        meioutput.SetScoreBasedMEI(true);
-        newData = meioutput.GetOutput();
-        delete tempinput;
-        input = new MEIInput(&m_doc);
+        // Now import the Humdrum data:
+        input = this->ImportHumdrumConversion(buffer);
+        if (!input) return false;
     }
 
     else if (inputFormat == ESAC) {
@@ -667,20 +709,9 @@ bool Toolkit::LoadData(const std::string &data)
         std::string buffer = conversion.str();
         this->SetHumdrumBuffer(buffer.c_str());
 
-        // Now convert Humdrum into MEI:
-        Doc tempdoc;
-        tempdoc.SetOptions(m_doc.GetOptions());
-        Input *tempinput = new HumdrumInput(&tempdoc);
-        if (!tempinput->Import(conversion.str())) {
-            LogError("Error importing Humdrum data (5)");
-            delete tempinput;
-            return false;
-        }
-        MEIOutput meioutput(&tempdoc);
-        meioutput.SetScoreBasedMEI(true);
-        newData = meioutput.GetOutput();
-        delete tempinput;
-        input = new MEIInput(&m_doc);
+        // Now import the Humdrum data:
+        input = this->ImportHumdrumConversion(buffer);
+        if (!input) return false;
     }
 #endif
     else {
@@ -694,8 +725,10 @@ bool Toolkit::LoadData(const std::string &data)
         return false;
     }
 
-    // load the file
-    if (inputFormat != HUMDRUM) {
+    // load the file - Humdrum data (including the one converted from other formats) is already imported
+    const bool imported = (inputFormat == HUMDRUM) || (inputFormat == MUSICXMLHUM) || (inputFormat == MEIHUM)
+        || (inputFormat == MUSEDATAHUM) || (inputFormat == ESAC);
+    if (!imported) {
         if (!input->Import(newData.size() ? newData : data)) {
             LogError("Error importing data");
             delete input;
@@ -703,6 +736,56 @@ bool Toolkit::LoadData(const std::string &data)
         }
     }
 
+    return this->FinishLoading(input);
+}
+
+Input *Toolkit::ImportHumdrumConversion(const std::string &humdrum)
+{
+#ifndef NO_HUMDRUM_SUPPORT
+    // These options are applied only by MEIInput
+    const bool hasMEIInputOptions = !m_options->m_mdivXPathQuery.GetValue().empty()
+        || !m_options->m_appXPathQuery.GetValue().empty() || !m_options->m_choiceXPathQuery.GetValue().empty()
+        || !m_options->m_substXPathQuery.GetValue().empty() || m_options->m_mdivAll.GetValue()
+        || m_options->m_incip.GetValue() || m_options->m_preserveAnalyticalMarkup.GetValue()
+        || m_options->m_loadSelectedMdivOnly.GetValue() || m_options->m_moveScoreDefinitionToStaff.GetValue();
+
+    if (!hasMEIInputOptions) {
+        Input *input = new HumdrumInput(&m_doc);
+        if (!input->Import(humdrum)) {
+            LogError("Error importing Humdrum data");
+            delete input;
+            return NULL;
+        }
+        return input;
+    }
+
+    // Convert Humdrum into MEI first
+    Doc tempdoc;
+    tempdoc.SetOptions(m_doc.GetOptions());
+    HumdrumInput tempinput(&tempdoc);
+    if (!tempinput.Import(humdrum)) {
+        LogError("Error importing Humdrum data");
+        return NULL;
+    }
+    MEIOutput meioutput(&tempdoc);
+    meioutput.SetScoreBasedMEI(true);
+
+    Input *input = new MEIInput(&m_doc);
+    if (!input->Import(meioutput.GetOutput())) {
+        LogError("Error importing data");
+        delete input;
+        return NULL;
+    }
+    return input;
+#else
+    return NULL;
+#endif
+}
+
+bool Toolkit::FinishLoading(Input *input)
+{
+    assert(input);
+
     bool adjustPageHeight = m_options->m_adjustPageHeight.GetValue();
     int footerOption = m_options->m_footer.GetValue();
     // With adjusted page height, show the footer if explicitly set (i.e., not with "auto")
@@ -717,6 +800,7 @@ bool Toolkit::LoadData(const std::string &data)
     // generate missing measure numbers
     // TODO better move this to PrepareData()
     m_doc.GenerateMeasureNumbers();
+    m_doc.LoadingStageDone("load");
 
     // transpose the content if necessary
     if (m_options->m_transpose.IsSet() || m_options->m_transposeMdiv.IsSet()
@@ -727,6 +811,7 @@ bool Toolkit::LoadData(const std::string &data)
 
     m_doc.PrepareData();
     m_doc.InitSelectionDoc(m_docSelection, true);
+    m_doc.LoadingStageDone("prepareData");
 
     // Convert pseudo-measures into distinct segments based on barLine elements
     if (m_doc.IsMensuralMusicOnly()) {
@@ -801,6 +886,7 @@ bool Toolkit::LoadData(const std::string &data)
         default: m_editorToolkit = new EditorToolkitCMN(&m_doc, &m_view);
     }
 #endif
+    m_doc.LoadingStageDone("castOff");
 
     return true;
 }
@@ -1350,6 +1436,11 @@ bool Toolkit::Edit(const std::string &editorAction)
 {
     this->ResetLogBuffer();
 
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+
+    // Editor actions need all the pages
+    m_doc.CastOffPendingPages();
+
     return m_editorToolkit->ParseEditorAction(editorAction);
 }
 
@@ -1361,7 +1452,7 @@ std::string Toolkit::EditInfo()
 std::string Toolkit::GetLog()
 {
     std::string str;
-    for (const std::string &logStr : logBuffer) {
+    for (const std::string &logStr : m_logBuffer.GetMessages()) {
         str += logStr;
     }
     return str;
@@ -1380,12 +1471,14 @@ void Toolkit::ResetXmlIdSeed(int seed)
 
 void Toolkit::ResetLogBuffer()
 {
-    logBuffer.clear();
+    m_logBuffer.Clear();
+    SetLogBuffer(&m_logBuffer);
 }
 
 void Toolkit::RedoLayout(const std::string &jsonOptions)
 {
     bool resetCache = true;
+    bool incremental = false;
 
     jsonxx::Object json;
 
@@ -1396,16 +1489,26 @@ void Toolkit::RedoLayout(const std::string &jsonOptions)
         }
         else {
             if (json.has<jsonxx::Boolean>("resetCache")) resetCache = json.get<jsonxx::Boolean>("resetCache");
+            if (json.has<jsonxx::Boolean>("incremental")) incremental = json.get<jsonxx::Boolean>("incremental");
         }
     }
 
     this->ResetLogBuffer();
 
-    if ((this->GetPageCount() == 0) || (m_doc.GetType() == Transcription) || (m_doc.GetType() == Facs)) {
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+
+    // Pages still pending with the progressive layout do not need to be cast off before
+    if ((m_doc.GetPageCount() == 0) || (m_doc.GetType() == Transcription) || (m_doc.GetType() == Facs)) {
         LogWarning("No data to re-layout");
         return;
     }
 
+    // Only the pages edited need to be laid out again if the system and page breaks do not change
+    // Without any damage recorded, the changes are not known (e.g., neume editor actions) and everything is redone
+    if (incremental && !m_docSelection.m_isPending && m_doc.HasLayoutDamage()) {
+        if (m_doc.LayOutDamagedPages()) return;
+    }
+
     if (m_docSelection.m_isPending) {
         m_doc.InitSelectionDoc(m_docSelection, resetCache);
     }
@@ -1438,22 +1541,41 @@ void Toolkit::RedoPagePitchPosLayout()
         return;
     }
 
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
     page->LayOutPitchPos();
 }
 
 bool Toolkit::RenderToDeviceContext(int pageNo, DeviceContext *deviceContext)
 {
-    if (pageNo > this->GetPageCount()) {
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+
+    if (!this->LayOutPage(pageNo)) return false;
+
+    this->DrawPage(m_view, deviceContext);
+
+    return true;
+}
+
+bool Toolkit::LayOutPage(int pageNo)
+{
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+
+    // With the progressive layout, only the pages up to the one requested need to be cast off
+    m_doc.CastOffPendingPages(pageNo);
+    if (pageNo > m_doc.GetCastOffPageCount()) {
         LogWarning("Page %d does not exist", pageNo);
         return false;
     }
 
     // Page number is one-based - correct it to 0-based first
-    pageNo--;
-
     // Get the current system for the SVG clipping size
-    m_view.SetPage(pageNo);
+    m_view.SetPage(pageNo - 1);
 
+    return true;
+}
+
+void Toolkit::DrawPage(View &view, DeviceContext *deviceContext)
+{
     // Adjusting page width and height according to the options
     int width = m_options->m_pageWidth.GetUnfactoredValue();
     int height = m_options->m_pageHeight.GetUnfactoredValue();
@@ -1474,7 +1596,7 @@ bool Toolkit::RenderToDeviceContext(int pageNo, DeviceContext *deviceContext)
         std::swap(height, width);
     }
 
-    double userScale = m_view.GetPPUFactor() * m_options->m_scale.GetValue() / 100;
+    double userScale = view.GetPPUFactor() * m_options->m_scale.GetValue() / 100;
     assert(userScale != 0.0);
 
     if (m_options->m_scaleToPageSize.GetValue()) {
@@ -1493,9 +1615,7 @@ bool Toolkit::RenderToDeviceContext(int pageNo, DeviceContext *deviceContext)
     }
 
     // render the page
-    m_view.DrawCurrentPage(deviceContext, false);
-
-    return true;
+    view.DrawCurrentPage(deviceContext, false);
 }
 
 std::string Toolkit::RenderData(const std::string &data, const std::string &jsonOptions)
@@ -1510,11 +1630,28 @@ std::string Toolkit::RenderToSVG(int pageNo, bool xmlDeclaration)
 {
     this->ResetLogBuffer();
 
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+
     int initialPageNo = (m_doc.GetDrawingPage() == NULL) ? -1 : m_doc.GetDrawingPage()->GetIdx();
+
+    // The first xml:id of the drawing is reserved before laying out the page, as RenderAllToSVG does
+    const uint32_t drawingIDState = Object::ReserveIDState();
+    View *view = (this->LayOutPage(pageNo)) ? &m_view : NULL;
+
+    std::string out_str = this->DrawPageToSVG(view, &m_doc.GetResources(), drawingIDState, xmlDeclaration);
+    if (initialPageNo >= 0) m_doc.SetDrawingPage(initialPageNo);
+    return out_str;
+}
+
+std::string Toolkit::DrawPageToSVG(View *view, const Resources *resources, uint32_t drawingIDState, bool xmlDeclaration)
+{
+    // The xml:ids generated when drawing do not depend on the pages drawn before by the thread
+    Object::IDScope idScope(drawingIDState);
+
     // Create the SVG object, h & w come from the system
     // We will need to set the size of the page after having drawn it depending on the options
     SvgDeviceContext svg;
-    svg.SetResources(&m_doc.GetResources());
+    svg.SetResources(resources);
 
     int indent = (m_options->m_outputIndentTab.GetValue()) ? -1 : m_options->m_outputIndent.GetValue();
     svg.SetIndent(indent);
@@ -1548,11 +1685,9 @@ std::string Toolkit::RenderToSVG(int pageNo, bool xmlDeclaration)
     svg.SetSmuflTextFont((option_SMUFLTEXTFONT)m_options->m_smuflTextFont.GetValue());
 
     // render the page
-    this->RenderToDeviceContext(pageNo, &svg);
+    if (view) this->DrawPage(*view, &svg);
 
-    std::string out_str = svg.GetStringSVG(xmlDeclaration);
-    if (initialPageNo >= 0) m_doc.SetDrawingPage(initialPageNo);
-    return out_str;
+    return svg.GetStringSVG(xmlDeclaration);
 }
 
 bool Toolkit::RenderToSVGFile(const std::string &filename, int pageNo)
@@ -1574,6 +1709,81 @@ bool Toolkit::RenderToSVGFile(const std::string &filename, int pageNo)
     return true;
 }
 
+std::vector<std::string> Toolkit::RenderAllToSVG(int threads, bool xmlDeclaration)
+{
+    this->ResetLogBuffer();
+
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+
+    const int pageCount = this->GetPageCount();
+    std::vector<std::string> pages(pageCount);
+    if (pageCount == 0) return pages;
+
+    int initialPageNo = (m_doc.GetDrawingPage() == NULL) ? -1 : m_doc.GetDrawingPage()->GetIdx();
+
+    // The layout changes the document and is done by this thread, with the xml:ids generated as in RenderToSVG
+    std::vector<uint32_t> drawingIDStates(pageCount);
+    for (int pageNo = 1; pageNo <= pageCount; ++pageNo) {
+        drawingIDStates.at(pageNo - 1) = Object::ReserveIDState();
+        this->LayOutPage(pageNo);
+    }
+
+    if (threads <= 0) {
+        threads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, pageCount);
+
+    // Each thread draws with its own view and drawing context, and with its own copy of the resources for the text
+    // font currently selected (the glyph tables are shared). The objects drawn on several pages are locked.
+    std::recursive_mutex sharedDrawingMutex;
+    std::atomic<int> nextPage(1);
+    auto drawPages = [this, &pages, &drawingIDStates, &nextPage, &sharedDrawingMutex, pageCount, xmlDeclaration]() {
+        DrawingContext drawingContext;
+        drawingContext.m_sharedDrawingMutex = &sharedDrawingMutex;
+        Doc::DrawingContextScope drawingContextScope(&m_doc, &drawingContext);
+        const Resources resources = m_doc.GetResources();
+        View view;
+        view.SetDoc(&m_doc);
+        // The pages are taken one by one by the threads as they become available
+        for (int pageNo = nextPage++; pageNo <= pageCount; pageNo = nextPage++) {
+            view.SetPage(pageNo - 1, false);
+            const uint32_t drawingIDState = drawingIDStates.at(pageNo - 1);
+            pages.at(pageNo - 1) = this->DrawPageToSVG(&view, &resources, drawingIDState, xmlDeclaration);
+        }
+    };
+
+    // The log is thread local - the threads use the settings of this one and their log is added to it at the end
+    std::vector<LogBuffer> logs(threads - 1);
+    const LogLevel level = logLevel;
+    const bool toBuffer = loggingToBuffer;
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads - 1; ++i) {
+        workers.emplace_back([&drawPages, &logs, level, toBuffer, i]() {
+            logLevel = level;
+            loggingToBuffer = toBuffer;
+            SetLogBuffer(&logs.at(i));
+            drawPages();
+        });
+    }
+
+    drawPages();
+
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    for (const LogBuffer &log : logs) {
+        for (const std::string &message : log.GetMessages()) {
+            m_logBuffer.Add(message);
+        }
+    }
+
+    if (initialPageNo >= 0) m_doc.SetDrawingPage(initialPageNo);
+
+    return pages;
+}
+
 std::string Toolkit::GetHumdrum()
 {
     return this->GetHumdrumBuffer();
@@ -1648,10 +1858,10 @@ bool Toolkit::RenderToPAEFile(const std::string &filename)
     return true;
 }
 
-std::string Toolkit::RenderToTimemap(const std::string &jsonOptions)
+void Toolkit::ReadTimemapOptions(const std::string &jsonOptions, bool &includeRests, bool &includeMeasures) const
 {
-    bool includeMeasures = false;
-    bool includeRests = false;
+    includeMeasures = false;
+    includeRests = false;
 
     jsonxx::Object json;
 
@@ -1666,6 +1876,13 @@ std::string Toolkit::RenderToTimemap(const std::string &jsonOptions)
             if (json.has<jsonxx::Boolean>("includeRests")) includeRests = json.get<jsonxx::Boolean>("includeRests");
         }
     }
+}
+
+std::string Toolkit::RenderToTimemap(const std::string &jsonOptions)
+{
+    bool includeMeasures = false;
+    bool includeRests = false;
+    this->ReadTimemapOptions(jsonOptions, includeRests, includeMeasures);
 
     this->ResetLogBuffer();
 
@@ -1674,6 +1891,19 @@ std::string Toolkit::RenderToTimemap(const std::string &jsonOptions)
     return output;
 }
 
+std::vector<unsigned char> Toolkit::RenderToBinaryTimemap(const std::string &jsonOptions)
+{
+    bool includeMeasures = false;
+    bool includeRests = false;
+    this->ReadTimemapOptions(jsonOptions, includeRests, includeMeasures);
+
+    this->ResetLogBuffer();
+
+    std::vector<unsigned char> output;
+    m_doc.ExportBinaryTimemap(output, includeRests, includeMeasures);
+    return output;
+}
+
 std::string Toolkit::RenderToExpansionMap()
 {
     this->ResetLogBuffer();
@@ -1692,40 +1922,39 @@ std::string Toolkit::GetElementsAtTime(int millisec)
     jsonxx::Array chordArray;
     jsonxx::Array restArray;
 
-    // Here we need to check that the midi timemap is done
-    if (!m_doc.HasTimemap()) {
-        // generate MIDI timemap before progressing
-        m_doc.CalculateTimemap();
-    }
+    // The page of the elements is needed
+    m_doc.CastOffPendingPages();
+
+    // Here we need the index of the midi timemap (calculated if necessary)
+    const TimemapIndex &timemapIndex = m_doc.GetTimemapIndex();
 
-    MeasureOnsetOffsetComparison matchMeasureTime(millisec);
-    Measure *measure = dynamic_cast<Measure *>(m_doc.FindDescendantByComparison(&matchMeasureTime));
+    int repeat = 0;
+    const Measure *measure = timemapIndex.GetMeasureAtTime(millisec, repeat);
 
     if (!measure) {
         return o.json();
     }
 
-    int repeat = measure->EnclosesTime(millisec);
     int measureTimeOffset = measure->GetRealTimeOffsetMilliseconds(repeat);
 
     // Get the pageNo from the first note (if any)
     int pageNo = -1;
-    Page *page = vrv_cast<Page *>(measure->GetFirstAncestor(PAGE));
+    const Page *page = vrv_cast<const Page *>(measure->GetFirstAncestor(PAGE));
     if (page) pageNo = page->GetIdx() + 1;
 
-    NoteOrRestOnsetOffsetComparison matchTime(millisec - measureTimeOffset);
-    ListOfObjects notesOrRests;
-    ListOfObjects chords;
+    ListOfConstObjects notesOrRests;
+    ListOfConstObjects chords;
 
-    measure->FindAllDescendantsByComparison(&notesOrRests, &matchTime);
+    const int time = millisec - measureTimeOffset;
+    timemapIndex.GetNotesOrRestsInTimeRange(measure, time, time, notesOrRests);
 
     // Fill the JSON object
-    for (Object *object : notesOrRests) {
+    for (const Object *object : notesOrRests) {
         if (object->Is(NOTE)) {
             noteArray << object->GetID();
-            Note *note = vrv_cast<Note *>(object);
+            const Note *note = vrv_cast<const Note *>(object);
             assert(note);
-            Chord *chord = note->IsChordTone();
+            const Chord *chord = note->IsChordTone();
             if (chord) chords.push_back(chord);
         }
         else if (object->Is(REST)) {
@@ -1733,7 +1962,7 @@ std::string Toolkit::GetElementsAtTime(int millisec)
         }
     }
     chords.unique();
-    for (Object *object : chords) {
+    for (const Object *object : chords) {
         chordArray << object->GetID();
     }
 
@@ -1746,6 +1975,65 @@ std::string Toolkit::GetElementsAtTime(int millisec)
     return o.json();
 }
 
+std::string Toolkit::GetElementsInTimeRange(int startMillisec, int endMillisec)
+{
+    this->ResetLogBuffer();
+
+    jsonxx::Object o;
+    jsonxx::Array noteArray;
+    jsonxx::Array chordArray;
+    jsonxx::Array restArray;
+    jsonxx::Array pageArray;
+    jsonxx::Array measureArray;
+
+    // The page of the elements is needed
+    m_doc.CastOffPendingPages();
+
+    // Here we need the index of the midi timemap (calculated if necessary)
+    const TimemapIndex &timemapIndex = m_doc.GetTimemapIndex();
+
+    std::vector<std::pair<const Measure *, int>> measures;
+    timemapIndex.GetMeasuresInTimeRange(startMillisec, endMillisec, measures);
+
+    // Elements played in several repeats are listed only once
+    std::set<const Object *> listed;
+    std::set<int> pageNos;
+    ListOfConstObjects notesOrRests;
+    for (const auto &[measure, repeat] : measures) {
+        int measureTimeOffset = measure->GetRealTimeOffsetMilliseconds(repeat);
+
+        if (listed.insert(measure).second) {
+            measureArray << measure->GetID();
+            const Page *page = vrv_cast<const Page *>(measure->GetFirstAncestor(PAGE));
+            if (page && pageNos.insert(page->GetIdx() + 1).second) pageArray << page->GetIdx() + 1;
+        }
+
+        timemapIndex.GetNotesOrRestsInTimeRange(
+            measure, startMillisec - measureTimeOffset, endMillisec - measureTimeOffset, notesOrRests);
+        for (const Object *object : notesOrRests) {
+            if (!listed.insert(object).second) continue;
+            if (object->Is(NOTE)) {
+                noteArray << object->GetID();
+                const Note *note = vrv_cast<const Note *>(object);
+                assert(note);
+                const Chord *chord = note->IsChordTone();
+                if (chord && listed.insert(chord).second) chordArray << chord->GetID();
+            }
+            else if (object->Is(REST)) {
+                restArray << object->GetID();
+            }
+        }
+    }
+
+    o << "notes" << noteArray;
+    o << "chords" << chordArray;
+    o << "rests" << restArray;
+    o << "pages" << pageArray;
+    o << "measures" << measureArray;
+
+    return o.json();
+}
+
 bool Toolkit::RenderToMIDIFile(const std::string &filename)
 {
     this->ResetLogBuffer();
@@ -1787,9 +2075,29 @@ bool Toolkit::RenderToExpansionMapFile(const std::string &filename)
 
 int Toolkit::GetPageCount()
 {
+    m_doc.CastOffPendingPages();
     return m_doc.GetPageCount();
 }
 
+int Toolkit::GetCastOffPageCount()
+{
+    return m_doc.GetCastOffPageCount();
+}
+
+bool Toolkit::IsCastOffComplete()
+{
+    return !m_doc.HasPendingPages();
+}
+
+bool Toolkit::CastOffPages(int pageCount)
+{
+    this->ResetLogBuffer();
+
+    ObjectArena::Scope arenaScope(m_doc.GetObjectArena());
+    m_doc.CastOffPendingPages((pageCount > 0) ? pageCount : VRV_UNSET);
+    return !m_doc.HasPendingPages();
+}
+
 std::string Toolkit::GetDescriptiveFeatures(const std::string &options)
 {
     // For now do not handle any option
@@ -1800,6 +2108,8 @@ std::string Toolkit::GetDescriptiveFeatures(const std::string &options)
 
 int Toolkit::GetPageWithElement(const std::string &xmlId)
 {
+    m_doc.CastOffPendingPages();
+
     Object *element = m_doc.FindDescendantByID(xmlId);
     if (!element) {
         LogWarning("Element '%s' not found", xmlId.c_str());
@@ -2002,6 +2312,12 @@ void Toolkit::SetCString(const std::string &data)
     strcpy(m_cString, data.c_str());
 }
 
+const std::vector<unsigned char> &Toolkit::SetCBuffer(std::vector<unsigned char> &&data)
+{
+    m_cBuffer = std::move(data);
+    return m_cBuffer;
+}
+
 const char *Toolkit::GetCString()
 {
     if (m_cString) {
@@ -2158,6 +2474,13 @@ void Toolkit::LogRuntime() const
         else {
             LogInfo("Total runtime is %.3f s.", seconds);
         }
+        const size_t peakMemory = RuntimeClock::GetPeakMemory();
+        if (peakMemory > 0) {
+            LogInfo("Peak memory usage is %.1f MB.", peakMemory / (1024.0 * 1024.0));
+        }
+        if (m_options->m_showClassReport.GetValue()) m_doc.LogClassReport();
+        if (m_doc.GetObjectArena()) m_doc.GetObjectArena()->LogStatistics();
+        LogInfo("Objects allocated on the heap: %lu", ObjectArena::GetHeapAllocationCount());
     }
     else {
         LogWarning("No clock available. Please call 'InitClock' to create one.");
@@ -129,7 +129,7 @@ int View::ToDeviceContextY(int i)
         return 0;
     }
 
-    return (m_doc->m_drawingPageContentHeight - i); // flipped
+    return (m_doc->GetDrawingContext().m_drawingPageContentHeight - i); // flipped
 }
 
 /** y value in the Logical world  */
@@ -139,7 +139,7 @@ int View::ToLogicalY(int i)
         return 0;
     }
 
-    return m_doc->m_drawingPageContentHeight - i; // flipped
+    return m_doc->GetDrawingContext().m_drawingPageContentHeight - i; // flipped
 }
 
 Point View::ToDeviceContext(Point p)
@@ -212,6 +212,10 @@ void View::DrawTimeSpanningElement(DeviceContext *dc, Object *element, System *s
     System *parentSystem1 = vrv_cast<System *>(start->GetFirstAncestor(SYSTEM));
     System *parentSystem2 = vrv_cast<System *>(end->GetFirstAncestor(SYSTEM));
 
+    // An element over several systems can be drawn on several pages, which several threads might be drawing
+    std::unique_lock<std::recursive_mutex> lock;
+    if (parentSystem1 != parentSystem2) lock = m_doc->LockSharedDrawing();
+
     int x1, x2;
     Object *objectX = NULL;
     Measure *measure = NULL;
@@ -2821,6 +2825,10 @@ void View::DrawEnding(DeviceContext *dc, Ending *ending, System *system)
     // in non debug mode
     if (!parentSystem1 || !parentSystem2) return;
 
+    // As for the time spanning elements, see View::DrawTimeSpanningElement
+    std::unique_lock<std::recursive_mutex> lock;
+    if (parentSystem1 != parentSystem2) lock = m_doc->LockSharedDrawing();
+
     int x1, x2;
     Object *objectX;
     Measure *measure = NULL;
@@ -415,6 +415,8 @@ void View::DrawSymbolDef(DeviceContext *dc, Object *parent, SymbolDef *symbolDef
 
     // Because thg Svg is a child of symbolDef we need to temporarily change the parent for the bounding boxes
     // to be properly propagated in the device context
+    // The symbolDef is shared by the pages and is locked when they are drawn by several threads
+    std::unique_lock<std::recursive_mutex> lock = m_doc->LockSharedDrawing();
     symbolDef->SetTemporaryParent(parent);
 
     for (Object *current : symbolDef->GetChildren()) {
@@ -84,11 +84,12 @@ void View::DrawCurrentPage(DeviceContext *dc, bool background)
         dc->SetContentHeight(dc->GetHeight());
     }
 
-    // if (background) dc->DrawRectangle(0, 0, m_doc->m_drawingPageWidth, m_doc->m_drawingPageHeight);
+    const DrawingContext &context = m_doc->GetDrawingContext();
+    // if (background) dc->DrawRectangle(0, 0, context.m_drawingPageWidth, context.m_drawingPageHeight);
     dc->DrawBackgroundImage();
 
     Point origin = dc->GetLogicalOrigin();
-    dc->SetLogicalOrigin(origin.x - m_doc->m_drawingPageMarginLeft, origin.y - m_doc->m_drawingPageMarginTop);
+    dc->SetLogicalOrigin(origin.x - context.m_drawingPageMarginLeft, origin.y - context.m_drawingPageMarginTop);
 
     dc->StartPage();
 
@@ -199,6 +200,8 @@ void View::DrawSystem(DeviceContext *dc, System *system)
 
     // first we need to clear the drawing list of postponed elements
     system->ResetDrawingList();
+    // and the layer element index since the bounding boxes are drawn again
+    system->ResetLayerElementIndex();
 
     if (firstMeasure) {
         this->DrawScoreDef(dc, system->GetDrawingScoreDef(), firstMeasure, system->GetDrawingX(), NULL);
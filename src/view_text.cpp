@@ -639,6 +639,10 @@ void View::DrawRunningElements(DeviceContext *dc, Page *page)
         if (!bBoxDC->UpdateVerticalValues()) return;
     }
 
+    // The running elements are shared by the pages and are locked when they are drawn by several threads
+    // Their layout for the page is restored since another page might have been laid out since Page::LayOut
+    std::unique_lock<std::recursive_mutex> lock = m_doc->LockSharedDrawing();
+    page->ResetRunningElements();
     RunningElement *header = page->GetHeader();
     if (header) {
         this->DrawTextLayoutElement(dc, header);
@@ -9,6 +9,8 @@
 
 //----------------------------------------------------------------------------
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <codecvt>
@@ -63,13 +65,21 @@ namespace vrv {
 /** Global for LogElapsedTimeXXX functions (debugging purposes) */
 struct timeval start;
 
+/**
+ * The values set by EnableLog and EnableLogToBuffer for the threads started afterwards
+ */
+std::atomic<LogLevel> defaultLogLevel = LOG_WARNING;
+std::atomic<bool> defaultLoggingToBuffer = false;
+
 /** For controlling the log level - warning level enabled by default */
-LogLevel logLevel = LOG_WARNING;
+thread_local LogLevel logLevel = defaultLogLevel;
 
 /** By default log to stderr or JS console */
-bool loggingToBuffer = false;
+thread_local bool loggingToBuffer = defaultLoggingToBuffer;
 
-std::vector<std::string> logBuffer;
+/** The buffer of the thread when no toolkit has set one, and the buffer currently used by the thread */
+thread_local LogBuffer threadLogBuffer;
+thread_local LogBuffer *logBuffer = &threadLogBuffer;
 
 void LogElapsedTimeStart()
 {
@@ -139,8 +149,7 @@ void LogWarning(const char *fmt, ...)
 void LogString(std::string message, LogLevel level)
 {
     if (loggingToBuffer) {
-        if (LogBufferContains(message)) return;
-        logBuffer.push_back(message);
+        logBuffer->Add(message);
     }
     else {
 #ifdef __EMSCRIPTEN__
@@ -177,12 +186,26 @@ LogLevel StrToLogLevel(const std::string &level)
     return LOG_WARNING;
 }
 
-bool LogBufferContains(const std::string &s)
+LogBuffer *GetLogBuffer()
 {
-    for (const std::string &logStr : logBuffer) {
-        if (logStr == s) return true;
-    }
-    return false;
+    return logBuffer;
+}
+
+void SetLogBuffer(LogBuffer *buffer)
+{
+    logBuffer = (buffer) ? buffer : &threadLogBuffer;
+}
+
+void LogBuffer::Add(const std::string &message)
+{
+    if (this->Contains(message)) return;
+    if ((int)m_messages.size() >= m_capacity) m_messages.pop_front();
+    m_messages.push_back(message);
+}
+
+bool LogBuffer::Contains(const std::string &message) const
+{
+    return (std::find(m_messages.begin(), m_messages.end(), message) != m_messages.end());
 }
 
 bool Check(Object *object)
@@ -197,11 +220,13 @@ bool Check(Object *object)
 
 void EnableLog(LogLevel level)
 {
+    defaultLogLevel = level;
     logLevel = level;
 }
 
 void EnableLogToBuffer(bool value)
 {
+    defaultLoggingToBuffer = value;
     loggingToBuffer = value;
 }
 
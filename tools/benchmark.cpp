@@ -0,0 +1,727 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        benchmark.cpp
+// Author:      Marco Martinelli
+// Created:     17/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <getopt.h>
+#include <sys/resource.h>
+#else
+#include "win_getopt.h"
+#endif
+
+//----------------------------------------------------------------------------
+
+#include "doc.h"
+#include "toolkit.h"
+#include "vrv.h"
+
+//----------------------------------------------------------------------------
+
+#include "jsonxx.h"
+
+//----------------------------------------------------------------------------
+// Allocation counting
+//----------------------------------------------------------------------------
+
+// All the allocations of the process go through the replaceable operators below.
+// The aligned versions are not replaced and are not counted.
+static std::atomic<unsigned long> allocationCount(0);
+static std::atomic<unsigned long long> allocatedBytes(0);
+
+static void *countedAllocate(std::size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new(std::size_t size)
+{
+    if (void *ptr = countedAllocate(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    if (void *ptr = countedAllocate(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept
+{
+    std::free(ptr);
+}
+
+//----------------------------------------------------------------------------
+// Peak resident set size
+//----------------------------------------------------------------------------
+
+// Reset the peak resident set size to the current one - only possible on Linux
+bool resetPeakRss()
+{
+#ifdef __linux__
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (!clearRefs) return false;
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+#else
+    return false;
+#endif
+}
+
+// Return the peak resident set size in KB
+long getPeakRss()
+{
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::atol(line.c_str() + 6);
+    }
+#endif
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// Generated corpus
+//----------------------------------------------------------------------------
+
+// The corpus is generated deterministically for the results to be comparable across builds.
+// Its size is given by the number of measures of each input.
+
+const char *const pitchNames = "cdefgab";
+
+std::string generateMEI(int measures)
+{
+    std::stringstream mei;
+    mei << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<mei xmlns=\"http://www.music-encoding.org/ns/mei\" meiversion=\"5.0.0-dev\">\n"
+        << "<meiHead><fileDesc><titleStmt><title>Benchmark</title></titleStmt><pubStmt/></fileDesc></meiHead>\n"
+        << "<music><body><mdiv><score>\n"
+        << "<scoreDef meter.count=\"4\" meter.unit=\"4\" key.sig=\"2s\"><staffGrp symbol=\"brace\" bar.thru=\"true\">\n"
+        << "<staffDef n=\"1\" lines=\"5\" clef.shape=\"G\" clef.line=\"2\"/>\n"
+        << "<staffDef n=\"2\" lines=\"5\" clef.shape=\"F\" clef.line=\"4\"/>\n"
+        << "</staffGrp></scoreDef>\n<section>\n";
+    for (int m = 0; m < measures; ++m) {
+        mei << "<measure n=\"" << m + 1 << "\" xml:id=\"m" << m << "\">\n<staff n=\"1\"><layer n=\"1\">";
+        for (int b = 0; b < 2; ++b) {
+            mei << "<beam>";
+            for (int n = 0; n < 4; ++n) {
+                const int step = (m * 3 + b * 4 + n * (1 + m % 3)) % 12;
+                mei << "<note xml:id=\"n" << m << "_" << b * 4 + n << "\" dur=\"8\" pname=\"" << pitchNames[step % 7]
+                    << "\" oct=\"" << 4 + step / 7 << "\"" << ((step % 5 == 0) ? " accid=\"s\"" : "") << "/>";
+            }
+            mei << "</beam>";
+        }
+        mei << "</layer><layer n=\"2\"><note dur=\"2\" pname=\"" << pitchNames[m % 7]
+            << "\" oct=\"4\" stem.dir=\"down\"/><rest dur=\"2\"/></layer></staff>\n<staff n=\"2\"><layer n=\"1\">";
+        for (int c = 0; c < 2; ++c) {
+            const int root = (m * 2 + c * 3) % 7;
+            mei << "<chord dur=\"2\" xml:id=\"c" << m << "_" << c << "\"><note pname=\"" << pitchNames[root]
+                << "\" oct=\"2\"/><note pname=\"" << pitchNames[(root + 2) % 7] << "\" oct=\"3\"/><note pname=\""
+                << pitchNames[(root + 4) % 7] << "\" oct=\"3\"/></chord>";
+        }
+        mei << "</layer></staff>\n";
+        mei << "<slur staff=\"1\" startid=\"#n" << m << "_0\" endid=\"#n" << m << "_3\"/>";
+        mei << "<dir staff=\"1\" tstamp=\"3\">legato</dir>";
+        if (m % 4 == 0) mei << "<dynam staff=\"1\" tstamp=\"1\">" << ((m % 8 == 0) ? "p" : "mf") << "</dynam>";
+        if (m % 2 == 0) mei << "<tie staff=\"2\" startid=\"#c" << m << "_0\" endid=\"#c" << m << "_1\"/>";
+        if ((m % 8 == 4) && (m + 2 < measures)) {
+            mei << "<hairpin staff=\"1\" tstamp=\"1\" tstamp2=\"2m+1\" form=\"cres\"/>";
+        }
+        mei << "\n</measure>\n";
+    }
+    mei << "</section>\n</score></mdiv></body></music>\n</mei>\n";
+    return mei.str();
+}
+
+// The parts alternate a treble and a bass one, numbered when there are more than two
+std::string generateMusicXML(int measures, int parts)
+{
+    std::stringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<score-partwise version=\"3.1\">\n<part-list>\n";
+    for (int p = 0; p < parts; ++p) {
+        xml << "<score-part id=\"P" << p + 1 << "\"><part-name>" << ((p % 2 == 0) ? "Violin" : "Cello");
+        if (parts > 2) xml << " " << p / 2 + 1;
+        xml << "</part-name></score-part>\n";
+    }
+    xml << "</part-list>\n";
+    for (int p = 0; p < parts; ++p) {
+        // The treble (0) or bass (1) part
+        const int v = p % 2;
+        xml << "<part id=\"P" << p + 1 << "\">\n";
+        for (int m = 0; m < measures; ++m) {
+            xml << "<measure number=\"" << m + 1 << "\">";
+            if (m == 0) {
+                xml << "<attributes><divisions>2</divisions><key><fifths>-1</fifths></key>"
+                    << "<time><beats>3</beats><beat-type>4</beat-type></time>"
+                    << "<clef><sign>" << ((v == 0) ? "G" : "F") << "</sign><line>" << ((v == 0) ? 2 : 4)
+                    << "</line></clef>"
+                    << "</attributes>";
+            }
+            if ((v == 0) && (m % 4 == 0)) {
+                xml << "<direction placement=\"below\"><direction-type><dynamics><f/></dynamics></direction-type>"
+                    << "</direction>";
+            }
+            for (int n = 0; n < ((v == 0) ? 6 : 3); ++n) {
+                const int step = (m * 5 + n * (2 + v)) % 10;
+                xml << "<note><pitch><step>" << (char)toupper(pitchNames[(step + 2) % 7]) << "</step><octave>"
+                    << 4 - v * 2 + step / 7 << "</octave></pitch><duration>" << ((v == 0) ? 1 : 2)
+                    << "</duration><type>" << ((v == 0) ? "eighth" : "quarter") << "</type>";
+                if (v == 0) xml << "<beam number=\"1\">" << ((n % 2 == 0) ? "begin" : "end") << "</beam>";
+                if ((v == 1) && (n != 1)) {
+                    xml << "<notations><slur type=\"" << ((n == 0) ? "start" : "stop") << "\"/></notations>";
+                }
+                xml << "</note>";
+            }
+            xml << "</measure>\n";
+        }
+        xml << "</part>\n";
+    }
+    xml << "</score-partwise>\n";
+    return xml.str();
+}
+
+std::string generateHumdrum(int measures)
+{
+    std::stringstream krn;
+    krn << "**kern\t**kern\n*staff2\t*staff1\n*clefF4\t*clefG2\n*k[f#]\t*k[f#]\n*M4/4\t*M4/4\n";
+    for (int m = 0; m < measures; ++m) {
+        krn << "=" << m + 1 << "\t=" << m + 1 << "\n";
+        for (int n = 0; n < 4; ++n) {
+            const int step = (m * 2 + n * 3) % 7;
+            const char *lower = (n == 0) ? "2" : ((n == 2) ? "2" : NULL);
+            krn << (lower ? std::string(lower) + (char)toupper(pitchNames[(m + n) % 7]) : std::string("."));
+            krn << "\t" << ((n % 2 == 0) ? "(" : "") << "4" << pitchNames[step] << ((step == 3) ? "#" : "")
+                << ((n % 2 == 1) ? ")" : "") << "\n";
+        }
+    }
+    krn << "==\t==\n*-\t*-\n";
+    return krn.str();
+}
+
+std::string generatePAE(int measures)
+{
+    std::stringstream pae;
+    pae << "@clef:G-2\n@keysig:bBE\n@timesig:3/4\n@data:";
+    for (int m = 0; m < measures; ++m) {
+        pae << ((m % 2 == 0) ? "'" : "''");
+        for (int n = 0; n < ((m % 3 == 0) ? 3 : 6); ++n) {
+            if (n == 0) pae << ((m % 3 == 0) ? "4" : "8");
+            pae << (char)toupper(pitchNames[(m * 3 + n * 2) % 7]);
+        }
+        pae << "/";
+    }
+    pae << "\n";
+    return pae.str();
+}
+
+std::string generateABC(int measures)
+{
+    std::stringstream abc;
+    abc << "X:1\nT:Benchmark\nM:6/8\nL:1/8\nK:D\n";
+    for (int m = 0; m < measures; ++m) {
+        for (int n = 0; n < 6; ++n) {
+            const int step = (m * 4 + n * 3) % 10;
+            const char name = pitchNames[(step + 1) % 7];
+            abc << ((step < 7) ? (char)toupper(name) : name);
+            if (n == 2) abc << " ";
+        }
+        abc << ((m % 4 == 3) ? "|\n" : "|");
+    }
+    abc << "]\n";
+    return abc.str();
+}
+
+//----------------------------------------------------------------------------
+// Benchmark
+//----------------------------------------------------------------------------
+
+struct BenchmarkInput {
+    std::string name;
+    std::string data;
+};
+
+struct StageResult {
+    std::string input;
+    std::string stage;
+    std::vector<double> times;
+    unsigned long allocations = 0;
+    unsigned long long allocatedBytes = 0;
+    long peakRss = 0;
+
+    double GetMin() const { return *std::min_element(times.begin(), times.end()); }
+    double GetMedian() const
+    {
+        std::vector<double> sorted = times;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t middle = sorted.size() / 2;
+        return (sorted.size() % 2) ? sorted.at(middle) : (sorted.at(middle - 1) + sorted.at(middle)) / 2.0;
+    }
+};
+
+// The state of the process at the start of a stage
+struct StageStart {
+    std::chrono::steady_clock::time_point time;
+    unsigned long allocations = 0;
+    unsigned long long allocatedBytes = 0;
+};
+
+StageStart startStage()
+{
+    resetPeakRss();
+    StageStart start;
+    start.allocations = allocationCount.load();
+    start.allocatedBytes = allocatedBytes.load();
+    start.time = std::chrono::steady_clock::now();
+    return start;
+}
+
+// Add the wall time (ms), allocations and peak resident set size of the stage started to the result
+void endStage(StageResult &result, const StageStart &start)
+{
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start.time).count();
+
+    // The allocations are the ones of the last iteration, the peak the highest of all
+    result.allocations = allocationCount.load() - start.allocations;
+    result.allocatedBytes = allocatedBytes.load() - start.allocatedBytes;
+    result.peakRss = std::max(result.peakRss, getPeakRss());
+    result.times.push_back(ms);
+}
+
+// Run a stage and add its wall time, allocations and peak resident set size to the result
+bool runStage(StageResult &result, const std::function<bool()> &stage)
+{
+    const StageStart start = startStage();
+    const bool success = stage();
+    endStage(result, start);
+    return success;
+}
+
+// Add the wall time of the stages of the data preparation as recorded by the document
+// The document has to be prepared for the first time, since the initialization otherwise includes resetting the data
+void addDataStages(const std::string &inputName, const vrv::Doc *doc, std::vector<StageResult> &dataResults)
+{
+    const std::vector<std::pair<std::string, double>> &timings = doc->GetPrepareDataTimings();
+    for (int i = 0; i < (int)timings.size(); ++i) {
+        if (i == (int)dataResults.size()) {
+            dataResults.push_back(StageResult());
+            dataResults.back().input = inputName;
+            dataResults.back().stage = "prepareData:" + timings.at(i).first;
+        }
+        dataResults.at(i).times.push_back(timings.at(i).second);
+    }
+}
+
+// Load the data with Toolkit::LoadData and add each stage of the loading to the result with the same name
+bool loadDataWithStages(vrv::Toolkit &toolkit, const std::string &data, std::vector<StageResult> &results)
+{
+    int stageCount = 0;
+    StageStart start = startStage();
+    toolkit.GetDoc()->SetLoadingStageCallback([&](const std::string &stage) {
+        for (StageResult &result : results) {
+            if (result.stage == stage) endStage(result, start);
+        }
+        ++stageCount;
+        start = startStage();
+    });
+    const bool success = toolkit.LoadData(data);
+    toolkit.GetDoc()->SetLoadingStageCallback(NULL);
+    return success && (stageCount == 3);
+}
+
+// The loading, the data preparation and the cast-off are timed within Toolkit::LoadData.
+// The rendering stages are timed on the document loaded by it.
+bool runInput(const BenchmarkInput &input, const std::string &resourcePath, const std::string &jsonOptions,
+    int iterations, bool dataStages, std::vector<StageResult> &results)
+{
+    const std::vector<std::string> stages
+        = { "load", "prepareData", "castOff", "renderSVG", "renderMIDI", "renderTimemap" };
+    std::vector<StageResult> inputResults(stages.size());
+    for (int i = 0; i < (int)stages.size(); ++i) {
+        inputResults.at(i).input = input.name;
+        inputResults.at(i).stage = stages.at(i);
+    }
+
+    vrv::Toolkit toolkit(false);
+    if (!toolkit.SetResourcePath(resourcePath)) {
+        std::cerr << "The resources could not be loaded from " << resourcePath << "." << std::endl;
+        return false;
+    }
+    if (!jsonOptions.empty()) toolkit.SetOptions(jsonOptions);
+
+    std::vector<StageResult> dataResults;
+    for (int i = 0; i < iterations; ++i) {
+        // The document is reset by the import and the data is prepared for the first time
+        bool success = loadDataWithStages(toolkit, input.data, inputResults);
+        if (success && dataStages) addDataStages(input.name, toolkit.GetDoc(), dataResults);
+        success = success && runStage(inputResults.at(3), [&]() {
+            size_t size = 0;
+            for (int page = 1; page <= toolkit.GetPageCount(); ++page) size += toolkit.RenderToSVG(page).size();
+            return (size > 0);
+        });
+        success = success && runStage(inputResults.at(4), [&]() { return !toolkit.RenderToMIDI().empty(); });
+        success = success && runStage(inputResults.at(5), [&]() { return !toolkit.RenderToTimemap().empty(); });
+        if (!success) {
+            std::cerr << "The benchmark of " << input.name << " failed." << std::endl;
+            return false;
+        }
+    }
+
+    if (dataStages && dataResults.empty()) {
+        std::cerr << "The stages of the data preparation are timed only in builds without NO_RUNTIME." << std::endl;
+    }
+
+    results.insert(results.end(), inputResults.begin(), inputResults.begin() + 2);
+    results.insert(results.end(), dataResults.begin(), dataResults.end());
+    results.insert(results.end(), inputResults.begin() + 2, inputResults.end());
+    return true;
+}
+
+// Look up the scaled metrics of all the SMuFL glyphs for a few staff sizes, as done during layout and drawing
+bool runGlyphMetrics(const std::string &resourcePath, int iterations, int scale, std::vector<StageResult> &results)
+{
+    StageResult result;
+    result.input = "glyphMetrics";
+    result.stage = "lookup";
+
+    vrv::Toolkit toolkit(false);
+    if (!toolkit.SetResourcePath(resourcePath) || !toolkit.LoadData(generateMEI(1))) {
+        std::cerr << "The benchmark of the glyph metrics failed." << std::endl;
+        return false;
+    }
+    const vrv::Doc *doc = toolkit.GetDoc();
+
+    std::vector<char32_t> codes;
+    for (char32_t code = vrv::Resources::k_privateUseFirst; code <= vrv::Resources::k_privateUseLast; ++code) {
+        if (doc->GetResources().GetGlyph(code)) codes.push_back(code);
+    }
+
+    for (int i = 0; i < iterations; ++i) {
+        runStage(result, [&]() {
+            long long sum = 0;
+            for (int repeat = 0; repeat < 100 * scale; ++repeat) {
+                for (const int staffSize : { 100, 75, 100, 100 }) {
+                    for (const bool graceSize : { false, true }) {
+                        for (const char32_t code : codes) {
+                            sum += doc->GetGlyphWidth(code, staffSize, graceSize);
+                            sum += doc->GetGlyphHeight(code, staffSize, graceSize);
+                            sum += doc->GetGlyphLeft(code, staffSize, graceSize);
+                            sum += doc->GetGlyphRight(code, staffSize, graceSize);
+                            sum += doc->GetGlyphBottom(code, staffSize, graceSize);
+                            sum += doc->GetGlyphTop(code, staffSize, graceSize);
+                            sum += doc->GetGlyphAdvX(code, staffSize, graceSize);
+                        }
+                    }
+                }
+            }
+            return (sum != 0);
+        });
+    }
+
+    results.push_back(result);
+    return true;
+}
+
+jsonxx::Object resultsToJson(const std::vector<StageResult> &results, int iterations, int scale, bool peakRssReset)
+{
+    jsonxx::Object json;
+    json << "version" << vrv::GetVersion();
+    json << "iterations" << iterations;
+    json << "scale" << scale;
+    json << "peakRssPerStage" << peakRssReset;
+
+    jsonxx::Array stages;
+    for (const StageResult &result : results) {
+        jsonxx::Object stage;
+        stage << "input" << result.input;
+        stage << "stage" << result.stage;
+        stage << "timeMin" << result.GetMin();
+        stage << "timeMedian" << result.GetMedian();
+        stage << "allocations" << (double)result.allocations;
+        stage << "allocatedBytes" << (double)result.allocatedBytes;
+        stage << "peakRss" << (double)result.peakRss;
+        stages << stage;
+    }
+    json << "results" << stages;
+    return json;
+}
+
+void printResults(const std::vector<StageResult> &results, std::ostream &output)
+{
+    output << vrv::StringFormat("%-16s %-36s %10s %10s %12s %10s %10s", "input", "stage", "min (ms)", "median (ms)",
+                  "allocations", "alloc (MB)", "peak (MB)")
+           << std::endl;
+    for (const StageResult &result : results) {
+        output << vrv::StringFormat("%-16s %-36s %10.2f %10.2f %12lu %10.1f %10.1f", result.input.c_str(),
+                      result.stage.c_str(), result.GetMin(), result.GetMedian(), result.allocations,
+                      result.allocatedBytes / (1024.0 * 1024.0), result.peakRss / 1024.0)
+               << std::endl;
+    }
+}
+
+bool readResults(const std::string &filename, jsonxx::Object &json)
+{
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+    if (!file || !json.parse(content.str()) || !json.has<jsonxx::Array>("results")) {
+        std::cerr << "The benchmark results could not be read from " << filename << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Compare the median times and the allocations of two result files and return the number of regressions
+int compareResults(const jsonxx::Object &base, const jsonxx::Object &current, double threshold, std::ostream &output)
+{
+    const jsonxx::Array &baseStages = base.get<jsonxx::Array>("results");
+    const jsonxx::Array &currentStages = current.get<jsonxx::Array>("results");
+
+    output << vrv::StringFormat("%-16s %-36s %12s %12s %9s %12s %12s %9s", "input", "stage", "base (ms)", "new (ms)",
+                  "time", "base allocs", "new allocs", "allocs")
+           << std::endl;
+    int regressions = 0;
+    for (size_t i = 0; i < currentStages.size(); ++i) {
+        const jsonxx::Object &stage = currentStages.get<jsonxx::Object>((unsigned int)i);
+        const std::string input = stage.get<jsonxx::String>("input");
+        const std::string name = stage.get<jsonxx::String>("stage");
+        const jsonxx::Object *baseStage = NULL;
+        for (size_t j = 0; j < baseStages.size(); ++j) {
+            const jsonxx::Object &candidate = baseStages.get<jsonxx::Object>((unsigned int)j);
+            if ((candidate.get<jsonxx::String>("input") == input) && (candidate.get<jsonxx::String>("stage") == name)) {
+                baseStage = &candidate;
+                break;
+            }
+        }
+        if (!baseStage) continue;
+
+        const double baseTime = baseStage->get<jsonxx::Number>("timeMedian");
+        const double time = stage.get<jsonxx::Number>("timeMedian");
+        const double baseAllocations = baseStage->get<jsonxx::Number>("allocations");
+        const double allocations = stage.get<jsonxx::Number>("allocations");
+        const double timeChange = (baseTime > 0.0) ? (time / baseTime - 1.0) * 100.0 : 0.0;
+        const double allocationChange = (baseAllocations > 0.0) ? (allocations / baseAllocations - 1.0) * 100.0 : 0.0;
+        const bool regression = (timeChange > threshold) || (allocationChange > threshold);
+        if (regression) ++regressions;
+
+        output << vrv::StringFormat("%-16s %-36s %12.2f %12.2f %+8.1f%% %12.0f %12.0f %+8.1f%%%s", input.c_str(),
+                      name.c_str(), baseTime, time, timeChange, baseAllocations, allocations, allocationChange,
+                      regression ? "  <- regression" : "")
+               << std::endl;
+    }
+    return regressions;
+}
+
+void displayUsage(const char *program)
+{
+    std::cout << "Usage:" << std::endl << std::endl;
+    std::cout << " " << program << " [options] [file...]" << std::endl;
+    std::cout << " " << program << " --compare [options] base.json new.json" << std::endl << std::endl;
+    std::cout << "Run a generated corpus (MEI, MusicXML, Humdrum, PAE and ABC) and the files given through the stages"
+              << std::endl;
+    std::cout << "of the pipeline and report the wall time, the allocations and the peak memory of each of them."
+              << std::endl;
+    std::cout << "The loading, the data preparation and the cast-off are timed separately within the loading of the"
+              << std::endl;
+    std::cout << "toolkit, once per iteration." << std::endl;
+    std::cout << "With the generated corpus, the lookup of the scaled glyph metrics is also measured." << std::endl
+              << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << " -c, --compare              Compare two result files instead of running the benchmark" << std::endl;
+    std::cout << " -d, --data-stages          Also report the stages of the first data preparation (requires a"
+              << std::endl;
+    std::cout << "                            build without NO_RUNTIME)" << std::endl;
+    std::cout << " -h, --help                 Display this message" << std::endl;
+    std::cout << " -i, --iterations=N         The number of iterations of each input (default 5)" << std::endl;
+    std::cout << " -n, --no-generated         Do not include the generated corpus" << std::endl;
+    std::cout << " -o, --outfile=FILE         Write the results in JSON to FILE (\"-\" for standard output)"
+              << std::endl;
+    std::cout << " -p, --options=JSON         The toolkit options (in JSON) used for all the inputs" << std::endl;
+    std::cout << " -r, --resources=DIR        Path to the resources directory" << std::endl;
+    std::cout << " -s, --scale=N              The size factor of the generated corpus (default 1)" << std::endl;
+    std::cout << " -t, --threshold=PERCENT    Regression threshold when comparing (default 10)" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::string outfile;
+    std::string jsonOptions;
+    std::string resourcePath = vrv::Toolkit(false).GetResourcePath();
+    int iterations = 5;
+    int scale = 1;
+    double threshold = 10.0;
+    bool compare = false;
+    bool dataStages = false;
+    bool generated = true;
+
+    static struct option long_options[] = { //
+        { "compare", no_argument, 0, 'c' }, //
+        { "data-stages", no_argument, 0, 'd' }, //
+        { "help", no_argument, 0, 'h' }, //
+        { "iterations", required_argument, 0, 'i' }, //
+        { "no-generated", no_argument, 0, 'n' }, //
+        { "outfile", required_argument, 0, 'o' }, //
+        { "options", required_argument, 0, 'p' }, //
+        { "resources", required_argument, 0, 'r' }, //
+        { "scale", required_argument, 0, 's' }, //
+        { "threshold", required_argument, 0, 't' }, //
+        { 0, 0, 0, 0 }
+    };
+
+    int c;
+    int option_index = 0;
+    while ((c = getopt_long(argc, argv, "cdhi:no:p:r:s:t:", long_options, &option_index)) != -1) {
+        switch (c) {
+            case 'c': compare = true; break;
+            case 'd': dataStages = true; break;
+            case 'h': displayUsage(argv[0]); return 0;
+            case 'i': iterations = std::max(1, atoi(optarg)); break;
+            case 'n': generated = false; break;
+            case 'o': outfile = optarg; break;
+            case 'p': jsonOptions = optarg; break;
+            case 'r': resourcePath = optarg; break;
+            case 's': scale = std::max(1, atoi(optarg)); break;
+            case 't': threshold = atof(optarg); break;
+            default: displayUsage(argv[0]); return 1;
+        }
+    }
+
+    if (compare) {
+        if (argc - optind != 2) {
+            std::cerr << "Expected two result files to compare." << std::endl;
+            return 1;
+        }
+        jsonxx::Object base;
+        jsonxx::Object current;
+        if (!readResults(argv[optind], base) || !readResults(argv[optind + 1], current)) return 1;
+        const int regressions = compareResults(base, current, threshold, std::cout);
+        if (regressions > 0) {
+            std::cerr << regressions << " stage(s) regressed by more than " << threshold << "%." << std::endl;
+        }
+        return (regressions > 0) ? 1 : 0;
+    }
+
+    vrv::EnableLog(vrv::LOG_ERROR);
+
+    std::vector<BenchmarkInput> inputs;
+    if (generated) {
+        inputs.push_back({ "generated.mei", generateMEI(64 * scale) });
+        inputs.push_back({ "generated.xml", generateMusicXML(64 * scale, 2) });
+        inputs.push_back({ "generated-24.xml", generateMusicXML(8 * scale, 24) });
+        inputs.push_back({ "generated.krn", generateHumdrum(64 * scale) });
+        inputs.push_back({ "generated.pae", generatePAE(32 * scale) });
+        inputs.push_back({ "generated.abc", generateABC(64 * scale) });
+    }
+    for (int i = optind; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::cerr << "The file " << argv[i] << " could not be opened." << std::endl;
+            return 1;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        std::string name = argv[i];
+        name = name.substr(name.find_last_of("/\\") + 1);
+        inputs.push_back({ name, content.str() });
+    }
+    if (inputs.empty()) {
+        std::cerr << "Nothing to benchmark." << std::endl;
+        return 1;
+    }
+
+    const bool peakRssReset = resetPeakRss();
+    if (!peakRssReset) {
+        std::cerr << "The peak memory cannot be reset and is the one of the process so far." << std::endl;
+    }
+
+    std::vector<StageResult> results;
+    bool success = true;
+    for (const BenchmarkInput &input : inputs) {
+        success = runInput(input, resourcePath, jsonOptions, iterations, dataStages, results) && success;
+    }
+    if (generated) {
+        success = runGlyphMetrics(resourcePath, iterations, scale, results) && success;
+    }
+
+    printResults(results, std::cerr);
+
+    if (!outfile.empty()) {
+        const std::string json = resultsToJson(results, iterations, scale, peakRssReset).json();
+        if (outfile == "-") {
+            std::cout << json << std::endl;
+        }
+        else {
+            std::ofstream output(outfile);
+            output << json << std::endl;
+            if (!output) {
+                std::cerr << "The results could not be written to " << outfile << "." << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return success ? 0 : 1;
+}
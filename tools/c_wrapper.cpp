@@ -49,6 +49,12 @@ void vrvToolkit_destructor(void *tkPtr)
     delete tk;
 }
 
+bool vrvToolkit_castOffPages(void *tkPtr, int pageCount)
+{
+    Toolkit *tk = static_cast<Toolkit *>(tkPtr);
+    return tk->CastOffPages(pageCount);
+}
+
 bool vrvToolkit_edit(void *tkPtr, const char *editorAction)
 {
     Toolkit *tk = static_cast<Toolkit *>(tkPtr);
@@ -73,6 +79,12 @@ const char *vrvToolkit_getAvailableOptions(void *tkPtr)
     return tk->GetCString();
 }
 
+int vrvToolkit_getCastOffPageCount(void *tkPtr)
+{
+    Toolkit *tk = static_cast<Toolkit *>(tkPtr);
+    return tk->GetCastOffPageCount();
+}
+
 const char *vrvToolkit_getDefaultOptions(void *tkPtr)
 {
     Toolkit *tk = static_cast<Toolkit *>(tkPtr);
@@ -101,6 +113,13 @@ const char *vrvToolkit_getElementsAtTime(void *tkPtr, int millisec)
     return tk->GetCString();
 }
 
+const char *vrvToolkit_getElementsInTimeRange(void *tkPtr, int startMillisec, int endMillisec)
+{
+    Toolkit *tk = static_cast<Toolkit *>(tkPtr);
+    tk->SetCString(tk->GetElementsInTimeRange(startMillisec, endMillisec));
+    return tk->GetCString();
+}
+
 const char *vrvToolkit_getExpansionIdsForElement(void *tkPtr, const char *xmlId)
 {
     Toolkit *tk = static_cast<Toolkit *>(tkPtr);
@@ -212,6 +231,12 @@ const char *vrvToolkit_getVersion(void *tkPtr)
     return tk->GetCString();
 }
 
+bool vrvToolkit_isCastOffComplete(void *tkPtr)
+{
+    Toolkit *tk = static_cast<Toolkit *>(tkPtr);
+    return tk->IsCastOffComplete();
+}
+
 bool vrvToolkit_loadData(void *tkPtr, const char *data)
 {
     Toolkit *tk = static_cast<Toolkit *>(tkPtr);
@@ -249,6 +274,14 @@ const char *vrvToolkit_renderData(void *tkPtr, const char *data, const char *opt
     return tk->GetCString();
 }
 
+const unsigned char *vrvToolkit_renderToBinaryTimemap(void *tkPtr, const char *c_options, int *length)
+{
+    Toolkit *tk = static_cast<Toolkit *>(tkPtr);
+    const std::vector<unsigned char> &buffer = tk->SetCBuffer(tk->RenderToBinaryTimemap(c_options));
+    *length = (int)buffer.size();
+    return buffer.data();
+}
+
 const char *vrvToolkit_renderToExpansionMap(void *tkPtr)
 {
     Toolkit *tk = static_cast<Toolkit *>(tkPtr);
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+Generate the C++ source file with the font resources embedded in the library.
+
+The music fonts (data/*.xml with the glyph files in data/<Font>/), the text fonts
+(data/text/*.xml) and the footer (data/footer.svg) are turned into constant tables
+so that Resources can load the fonts without any file I/O or XML parsing.
+
+Usage: embed_resources.py <data_dir> <output_file>
+"""
+import logging
+import sys
+import xml.etree.ElementTree as Et
+from argparse import ArgumentParser
+from pathlib import Path
+from typing import Optional
+
+log = logging.getLogger(__name__)
+
+HEADER = """/////////////////////////////////////////////////////////////////////////////
+// NOTE: this file was generated by the ./tools/embed_resources.py script
+// and should not be edited because changes will be lost.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "embeddedresources.h"
+
+//----------------------------------------------------------------------------
+
+namespace vrv {
+
+"""
+
+FOOTER = """} // namespace vrv
+"""
+
+# Keep the literals short enough for all compilers (MSVC limits them to 16K)
+LITERAL_CHUNK_SIZE: int = 2000
+
+
+def c_string(content: bytes) -> str:
+    """Return the content as one or more adjacent C string literals."""
+    if not content:
+        return '""'
+    chunks: list = []
+    for start in range(0, len(content), LITERAL_CHUNK_SIZE):
+        escaped: list = []
+        for byte in content[start : start + LITERAL_CHUNK_SIZE]:
+            char = chr(byte)
+            if char == "\\" or char == '"':
+                escaped.append("\\" + char)
+            elif char == "\n":
+                escaped.append("\\n")
+            elif 32 <= byte < 127:
+                escaped.append(char)
+            else:
+                escaped.append(f"\\{byte:03o}")
+        chunks.append('"' + "".join(escaped) + '"')
+    return "\n    ".join(chunks)
+
+
+def c_double(value: Optional[str]) -> str:
+    """Return the attribute value as a double literal (0.0 when missing)."""
+    # repr gives the shortest representation that round-trips, so the literal is the value strtod parses
+    return repr(float(value)) if value else "0.0"
+
+
+def units_per_em(root: Et.Element, filename: Path) -> Optional[int]:
+    value: Optional[str] = root.get("units-per-em")
+    if not value:
+        log.warning("No units-per-em attribute in %s, the font will not be embedded", filename)
+        return None
+    return int(value)
+
+
+def write_music_font(out: list, font_file: Path, index: int) -> Optional[str]:
+    """Write the tables of a music font and return its EmbeddedFont initializer."""
+    root: Et.Element = Et.parse(font_file).getroot()
+    units: Optional[int] = units_per_em(root, font_file)
+    if units is None:
+        return None
+
+    name: str = font_file.stem
+    anchors: list = []
+    glyphs: list = []
+    for glyph in root.findall("g"):
+        code: Optional[str] = glyph.get("c")
+        glyph_name: Optional[str] = glyph.get("n")
+        if not code or not glyph_name:
+            continue
+        anchor_index: int = len(anchors)
+        for anchor in glyph.findall("a"):
+            if anchor.get("n"):
+                anchors.append(f'{{ "{anchor.get("n")}", {c_double(anchor.get("x"))}, {c_double(anchor.get("y"))} }}')
+        symbol_file: Path = font_file.parent / name / f"{code}.xml"
+        symbol: str = "NULL"
+        if symbol_file.exists():
+            symbol = f"s_symbol{index}_{len(glyphs)}"
+            out.append(f"const char {symbol}[] = {c_string(symbol_file.read_bytes())};\n")
+        anchor_count: int = len(anchors) - anchor_index
+        anchor_ptr: str = f"s_anchors{index} + {anchor_index}" if anchor_count else "NULL"
+        glyphs.append(
+            f'{{ 0x{code}, "{code}", "{glyph_name}", {c_double(glyph.get("x"))}, {c_double(glyph.get("y"))}, '
+            f'{c_double(glyph.get("w"))}, {c_double(glyph.get("h"))}, {c_double(glyph.get("h-a-x"))}, '
+            f"{anchor_count}, {anchor_ptr}, {symbol} }}"
+        )
+
+    if not glyphs:
+        return None
+    if anchors:
+        out.append(f"const EmbeddedAnchor s_anchors{index}[] = {{\n    " + ",\n    ".join(anchors) + "\n};\n")
+    out.append(f"const EmbeddedGlyph s_glyphs{index}[] = {{\n    " + ",\n    ".join(glyphs) + "\n};\n\n")
+    return f'{{ "{name}", {units}, {len(glyphs)}, s_glyphs{index} }}'
+
+
+def write_text_font(out: list, font_file: Path, index: int) -> Optional[str]:
+    """Write the bounding box table of a text font and return its EmbeddedFont initializer."""
+    root: Et.Element = Et.parse(font_file).getroot()
+    units: Optional[int] = units_per_em(root, font_file)
+    if units is None:
+        return None
+
+    glyphs: list = []
+    for glyph in root.findall("g"):
+        code: Optional[str] = glyph.get("c")
+        if not code:
+            continue
+        glyphs.append(
+            f'{{ 0x{code}, "{code}", NULL, {c_double(glyph.get("x"))}, {c_double(glyph.get("y"))}, '
+            f'{c_double(glyph.get("w"))}, {c_double(glyph.get("h"))}, {c_double(glyph.get("h-a-x"))}, 0, NULL, NULL }}'
+        )
+
+    if not glyphs:
+        return None
+    out.append(f"const EmbeddedGlyph s_textGlyphs{index}[] = {{\n    " + ",\n    ".join(glyphs) + "\n};\n\n")
+    return f'{{ "{font_file.stem}", {units}, {len(glyphs)}, s_textGlyphs{index} }}'
+
+
+def write_fonts(out: list, array: str, fonts: list) -> None:
+    out.append(f"const EmbeddedFont {array}[] = {{\n    " + ",\n    ".join(fonts + ["{ NULL, 0, 0, NULL }"]))
+    out.append("\n};\n\n")
+
+
+def write_lookup(out: list, function: str, array: str) -> None:
+    out.append(f"const EmbeddedFont *{function}(const std::string &fontName)\n{{\n")
+    out.append(f"    for (const EmbeddedFont *font = {array}; font->m_name; ++font) {{\n")
+    out.append("        if (fontName == font->m_name) return font;\n    }\n    return NULL;\n}\n\n")
+
+
+def generate(data_dir: Path, output: Path) -> None:
+    out: list = [HEADER, "namespace {\n\n"]
+
+    music_fonts: list = []
+    for index, font_file in enumerate(sorted(data_dir.glob("*.xml"))):
+        font: Optional[str] = write_music_font(out, font_file, index)
+        if font:
+            music_fonts.append(font)
+
+    text_fonts: list = []
+    for index, font_file in enumerate(sorted((data_dir / "text").glob("*.xml"))):
+        font = write_text_font(out, font_file, index)
+        if font:
+            text_fonts.append(font)
+
+    footer_file: Path = data_dir / "footer.svg"
+    footer: str = c_string(footer_file.read_bytes()) if footer_file.exists() else '""'
+    out.append(f"const char s_footer[] = {footer};\n\n")
+
+    write_fonts(out, "s_fonts", music_fonts)
+    write_fonts(out, "s_textFonts", text_fonts)
+    out.append("} // namespace\n\n")
+
+    write_lookup(out, "GetEmbeddedFont", "s_fonts")
+    write_lookup(out, "GetEmbeddedTextFont", "s_textFonts")
+    out.append("const char *GetEmbeddedFooter()\n{\n    return s_footer;\n}\n\n")
+    out.append(FOOTER)
+
+    output.parent.mkdir(parents=True, exist_ok=True)
+    output.write_text("".join(out))
+    log.info("Embedded %d music fonts and %d text fonts in %s", len(music_fonts), len(text_fonts), output)
+
+
+if __name__ == "__main__":
+    logging.basicConfig(format="%(message)s", level=logging.INFO)
+    parser = ArgumentParser(description="Generate the embedded font resources")
+    parser.add_argument("data_dir", type=Path, help="The Verovio data directory")
+    parser.add_argument("output", type=Path, help="The C++ file to generate")
+    args = parser.parse_args()
+    if not args.data_dir.is_dir():
+        log.error("The data directory %s does not exist", args.data_dir)
+        sys.exit(1)
+    generate(args.data_dir, args.output)
@@ -5,13 +5,18 @@
 // Copyright (c) Authors and others. All rights reserved.
 /////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <regex>
 #include <sstream>
 #include <string>
 #include <sys/stat.h>
+#include <thread>
+#include <vector>
 
 #ifndef _WIN32
 #include <getopt.h>
@@ -44,6 +49,8 @@ std::string basename(std::string const &pathname)
 std::string removeExtension(std::string const &filename)
 {
     std::string::const_reverse_iterator pivot = std::find(filename.rbegin(), filename.rend(), '.');
+    // A dot in a directory name is not an extension
+    if (std::find(filename.rbegin(), pivot, '/') != pivot) return filename;
     return pivot == filename.rend() ? filename : std::string(filename.begin(), pivot.base() - 1);
 }
 
@@ -72,11 +79,256 @@ bool optionExists(const std::string &option, int argc, char **argv, std::string
     return false;
 }
 
+// An input of a batch, given by a line of the batch list
+// The line is either a file path or a JSON object with "input" (a file path) or "data" (the input content),
+// and optionally "name" (the output base name with "data"), "output" (the output file name) and "options"
+struct BatchEntry {
+    int lineNo = 0;
+    std::string input;
+    std::string data;
+    std::string outfile;
+    std::string options;
+    // Set when the line could not be read
+    std::string error;
+};
+
+std::vector<BatchEntry> read_batch_entries(std::istream &stream, const std::string &outdir)
+{
+    std::vector<BatchEntry> entries;
+    const std::string prefix = (outdir.empty()) ? "" : outdir + "/";
+
+    int lineNo = 0;
+    for (std::string line; getline(stream, line);) {
+        ++lineNo;
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        // Empty lines and comments are skipped
+        if (line.empty() || (line.at(0) == '#')) continue;
+
+        BatchEntry entry;
+        entry.lineNo = lineNo;
+        if (line.at(0) != '{') {
+            entry.input = line;
+            entry.outfile = (outdir.empty()) ? removeExtension(line) : prefix + removeExtension(basename(line));
+            entries.push_back(entry);
+            continue;
+        }
+
+        jsonxx::Object json;
+        if (!json.parse(line)) {
+            entry.error = "the line is not valid JSON";
+        }
+        else if (json.has<jsonxx::String>("input")) {
+            entry.input = json.get<jsonxx::String>("input");
+            entry.outfile = (outdir.empty()) ? removeExtension(entry.input)
+                                             : prefix + removeExtension(basename(entry.input));
+        }
+        else if (json.has<jsonxx::String>("data")) {
+            entry.data = json.get<jsonxx::String>("data");
+            const std::string name = (json.has<jsonxx::String>("name")) ? json.get<jsonxx::String>("name")
+                                                                         : vrv::StringFormat("batch_%06d", lineNo);
+            entry.outfile = prefix + name;
+        }
+        else {
+            entry.error = "the JSON object has no \"input\" or \"data\"";
+        }
+        if (json.has<jsonxx::String>("output")) {
+            entry.outfile = removeExtension(json.get<jsonxx::String>("output"));
+        }
+        if (json.has<jsonxx::Object>("options")) {
+            entry.options = json.get<jsonxx::Object>("options").json();
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+bool write_batch_output(vrv::Toolkit &toolkit, const std::string &outformat, const std::string &outfile, int page,
+    bool all_pages, std::string &error)
+{
+    bool success = true;
+    if (outformat == "svg") {
+        const int to = (all_pages) ? toolkit.GetPageCount() : page;
+        for (int p = page; success && (p <= to); ++p) {
+            const std::string suffix = (all_pages) ? vrv::StringFormat("_%03d", p) : "";
+            success = toolkit.RenderToSVGFile(outfile + suffix + ".svg", p);
+        }
+    }
+    else if (outformat == "midi") {
+        success = toolkit.RenderToMIDIFile(outfile + ".mid");
+    }
+    else if (outformat == "timemap") {
+        success = toolkit.RenderToTimemapFile(outfile + ".json");
+    }
+    else if (outformat == "expansionmap") {
+        success = toolkit.RenderToExpansionMapFile(outfile + "-em.json");
+    }
+    else if (outformat == "pae") {
+        success = toolkit.RenderToPAEFile(outfile + ".pae");
+    }
+    else {
+        const char *scoreBased = (outformat == "mei-pb") ? "false" : "true";
+        const char *basic = (outformat == "mei-basic") ? "true" : "false";
+        const char *removeIds = (toolkit.GetOptionsObj()->m_removeIds.GetValue()) ? "true" : "false";
+        const std::string pageNo = (all_pages) ? "" : vrv::StringFormat(", 'pageNo': %d", page);
+        success = toolkit.SaveFile(outfile + ".mei",
+            vrv::StringFormat(
+                "{'scoreBased': %s, 'basic': %s%s, 'removeIds': %s}", scoreBased, basic, pageNo.c_str(), removeIds));
+    }
+    if (!success) error = "the " + outformat + " output could not be written";
+    return success;
+}
+
+bool process_batch_entry(vrv::Toolkit &toolkit, const BatchEntry &entry, const std::vector<std::string> &outformats,
+    int page, bool all_pages, std::string &error)
+{
+    if (!entry.options.empty() && !toolkit.SetOptions(entry.options)) {
+        error = "the options could not be set";
+        return false;
+    }
+    if (!entry.input.empty() && !toolkit.LoadFile(entry.input)) {
+        error = "the file could not be loaded";
+        return false;
+    }
+    if (entry.input.empty() && !toolkit.LoadData(entry.data)) {
+        error = "the data could not be loaded";
+        return false;
+    }
+    // With the progressive layout, only the pages up to the one requested are cast off
+    toolkit.CastOffPages(std::max(page, 1));
+    if ((page < 1) || (page > toolkit.GetCastOffPageCount())) {
+        error = vrv::StringFormat("the page requested (%d) is not in the page range", page);
+        return false;
+    }
+    for (const std::string &outformat : outformats) {
+        if (!write_batch_output(toolkit, outformat, entry.outfile, page, all_pages, error)) return false;
+    }
+    return true;
+}
+
+// Process all the inputs listed in the batch file with one toolkit per thread
+// The toolkits are kept for all the inputs, so the fonts and the options are loaded only once per thread
+int run_batch(const std::string &batchfile, const std::string &informat, const std::string &outformat,
+    const std::string &outdir, const std::string &resourcePath, vrv::Toolkit &toolkit, int page, bool all_pages,
+    int threads)
+{
+    std::vector<std::string> outformats;
+    std::istringstream outformat_stream(outformat);
+    for (std::string format; getline(outformat_stream, format, ',');) {
+        if ((format != "svg") && (format != "mei") && (format != "mei-basic") && (format != "mei-pb")
+            && (format != "midi") && (format != "timemap") && (format != "expansionmap") && (format != "pae")) {
+            std::cerr << "Output format (" << format
+                      << ") can only be 'mei', 'mei-basic', 'mei-pb', 'svg', 'midi', 'timemap', 'expansionmap' or "
+                         "'pae' in batch mode."
+                      << std::endl;
+            return 1;
+        }
+        outformats.push_back(format);
+    }
+
+    std::vector<BatchEntry> entries;
+    if (batchfile == "-") {
+        entries = read_batch_entries(std::cin, outdir);
+    }
+    else {
+        std::ifstream batch_stream(batchfile.c_str());
+        if (!batch_stream.is_open()) {
+            std::cerr << "The batch file '" << batchfile << "' could not be opened." << std::endl;
+            return 1;
+        }
+        entries = read_batch_entries(batch_stream, outdir);
+    }
+
+    // The options of the command line are copied to the toolkit of each thread
+    // Skip the layout when none of the outputs needs it, as for a single input
+    vrv::Options options = *toolkit.GetOptionsObj();
+    if (std::all_of(outformats.begin(), outformats.end(), [](const std::string &format) {
+            return ((format == "midi") || (format == "timemap") || (format == "expansionmap"));
+        })) {
+        options.m_breaks.SetValue("none");
+    }
+    const std::string font = vrv::StringFormat("{\"font\": \"%s\"}", options.m_font.GetValue().c_str());
+    const int seed = toolkit.GetOptionsObj()->m_xmlIdSeed.GetValue();
+
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    threads = std::min(std::max(threads, 1), std::max((int)entries.size(), 1));
+
+    std::atomic<int> nextEntry = 0;
+    std::atomic<int> succeeded = 0;
+    std::atomic<int> failed = 0;
+    auto processEntries = [&]() {
+        // The toolkit is created in the thread because the first object created seeds the xml:ids of the thread
+        vrv::Toolkit batch_toolkit(false);
+        batch_toolkit.SetResourcePath(resourcePath);
+        batch_toolkit.SetInputFrom(informat);
+        *batch_toolkit.GetOptionsObj() = options;
+        batch_toolkit.SetOptions(font);
+
+        for (int i = nextEntry++; i < (int)entries.size(); i = nextEntry++) {
+            const BatchEntry &entry = entries.at(i);
+            // Each input gets the same xml:ids as when converted on its own
+            if (seed) vrv::Object::SeedID(seed);
+
+            std::string error = entry.error;
+            bool success = false;
+            if (error.empty()) {
+                // Errors are reported for the input and do not stop the batch
+                try {
+                    success = process_batch_entry(batch_toolkit, entry, outformats, page, all_pages, error);
+                }
+                catch (const std::exception &e) {
+                    error = e.what();
+                }
+            }
+            // Reset the options changed by the input
+            if (!entry.options.empty()) {
+                *batch_toolkit.GetOptionsObj() = options;
+                batch_toolkit.SetOptions(font);
+                batch_toolkit.SetInputFrom(informat);
+            }
+
+            if (success) {
+                ++succeeded;
+            }
+            else {
+                ++failed;
+                const std::string &name = (entry.input.empty()) ? entry.outfile : entry.input;
+                if (name.empty()) {
+                    vrv::LogError("Batch line %d failed: %s", entry.lineNo, error.c_str());
+                }
+                else {
+                    vrv::LogError("Batch line %d (%s) failed: %s", entry.lineNo, name.c_str(), error.c_str());
+                }
+            }
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(processEntries);
+    }
+    processEntries();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cerr << vrv::StringFormat("Batch of %d inputs processed in %.3f s with %d thread(s) (%.1f inputs/s): "
+                                   "%d succeeded, %d failed.",
+                     (int)entries.size(), seconds, threads, (seconds > 0) ? entries.size() / seconds : 0.0,
+                     succeeded.load(), failed.load())
+              << std::endl;
+
+    return (failed > 0) ? 1 : 0;
+}
+
 int main(int argc, char **argv)
 {
     std::string infile;
+    std::string batchfile;
     std::string svgdir;
     std::string outfile;
+    std::string informat = "auto";
     std::string outformat = "svg";
     bool std_output = false;
 
@@ -91,8 +343,10 @@ int main(int argc, char **argv)
 
     static struct option base_options[] = { //
         { "all-pages", no_argument, 0, 'a' }, //
+        { "batch", required_argument, 0, 'b' }, //
         { "input-from", required_argument, 0, 'f' }, //
         { "help", required_argument, 0, 'h' }, //
+        { "threads", required_argument, 0, 'j' }, //
         { "log-level", required_argument, 0, 'l' }, //
         { "outfile", required_argument, 0, 'o' }, //
         { "page", required_argument, 0, 'p' }, //
@@ -155,7 +409,7 @@ int main(int argc, char **argv)
     vrv::Option *opt = NULL;
     vrv::OptionBool *optBool = NULL;
     std::string resourcePath = toolkit.GetResourcePath();
-    while ((c = getopt_long(argc, argv, "ab:f:h:l:o:p:r:s:t:vx:z", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "ab:f:h:j:l:o:p:r:s:t:vx:z", long_options, &option_index)) != -1) {
         switch (c) {
             case 0:
                 key = long_options[option_index].name;
@@ -183,10 +437,19 @@ int main(int argc, char **argv)
 
             case 'a': all_pages = 1; break;
 
+            case 'b': batchfile = std::string(optarg); break;
+
             case 'f':
                 if (!toolkit.SetInputFrom(std::string(optarg))) {
                     exit(1);
                 };
+                informat = std::string(optarg);
+                break;
+
+            case 'j':
+                if (!options->m_threads.SetValue(optarg)) {
+                    vrv::LogWarning("Setting threads with %s failed, default value used", optarg);
+                }
                 break;
 
             case 'l': vrv::EnableLog(vrv::StrToLogLevel(std::string(optarg))); break;
@@ -199,7 +462,8 @@ int main(int argc, char **argv)
 
             case 't':
                 outformat = std::string(optarg);
-                toolkit.SetOutputTo(std::string(optarg));
+                // A list of output formats is possible in batch mode only and is checked there
+                if (outformat.find(',') == std::string::npos) toolkit.SetOutputTo(outformat);
                 break;
 
             case 's':
@@ -249,7 +513,13 @@ int main(int argc, char **argv)
     }
 
     std::cerr << infile;
-    if (optind <= argc - 1) {
+    if (!batchfile.empty()) {
+        if ((optind <= argc - 1) || (infile == "-")) {
+            std::cerr << "An input file cannot be given with a batch." << std::endl;
+            exit(1);
+        }
+    }
+    else if (optind <= argc - 1) {
         infile = std::string(argv[optind]);
     }
     else if (infile != "-") {
@@ -260,7 +530,12 @@ int main(int argc, char **argv)
 
     // Make sure the user uses a valid Resource path
     // Save many headaches for empty SVGs
+    // With embedded resources, the resource directory is read only when a path other than the default one is given
+#ifdef VRV_EMBED_RESOURCES
+    if ((resourcePath != toolkit.GetResourcePath()) && !dir_exists(resourcePath)) {
+#else
     if (!dir_exists(resourcePath)) {
+#endif
         std::cerr << "The resource path " << resourcePath << " could not be found; please use -r option." << std::endl;
         exit(1);
     }
@@ -278,6 +553,18 @@ int main(int argc, char **argv)
         exit(1);
     }
 
+    // Process the inputs of the batch - the output file is the output directory
+    if (!batchfile.empty()) {
+        if (outfile == "-") {
+            std::cerr << "The outputs of a batch cannot be written to the standard output." << std::endl;
+            exit(1);
+        }
+        const int status = run_batch(batchfile, informat, outformat, outfile, resourcePath, toolkit, page, all_pages,
+            options->m_threads.GetValue());
+        free(long_options);
+        return status;
+    }
+
     if ((outformat != "svg") && (outformat != "mei") && (outformat != "mei-basic") && (outformat != "mei-pb")
         && (outformat != "midi") && (outformat != "timemap") && (outformat != "expansionmap")
         && (outformat != "humdrum") && (outformat != "hum") && (outformat != "pae")) {
@@ -311,6 +598,9 @@ int main(int argc, char **argv)
         toolkit.SetOptions("{'breaks': 'none'}");
     }
 
+    // Rendering all the pages with several threads, which share the document loaded (see Toolkit::RenderAllToSVG)
+    bool render_in_threads = ((outformat == "svg") && all_pages && (options->m_threads.GetValue() != 1));
+
     // Load the std input or load the file
     if (!((toolkit.GetOutputTo() == vrv::HUMDRUM) && (toolkit.GetInputFrom() == vrv::MEI))) {
         if (infile == "-") {
@@ -332,8 +622,9 @@ int main(int argc, char **argv)
     }
 
     if (toolkit.GetOutputTo() != vrv::HUMDRUM) {
-        // Check the page range
-        if (page > toolkit.GetPageCount()) {
+        // Check the page range - with the progressive layout, only the pages up to the one requested are cast off
+        toolkit.CastOffPages(page);
+        if (page > toolkit.GetCastOffPageCount()) {
             std::cerr << "The page requested (" << page << ") is not in the page range (max is "
                       << toolkit.GetPageCount() << ")." << std::endl;
             exit(1);
@@ -350,7 +641,24 @@ int main(int argc, char **argv)
         to = toolkit.GetPageCount() + 1;
     }
 
-    if (outformat == "svg") {
+    if (render_in_threads) {
+        std::vector<std::string> pages = toolkit.RenderAllToSVG(options->m_threads.GetValue(), !std_output);
+        for (int p = 1; p <= (int)pages.size(); ++p) {
+            std::string cur_outfile = outfile + vrv::StringFormat("_%03d", p) + ".svg";
+            if (std_output) {
+                std::cout << pages.at(p - 1);
+                continue;
+            }
+            std::ofstream outstream(cur_outfile.c_str());
+            if (!outstream.is_open()) {
+                std::cerr << "Unable to write SVG to " << cur_outfile << "." << std::endl;
+                exit(1);
+            }
+            outstream << pages.at(p - 1);
+            std::cerr << "Output written to " << cur_outfile << "." << std::endl;
+        }
+    }
+    else if (outformat == "svg") {
         int p;
         for (p = from; p < to; ++p) {
             std::string cur_outfile = outfile;